@@ -0,0 +1,210 @@
+// Hit rates of the buffer pool replacement policies on zipfian lookups mixed with scans.
+// Replays each access trace against one Replacer, the way a BufferPoolManager shard
+// drives it (pin, recordAccess, unpin on a hit; victim first on a miss).
+//
+// Usage: replacer_benchmark [frames] [hot_pages] [operations]
+
+#include "luminadb/buffer/Replacer.hpp"
+#include "luminadb/common/types.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace LuminaDB;
+
+namespace {
+
+constexpr double ZIPF_THETA = 0.99;
+constexpr uint32_t SCAN_FIRST_PAGE = 1u << 30; // Scanned pages never collide with the hot ones
+
+struct Access {
+	uint32_t page_id;
+	bool lookup; // Part of the zipfian lookups (the rate that matters), not of a scan
+};
+
+// Zipfian page ids over [0, pages) by inverse CDF
+class Zipf {
+  private:
+	std::vector<double> cdf;
+	std::uniform_real_distribution<double> uniform{0.0, 1.0};
+
+  public:
+	explicit Zipf(uint32_t pages) : cdf(pages) {
+		double sum = 0;
+		for (uint32_t i = 0; i < pages; i++) {
+			sum += 1.0 / std::pow(static_cast<double>(i + 1), ZIPF_THETA);
+			cdf[i] = sum;
+		}
+		for (double &value : cdf) {
+			value /= sum;
+		}
+	}
+
+	uint32_t next(std::mt19937_64 &rng) {
+		auto it = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng));
+		return static_cast<uint32_t>(std::min<size_t>(it - cdf.begin(), cdf.size() - 1));
+	}
+};
+
+/**
+ * Lookups, with a share of the operations taken by a scan that walks pages nobody else
+ * reads. refs_per_page > 1 reads each scanned page several times in a row, like a range
+ * scan fetching the data page of every record on it.
+ */
+std::vector<Access> mixedTrace(Zipf &zipf, size_t operations, double scan_share, uint32_t refs_per_page) {
+	std::mt19937_64 rng(42);
+	std::bernoulli_distribution scanning(scan_share);
+	std::vector<Access> trace;
+	trace.reserve(operations);
+
+	uint32_t cursor = SCAN_FIRST_PAGE;
+	uint32_t refs_left = refs_per_page;
+	while (trace.size() < operations) {
+		if (scan_share > 0 && scanning(rng)) {
+			trace.push_back({cursor, false});
+			if (--refs_left == 0) {
+				cursor++;
+				refs_left = refs_per_page;
+			}
+		} else {
+			trace.push_back({zipf.next(rng), true});
+		}
+	}
+	return trace;
+}
+
+// Lookups, one long scan (scan_pages pages), then lookups again
+std::vector<Access> burstTrace(Zipf &zipf, size_t operations, uint32_t scan_pages) {
+	std::mt19937_64 rng(7);
+	std::vector<Access> trace;
+	trace.reserve(operations + scan_pages);
+	for (size_t i = 0; i < operations / 2; i++) {
+		trace.push_back({zipf.next(rng), true});
+	}
+	for (uint32_t i = 0; i < scan_pages; i++) {
+		trace.push_back({SCAN_FIRST_PAGE + i, false});
+	}
+	for (size_t i = 0; i < operations / 2; i++) {
+		trace.push_back({zipf.next(rng), true});
+	}
+	return trace;
+}
+
+struct Result {
+	double lookup_hit_rate;
+	double overall_hit_rate;
+	double million_ops_per_second;
+};
+
+// Replays the trace over 'frames' frames, counting hits for accesses [count_from, count_to)
+Result replay(ReplacerPolicy policy, size_t frames, const std::vector<Access> &trace, size_t count_from,
+			  size_t count_to) {
+	std::unique_ptr<Replacer> replacer = makeReplacer(policy, frames);
+	std::unordered_map<uint32_t, uint32_t> page_table;
+	std::vector<uint32_t> frame_page(frames, INVALID_PAGE_ID);
+	uint32_t next_free = 0;
+
+	size_t lookups = 0, lookup_hits = 0, counted = 0, hits = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < trace.size(); i++) {
+		const Access &access = trace[i];
+		bool hit = false;
+
+		auto cached = page_table.find(access.page_id);
+		if (cached != page_table.end()) {
+			hit = true;
+			replacer->pin(cached->second);
+			replacer->recordAccess(cached->second, access.page_id);
+			replacer->unpin(cached->second);
+		} else {
+			uint32_t frame_id;
+			if (next_free < frames) {
+				frame_id = next_free++;
+			} else if (replacer->victim(&frame_id)) {
+				page_table.erase(frame_page[frame_id]);
+			} else {
+				std::fprintf(stderr, "no victim with every frame unpinned\n");
+				std::exit(1);
+			}
+			page_table[access.page_id] = frame_id;
+			frame_page[frame_id] = access.page_id;
+			replacer->recordAccess(frame_id, access.page_id);
+			replacer->unpin(frame_id);
+		}
+
+		if (i >= count_from && i < count_to) {
+			counted++;
+			hits += hit;
+			if (access.lookup) {
+				lookups++;
+				lookup_hits += hit;
+			}
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	return {lookups ? 100.0 * lookup_hits / lookups : 0.0, counted ? 100.0 * hits / counted : 0.0,
+			trace.size() / seconds / 1e6};
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	size_t frames = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+	uint32_t hot_pages = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 16384;
+	size_t operations = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2000000;
+
+	Zipf zipf(hot_pages);
+	struct Workload {
+		std::string name;
+		std::vector<Access> trace;
+		size_t count_from; // Accesses before this one only warm the pool up
+		size_t count_to;
+	};
+	std::vector<Workload> workloads;
+	workloads.push_back({"zipf", mixedTrace(zipf, operations, 0.0, 1), operations / 2, operations});
+	workloads.push_back({"zipf + 20% scan", mixedTrace(zipf, operations, 0.2, 1), operations / 2, operations});
+	workloads.push_back({"zipf + 20% scan x4 refs", mixedTrace(zipf, operations, 0.2, 4), operations / 2, operations});
+
+	// Right after a scan of 8x the pool: the lookups that would see the latency spike
+	size_t scan_pages = frames * 8;
+	size_t after_scan = operations / 2 + scan_pages;
+	workloads.push_back({"after a scan burst", burstTrace(zipf, operations, static_cast<uint32_t>(scan_pages)),
+						 after_scan, after_scan + frames * 4});
+
+	const std::pair<ReplacerPolicy, const char *> policies[] = {{ReplacerPolicy::LRU, "LRU"},
+																{ReplacerPolicy::CLOCK, "CLOCK"},
+																{ReplacerPolicy::LRU_K, "LRU-K"},
+																{ReplacerPolicy::TWO_Q, "2Q"},
+																{ReplacerPolicy::ARC, "ARC"}};
+
+	std::printf("frames=%zu hot_pages=%u operations=%zu (zipf theta %.2f)\n", frames, hot_pages, operations,
+				ZIPF_THETA);
+	std::printf("lookup hit %% / overall hit %% / Mops/s\n\n");
+	std::printf("%-26s", "workload");
+	for (const auto &policy : policies) {
+		std::printf("%22s", policy.second);
+	}
+	std::printf("\n");
+
+	for (const Workload &workload : workloads) {
+		std::printf("%-26s", workload.name.c_str());
+		for (const auto &policy : policies) {
+			Result result = replay(policy.first, frames, workload.trace, workload.count_from, workload.count_to);
+			char cell[32];
+			std::snprintf(cell, sizeof(cell), "%.1f / %.1f / %.1f", result.lookup_hit_rate, result.overall_hit_rate,
+						  result.million_ops_per_second);
+			std::printf("%22s", cell);
+		}
+		std::printf("\n");
+	}
+	return 0;
+}
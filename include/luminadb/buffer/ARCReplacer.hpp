@@ -0,0 +1,70 @@
+#ifndef LUMINADB_ARC_REPLACER_HPP
+#define LUMINADB_ARC_REPLACER_HPP
+
+#include "FrameList.hpp"
+#include "Replacer.hpp"
+#include <mutex>
+#include <vector>
+
+namespace LuminaDB {
+
+/**
+ * Adaptive Replacement Cache.
+ *  - T1: pages referenced once since they came in (LRU order).
+ *  - T2: pages referenced at least twice (LRU order).
+ *  - B1 / B2: ids of the pages recently evicted from T1 / T2 (no frames).
+ * Victims come from T1 while it holds more than 'target' frames, from T2 otherwise.
+ * A request for a page in B1 means T1 was too small, so target grows; one in B2 means
+ * T2 was, so it shrinks. A scan only fills T1 and the ghosts of B1, leaving T2 alone:
+ * a hit within the correlated reference period of the page's arrival in T1 (see
+ * CORRELATED_REFERENCE_DIVISOR) leaves it there, so reading a page several times in a
+ * row does not promote it.
+ *
+ * Frames are given up before the requested page is known (victim() comes first), so
+ * the choice between T1 and T2 looks only at target, not at where the new page is.
+ */
+class ARCReplacer : public Replacer {
+  private:
+	enum List : uint8_t { NO_LIST = 0, RECENT = 1, FREQUENT = 2 };
+
+	std::mutex latch;
+	size_t capacity; // Frames (c in the ARC paper)
+	size_t target;	 // Preferred size of T1 (p in the ARC paper), 0 .. capacity
+	uint64_t current_time;		// Logical clock: one tick per reference
+	uint64_t correlated_period; // Ticks after its arrival in which a hit leaves a page in T1
+
+	FrameList t1;
+	FrameList t2;
+	GhostList b1;
+	GhostList b2;
+
+	std::vector<uint8_t> list_of; // List each frame is in
+	std::vector<uint8_t> evictable;
+	std::vector<uint32_t> frame_page;
+	std::vector<uint64_t> arrival; // When each frame's page was first referenced in it
+	size_t evictable_count;
+
+	// Oldest evictable frame of the list, or FrameList::NONE
+	uint32_t firstEvictable(const FrameList &list) const;
+
+	// Helper: Takes the frame out of its list (caller holds the latch)
+	void detach(uint32_t frame_id);
+
+	// Keeps |T1| + |B1| <= c and the four lists together within 2c (caller holds the latch)
+	void trimGhosts();
+
+  public:
+	explicit ARCReplacer(size_t num_frames);
+	~ARCReplacer() override;
+
+	bool victim(uint32_t *frame_id) override;
+	void pin(uint32_t frame_id) override;
+	void unpin(uint32_t frame_id) override;
+	size_t Size() override;
+	void recordAccess(uint32_t frame_id, uint32_t page_id) override;
+	void remove(uint32_t frame_id) override;
+};
+
+} // namespace LuminaDB
+
+#endif
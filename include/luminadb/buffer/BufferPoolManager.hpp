@@ -1,48 +1,289 @@
 #ifndef LUMINADB_BUFFER_POOL_MANAGER_HPP
 #define LUMINADB_BUFFER_POOL_MANAGER_HPP
 
-#include "LRUReplacer.hpp"
+#include "PageTable.hpp"
+#include "Replacer.hpp"
+#include "luminadb/common/types.hpp"
 #include "luminadb/model/Storable.hpp"
+#include "luminadb/storage/AsyncIOEngine.hpp"
 #include "luminadb/storage/DiskManager.hpp"
 #include "luminadb/storage/Page.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <shared_mutex>
+#include <unordered_set>
+#include <vector>
 
 namespace LuminaDB {
+
+// The pool is split in one shard per this many frames, up to MAX_BUFFER_POOL_SHARDS
+inline constexpr size_t MIN_FRAMES_PER_SHARD = 64;
+inline constexpr size_t MAX_BUFFER_POOL_SHARDS = 16;
+
+// A write-back of dirty pages pins at most 1/N of a shard's frames at a time
+inline constexpr size_t WRITE_BACK_CHUNK_DIVISOR = 4;
+
+// How often installNewPage() looks again at a stale frame of its page that is still pinned
+inline constexpr std::chrono::milliseconds STALE_PIN_POLL_INTERVAL{1};
+
+// Size of a cache line: every FrameDescriptor has one to itself
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * Bookkeeping of one frame. A buffer pool hit reads and writes only this line (besides
+ * the page table entry), instead of one element in each of several parallel arrays.
+ *
+ * The page id, the loading flag and the pin count share one atomic word, so a pin also
+ * checks that the frame still holds the page it was looked up for, and a frame can only
+ * be given to another page while that word says nobody holds it. Mapping and loading
+ * change under the latch of the frame's shard; pins and the dirty flag do not need it.
+ */
+struct alignas(CACHE_LINE_SIZE) FrameDescriptor {
+	static constexpr uint64_t LOADING = 1ULL << 31; // Read in progress: mapped but not usable yet
+	static constexpr uint64_t PIN_MASK = LOADING - 1;
+
+	std::atomic<uint64_t> state{pack(INVALID_PAGE_ID, false, 0)}; // page_id << 32 | LOADING | pin count
+	std::atomic<bool> dirty{false};
+
+	static constexpr uint64_t pack(uint32_t page_id, bool loading, uint32_t pins) {
+		return (static_cast<uint64_t>(page_id) << 32) | (loading ? LOADING : 0) | pins;
+	}
+
+	// Page mapped to the frame (INVALID_PAGE_ID: free)
+	uint32_t pageId() const { return static_cast<uint32_t>(state.load(std::memory_order_acquire) >> 32); }
+	uint32_t pinCount() const { return static_cast<uint32_t>(state.load(std::memory_order_acquire) & PIN_MASK); }
+	bool isLoading() const { return (state.load(std::memory_order_acquire) & LOADING) != 0; }
+
+	// Adds a pin if the frame holds page_id and is not loading. 'first' is set if it was unpinned
+	bool tryPin(uint32_t page_id, bool &first);
+
+	// Drops a pin on page_id. 'last' is set if no pin is left; false if it held none
+	bool unpin(uint32_t page_id, bool &last);
+
+	/**
+	 * Only if the frame holds page_id, loaded and unpinned: maps it to new_page_id (with
+	 * the loading flag as given) in one step, so no pin can slip in. Caller holds the latch.
+	 */
+	bool tryReplace(uint32_t page_id, uint32_t new_page_id, bool loading);
+};
+
+/**
+ * Page cache over the DiskManager, split in shards by page id (page_id % shard count).
+ * Each shard owns a fixed range of frames with its own page table, free list, replacer
+ * and latch, so threads working on different pages rarely meet on the same latch.
+ *
+ * Disk I/O never runs under a shard latch: a frame being read is mapped in the table and
+ * marked as loading, and a dirty victim being written back is listed in the shard's
+ * 'writing' set. A thread that wants such a page waits for the transfer instead of
+ * reading it again (or reading a stale copy from the file).
+ *
+ * Hits and unpins skip the latch: they work on the frame's descriptor with atomic
+ * operations. The latch serializes what changes which page a frame holds (loads,
+ * evictions, deletes), and an eviction only takes a frame whose descriptor shows no pin.
+ * The replacer learns about pins and unpins after the fact, so it may offer a frame that
+ * was just pinned; the eviction then skips it and the replacer gets it back on unpin.
+ */
 class BufferPoolManager {
   private:
-	size_t pool_size;								   // How many pages fit in RAM
-	DiskManager *disk_manager;						   // To read/write the file
-	LRUReplacer *replacer;							   // "referee" LRU
-	Page *pages;									   // Physical arrangement of pages in RAM (frames)
-	std::unordered_map<uint32_t, uint32_t> page_table; // page_id -> frame_id
-	std::list<uint32_t> free_list;					   // Frames that have never been used
-	std::mutex latch;								   // Thread safety
-
-	bool *is_dirty;
-	uint32_t *pin_count;
+	struct Shard {
+		std::mutex latch;						 // Guards everything below and the mapping of its frames
+		std::condition_variable io_done;		 // Signalled when a load or a write-back of the shard finishes
+		PageTable page_table;					 // page_id -> frame_id
+		std::list<uint32_t> free_list;			 // Frames of the shard that have never been used
+		std::unique_ptr<Replacer> replacer;		 // "referee" over the shard's frames (numbered from 0)
+		std::unordered_set<uint32_t> writing;	 // Pages whose write-back is in flight (not in page_table)
+		size_t write_back_pins = 0;				 // Frames pinned by writeFrames() while it writes them
+		uint32_t first_frame;					 // Frames first_frame .. first_frame + frame_count - 1
+		size_t frame_count;
+
+		// Replacer calls with pool frame ids
+		bool victim(uint32_t *frame_id) {
+			if (!replacer->victim(frame_id)) {
+				return false;
+			}
+			*frame_id += first_frame;
+			return true;
+		}
+		void pin(uint32_t frame_id) { replacer->pin(frame_id - first_frame); }
+		void unpin(uint32_t frame_id) { replacer->unpin(frame_id - first_frame); }
+		void recordAccess(uint32_t frame_id, uint32_t page_id) { replacer->recordAccess(frame_id - first_frame, page_id); }
+		void remove(uint32_t frame_id) { replacer->remove(frame_id - first_frame); }
+
+		explicit Shard(size_t frame_count) : page_table(frame_count), frame_count(frame_count) {}
+	};
+
+	size_t pool_size;		   // How many pages fit in RAM
+	DiskManager *disk_manager; // To read/write the file
+	AsyncIOEngine *io_engine;  // Batched/overlapped page I/O
+	Page *pages;			   // Physical arrangement of pages in RAM (frames), shard by shard
+	std::vector<std::unique_ptr<Shard>> shards;
+
+	FrameDescriptor *frames; // One per frame, in the same order as 'pages'
+
+	std::shared_mutex *frame_latches; // Reader/writer latch of each frame's contents (see latchPage())
+
+	// Guards the allocator below. Only held for the bookkeeping: the page I/O of newPage() and
+	// deletePage() happens after it is released
+	std::mutex alloc_latch;
 	uint32_t next_page_id;
+	uint32_t free_page_head;  // First page of the on-disk free list (INVALID_PAGE_ID if empty)
+	uint32_t free_page_link;  // Next link stored in free_page_head, valid if free_link_known
+	bool free_link_known;	  // Set by deletePage(); otherwise read from the head page on demand
+	bool reading_free_link;	  // A newPage() is reading the head's link (without alloc_latch)
+	std::condition_variable free_link_read; // Signalled when that read is over
+	bool mmap_reads; // Serve clean pages from the DiskManager's file mapping
+
+	Shard &shardOf(uint32_t page_id);
+
+	/**
+	 * Takes the head off the free list. Returns false if the list is empty or its head can't be
+	 * fetched to read its link. next_free receives the link the popped page holds.
+	 */
+	bool popFreePage(uint32_t &page_id, uint32_t &next_free);
+
+	// Puts a popped free page that can't be handed out back at the head of the list (page: pinned by the caller, or nullptr)
+	void returnFreePage(uint32_t page_id, uint32_t next_free, Page *page);
+
+	// Gives back an id taken from next_page_id whose page could not be installed
+	void releasePageId(uint32_t page_id);
+
+	// Helpers: Enter / drop a frame's page in the shard's page table and in its descriptor (caller holds the latch)
+	void mapFrame(Shard &shard, uint32_t page_id, uint32_t frame_id, uint32_t pins, bool loading);
+	void unmapFrame(Shard &shard, uint32_t page_id, uint32_t frame_id);
+
+	// Takes a frame whose pin count just left 0 out of the replacer. A last unpinPage() that
+	// raced ahead of it already put the frame back, so it is handed back again in that case
+	void pinFrame(Shard &shard, uint32_t frame_id);
+
+	// Clears the loading flag and wakes up the threads waiting for the page (caller holds the latch)
+	void finishLoading(Shard &shard, uint32_t frame_id);
+
+	// Blocks (the latch is released meanwhile) until page_id is neither loading nor being written back
+	void waitForIO(Shard &shard, std::unique_lock<std::mutex> &lock, uint32_t page_id);
+
+	/**
+	 * Takes a frame from the shard's free list or evicts a victim (caller holds the latch).
+	 * A dirty victim is copied into 'staging' and listed in shard.writing: the caller writes
+	 * it out after releasing the latch, then calls finishWriteBack().
+	 */
+	bool acquireFrame(Shard &shard, uint32_t &frame_id, std::unique_ptr<char[]> &staging, uint32_t &victim_id);
+	void finishWriteBack(Shard &shard, uint32_t victim_id);
+
+	/**
+	 * Called when acquireFrame() found no frame. If a write-back has frames of the shard
+	 * pinned, waits for news from the shard (the latch is released meanwhile) and returns
+	 * true: the caller looks again. Otherwise every frame is in use and it returns false.
+	 */
+	bool waitForWriteBack(Shard &shard, std::unique_lock<std::mutex> &lock);
+
+	/**
+	 * Puts a staged victim whose write-back failed back into frame_id, which the caller has
+	 * unmapped (caller holds the latch). The copy is the only one with the victim's changes:
+	 * the page is mapped again, dirty and evictable, and leaves shard.writing.
+	 */
+	void restoreVictim(Shard &shard, uint32_t victim_id, uint32_t frame_id, const char *staging);
+
+	/**
+	 * Writes these frames of the shard in one batch. The caller holds the shard latch and
+	 * a shared latch on each frame, and has pinned them and marked them clean; the write
+	 * runs without the shard latch. Afterwards the frames are unlatched and unpinned (dirty
+	 * again if the write failed).
+	 */
+	void writeFrames(Shard &shard, std::unique_lock<std::mutex> &lock, const std::vector<uint32_t> &frame_ids);
+
+	// Writes every dirty frame of the shard that nobody is modifying
+	void writeBackDirtyPages(Shard &shard);
+
+	// Maps a brand-new page id to a zeroed, pinned frame (no read: it has never been written)
+	Page *installNewPage(uint32_t page_id);
 
   public:
-	BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+	/**
+	 * With mmap_reads = true the file is mapped read-only and fetchPageForRead()
+	 * returns pages straight from the mapping (zero-copy, no frame used). Writes
+	 * keep going through the regular frames.
+	 * shard_count = 0 picks one shard per MIN_FRAMES_PER_SHARD frames (at least one).
+	 * replacer_policy chooses how each shard picks the frame to evict (see ReplacerPolicy).
+	 */
+	BufferPoolManager(size_t pool_size, DiskManager *disk_manager, bool mmap_reads = false, size_t shard_count = 0,
+					  ReplacerPolicy replacer_policy = ReplacerPolicy::LRU);
 	~BufferPoolManager();
 
-	// Brings a page into RAM. If it's already there, just increase the pin_count.
+	// Frames in the pool
+	size_t getPoolSize() const { return pool_size; }
+
+	size_t getShardCount() const { return shards.size(); }
+
+	/**
+	 * Brings a page into RAM. If it's already there, just increase the pin_count.
+	 * A page already in RAM is pinned without the shard latch (a lookup in the page table
+	 * and a compare-and-swap on the frame's descriptor), so readers of resident pages
+	 * never wait for each other; with ReplacerPolicy::CLOCK no lock is taken at all.
+	 */
 	Page *fetchPage(uint32_t page_id);
 
-	// Indicates that you no longer use the page. isdirty = true if modified.
+	// Indicates that you no longer use the page. isdirty = true if modified. Takes no latch
+	// unless the page table was being changed during the lookup
 	bool unpinPage(uint32_t page_id, bool is_dirty_flag);
 
-	// Creates a new page on the disk and loads it into RAM.
+	/**
+	 * Reader/writer latch on the contents of a pinned page. Pinning keeps the page in
+	 * its frame; latching keeps other threads from changing it while it is being read
+	 * (shared) or written (exclusive). Release the latch before unpinning the page.
+	 * Pages served from the file mapping are not latched (read-mostly mode).
+	 */
+	void latchPage(const Page *page, bool exclusive);
+	bool tryLatchPage(const Page *page, bool exclusive);
+	void unlatchPage(const Page *page, bool exclusive);
+
+	/**
+	 * Read-only access to a page. If it is not cached in a frame and lies inside the
+	 * file mapping, the mapped bytes are returned directly; otherwise this is fetchPage().
+	 * The caller must not modify the page and must release it with unpinPageForRead().
+	 */
+	const Page *fetchPageForRead(uint32_t page_id);
+	bool unpinPageForRead(uint32_t page_id, const Page *page);
+
+	// Creates a new page on the disk and loads it into RAM. Freed pages are reused first.
 	Page *newPage(uint32_t &page_id, ModelType object_type);
 
-	// NOT USED - deletePage() was never called
-	// Page deletion wasn't required for Phase 1-6 implementation.
+	/**
+	 * Frees a page: it is rewritten as a FREE_PAGE and pushed onto the free list,
+	 * so the next newPage() reuses it. Returns false if the page is pinned.
+	 */
 	bool deletePage(uint32_t page_id);
 
-	// Forces writing a page to the disk.
+	// Forces writing a page to the disk. Returns false if it's not in RAM or is being modified.
 	bool flushPage(uint32_t page_id);
+
+	/**
+	 * Writes every dirty page and waits for durability as the DiskManager's policy dictates.
+	 * Pages latched exclusively at that moment (mid-update) are left dirty for the next flush.
+	 */
+	void flushAllPages();
+
+	/**
+	 * Loads the pages that are not in RAM yet (nor served from the file mapping) with a single batch of reads, so many
+	 * of them are in flight at once (e.g. the data pages a range scan is about to visit).
+	 * The pages are left unpinned; use fetchPage() as usual to access them.
+	 * Loads at most half of the pool per call. Returns how many pages were read.
+	 */
+	size_t prefetchPages(const std::vector<uint32_t> &page_ids);
+
+	/**
+	 * Allocator counter: the id the next newPage() hands out.
+	 * Starts at the file size; the Database restores it from the superblock on open.
+	 */
+	uint32_t getNextPageId();
+	void setNextPageId(uint32_t page_id);
+
+	// Head of the free-page list; the Database keeps it in the superblock.
+	uint32_t getFreePageHead();
+	void setFreePageHead(uint32_t page_id);
 };
 
 } // namespace LuminaDB
@@ -0,0 +1,40 @@
+#ifndef LUMINADB_CLOCK_REPLACER_HPP
+#define LUMINADB_CLOCK_REPLACER_HPP
+
+#include "Replacer.hpp"
+#include <atomic>
+#include <memory>
+
+namespace LuminaDB {
+
+/**
+ * CLOCK (second chance) replacement. Each frame has a byte of state: EVICTABLE while it
+ * is unpinned and REFERENCED since it was last unpinned. victim() turns the clock hand
+ * over the frames, clearing REFERENCED bits until it meets an evictable frame without it.
+ *
+ * pin() and unpin() are one atomic read-modify-write each, and the hand is an atomic
+ * counter, so no operation takes a lock or allocates.
+ */
+class ClockReplacer : public Replacer {
+  private:
+	static constexpr uint8_t EVICTABLE = 1;
+	static constexpr uint8_t REFERENCED = 2;
+
+	size_t num_frames;
+	std::unique_ptr<std::atomic<uint8_t>[]> state; // Per frame: EVICTABLE | REFERENCED
+	std::atomic<size_t> hand;					   // Next frame the clock looks at (modulo num_frames)
+	std::atomic<size_t> evictable;				   // Frames with EVICTABLE set
+
+  public:
+	explicit ClockReplacer(size_t num_frames);
+	~ClockReplacer() override;
+
+	bool victim(uint32_t *frame_id) override;
+	void pin(uint32_t frame_id) override;
+	void unpin(uint32_t frame_id) override;
+	size_t Size() override;
+};
+
+} // namespace LuminaDB
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef LUMINADB_FRAME_LIST_HPP
+#define LUMINADB_FRAME_LIST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace LuminaDB {
+
+/**
+ * Doubly linked list of frame ids (0 .. num_frames - 1), linked through arrays sized once:
+ * moving a frame in or out never allocates. The front is the oldest entry.
+ * A frame is in the list at most once; the owner keeps track of which list holds it.
+ */
+class FrameList {
+  public:
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+  private:
+	std::vector<uint32_t> prev;
+	std::vector<uint32_t> next;
+	uint32_t head;
+	uint32_t tail;
+	size_t count;
+
+  public:
+	explicit FrameList(size_t num_frames);
+
+	void pushBack(uint32_t frame_id);
+	void remove(uint32_t frame_id);
+
+	// Moves a frame that is in the list to the back (most recent)
+	void moveToBack(uint32_t frame_id);
+
+	// Walk from the oldest entry: front(), then after(frame) until NONE
+	uint32_t front() const { return head; }
+	uint32_t after(uint32_t frame_id) const { return next[frame_id]; }
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+};
+
+/**
+ * FIFO of page ids recently evicted ("ghost" entries: the history is kept, not the page).
+ * Bounded by the owner, which drops the oldest entries with popFront().
+ */
+class GhostList {
+  private:
+	std::list<uint32_t> order; // Oldest first
+	std::unordered_map<uint32_t, std::list<uint32_t>::iterator> index;
+
+  public:
+	void pushBack(uint32_t page_id);
+
+	// Removes page_id if present; returns whether it was there
+	bool erase(uint32_t page_id);
+
+	// Oldest page id (the list must not be empty)
+	uint32_t front() const { return order.front(); }
+	void popFront();
+
+	size_t size() const { return order.size(); }
+	bool empty() const { return order.empty(); }
+};
+
+} // namespace LuminaDB
+
+#endif
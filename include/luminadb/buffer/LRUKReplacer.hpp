@@ -0,0 +1,70 @@
+#ifndef LUMINADB_LRU_K_REPLACER_HPP
+#define LUMINADB_LRU_K_REPLACER_HPP
+
+#include "FrameList.hpp"
+#include "Replacer.hpp"
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace LuminaDB {
+
+// References remembered per page by LRUKReplacer
+inline constexpr size_t LRU_K_DEFAULT = 2;
+
+/**
+ * LRU-K replacement. Every frame remembers the times of the last K references to its
+ * page; the victim is the unpinned page whose K-th most recent reference is oldest.
+ * Pages referenced fewer than K times (a scan reads each page once) go before any
+ * other, oldest first reference first, so one pass over cold pages does not evict
+ * pages that are used over and over. References within the correlated reference period
+ * of the one that opened a burst (see CORRELATED_REFERENCE_DIVISOR) are not recorded, so
+ * a scan that reads a page several times in a row still leaves a single reference.
+ *
+ * The history of evicted pages is kept for as many pages as there are frames, so a
+ * page that comes back soon after being evicted keeps its references.
+ */
+class LRUKReplacer : public Replacer {
+  private:
+	std::mutex latch;
+	size_t num_frames;
+	size_t k;
+	uint64_t current_time;		// Logical clock: one tick per reference
+	uint64_t correlated_period; // Ticks after a recorded reference during which others are not recorded
+
+	std::vector<uint32_t> frame_page; // Page held by each frame (INVALID_PAGE_ID: none referenced yet)
+	std::vector<uint64_t> stamps;	  // k reference times per frame, most recent first (0 = none)
+	std::vector<uint8_t> evictable;
+	std::vector<uint64_t> keys;		  // Eviction key of each evictable frame (see evictionKey())
+
+	// Evictable frames ordered by eviction key: begin() is the victim
+	std::set<std::pair<uint64_t, uint32_t>> candidates;
+
+	// Reference times of recently evicted pages, oldest eviction first in retained_order
+	std::unordered_map<uint32_t, std::vector<uint64_t>> retained;
+	GhostList retained_order;
+
+	// Smaller is evicted first: pages with fewer than k references by their first one,
+	// then the rest by their k-th most recent one (with the top bit set)
+	uint64_t evictionKey(uint32_t frame_id) const;
+
+	// Helper: Clears the frame's page and history (caller holds the latch)
+	void forget(uint32_t frame_id);
+
+  public:
+	explicit LRUKReplacer(size_t num_frames, size_t k = LRU_K_DEFAULT);
+	~LRUKReplacer() override;
+
+	bool victim(uint32_t *frame_id) override;
+	void pin(uint32_t frame_id) override;
+	void unpin(uint32_t frame_id) override;
+	size_t Size() override;
+	void recordAccess(uint32_t frame_id, uint32_t page_id) override;
+	void remove(uint32_t frame_id) override;
+};
+
+} // namespace LuminaDB
+
+#endif
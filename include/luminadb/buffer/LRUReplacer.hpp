@@ -1,12 +1,13 @@
 #ifndef LUMINADB_LRU_REPLACER_HPP
 #define LUMINADB_LRU_REPLACER_HPP
 
+#include "Replacer.hpp"
 #include <list>
 #include <mutex>
 #include <unordered_map>
 
 namespace LuminaDB {
-class LRUReplacer {
+class LRUReplacer : public Replacer {
   private:
 	std::mutex latch;
 	std::list<uint32_t> lru_list;
@@ -15,27 +16,27 @@ class LRUReplacer {
 
   public:
 	explicit LRUReplacer(size_t num_pages);
-	~LRUReplacer();
+	~LRUReplacer() override;
 
 	/**
 	 * Choose the oldest frame to be evicted.
 	 * Returns true if one is found, false if there is no one to be evicted.
 	 */
-	bool victim(uint32_t *frame_id);
+	bool victim(uint32_t *frame_id) override;
 
 	/**
 	 * "Pin" a page. Removes the frame from the replacer because someone is using it.
 	 */
-	void pin(uint32_t frame_id);
+	void pin(uint32_t frame_id) override;
 
 	/**
 	 * "Release" a page. Adds the frame to the replacer so it's a candidate to be removed.
 	 */
-	void unpin(uint32_t frame_id);
+	void unpin(uint32_t frame_id) override;
 
 	// NOT USED - Size() is a debug method never called
 	// Implemented for monitoring but not used in production code.
-	size_t Size();
+	size_t Size() override;
 };
 
 } // namespace LuminaDB
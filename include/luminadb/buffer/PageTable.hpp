@@ -0,0 +1,60 @@
+#ifndef LUMINADB_PAGE_TABLE_HPP
+#define LUMINADB_PAGE_TABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace LuminaDB {
+
+/**
+ * page_id -> frame_id map of one buffer pool shard. A flat array of 8-byte entries with
+ * a power-of-two size, at least twice the number of frames, searched by linear probing:
+ * a lookup reads one or two adjacent entries, usually on the same cache line, and
+ * nothing is allocated after construction.
+ *
+ * erase() shifts the entries that follow back into the hole, so there are no tombstones
+ * and probe chains stay as short as if the erased page had never been inserted.
+ *
+ * insert() and erase() are serialized by the shard latch, but find() can run without it:
+ * each entry is one atomic word, so a lookup never pairs a page with a frame it was not
+ * mapped to. A lookup racing with a change may miss the page or return a mapping that is
+ * being removed; the caller validates the frame (see FrameDescriptor::tryPin()).
+ */
+class PageTable {
+  public:
+	static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+  private:
+	// Entry: page_id << 32 | frame_id (page_id is INVALID_PAGE_ID if the slot is empty)
+	std::unique_ptr<std::atomic<uint64_t>[]> entries;
+	size_t mask;  // Entry count - 1
+	size_t count; // Written under the shard latch
+
+	size_t home(uint32_t page_id) const;
+
+	static uint64_t pack(uint32_t page_id, uint32_t frame_id) {
+		return (static_cast<uint64_t>(page_id) << 32) | frame_id;
+	}
+	static uint32_t pageOf(uint64_t entry) { return static_cast<uint32_t>(entry >> 32); }
+
+  public:
+	// A table for up to max_entries pages (the frames of the shard)
+	explicit PageTable(size_t max_entries);
+
+	// Frame holding page_id, or NOT_FOUND (safe without the latch, see above)
+	uint32_t find(uint32_t page_id) const;
+
+	// Maps a page that is not in the table yet
+	void insert(uint32_t page_id, uint32_t frame_id);
+
+	// Removes page_id; returns false if it was not there
+	bool erase(uint32_t page_id);
+
+	size_t size() const { return count; }
+};
+
+} // namespace LuminaDB
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef LUMINADB_REPLACER_HPP
+#define LUMINADB_REPLACER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace LuminaDB {
+
+/**
+ * Page replacement policy of the buffer pool:
+ *  - LRU:   evicts the frame unpinned longest ago (exact order, list under a mutex).
+ *  - CLOCK: second chance over a reference bit per frame; pin/unpin are single atomic
+ *           operations, with no lock and no allocation.
+ *  - LRU_K: evicts the page whose K-th most recent reference is oldest; pages referenced
+ *           fewer than K times go first (see LRUKReplacer).
+ *  - TWO_Q: new pages wait in a small FIFO and only reach the main LRU if they are
+ *           referenced again after leaving it (see TwoQReplacer).
+ *  - ARC:   balances a recency list and a frequency list, adapting the split to the
+ *           history of recently evicted pages (see ARCReplacer).
+ * LRU_K, TWO_Q and ARC resist scans: pages read once do not push out the hot ones.
+ */
+enum class ReplacerPolicy { LRU = 0, CLOCK = 1, LRU_K = 2, TWO_Q = 3, ARC = 4 };
+
+/**
+ * Correlated reference period of LRU_K and ARC, as a share (1 / divisor) of the replacer's
+ * frames, counted in references to the replacer. A page referenced again this soon after
+ * the reference that brought it in (or that opened its latest burst) counts as referenced
+ * once: a scan reading the records of a page one by one, each under its own pin, does
+ * not make the page look hot.
+ */
+inline constexpr size_t CORRELATED_REFERENCE_DIVISOR = 2;
+
+/**
+ * Picks the frame to evict among the unpinned ones. Frame ids go from 0 to the
+ * num_frames given at construction (each buffer pool shard has its own replacer).
+ */
+class Replacer {
+  public:
+	virtual ~Replacer() = default;
+
+	/**
+	 * Chooses a frame to be evicted and stops tracking it.
+	 * Returns true if one is found, false if there is no one to be evicted.
+	 */
+	virtual bool victim(uint32_t *frame_id) = 0;
+
+	// The frame is in use: it must not become a victim
+	virtual void pin(uint32_t frame_id) = 0;
+
+	// Nobody uses the frame any more: it is a candidate for eviction
+	virtual void unpin(uint32_t frame_id) = 0;
+
+	// Frames that can be evicted right now
+	virtual size_t Size() = 0;
+
+	/**
+	 * page_id was requested and is in the frame (a hit, or a page just read or created).
+	 * Policies that keep a history per page use it; a frame that is unpinned without
+	 * ever being accessed (prefetched) counts as holding a page not referenced yet.
+	 */
+	virtual void recordAccess(uint32_t /*frame_id*/, uint32_t /*page_id*/) {}
+
+	// The frame lost its page without being chosen as a victim (it goes back to the free list)
+	virtual void remove(uint32_t frame_id) { pin(frame_id); }
+};
+
+// Builds the replacer of the given policy over num_frames frames
+std::unique_ptr<Replacer> makeReplacer(ReplacerPolicy policy, size_t num_frames);
+
+} // namespace LuminaDB
+
+#endif
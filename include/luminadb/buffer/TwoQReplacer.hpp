@@ -0,0 +1,62 @@
+#ifndef LUMINADB_TWO_Q_REPLACER_HPP
+#define LUMINADB_TWO_Q_REPLACER_HPP
+
+#include "FrameList.hpp"
+#include "Replacer.hpp"
+#include <mutex>
+#include <vector>
+
+namespace LuminaDB {
+
+// Share of the frames (1 / divisor) the 2Q admission FIFO keeps, and of the ids it remembers
+inline constexpr size_t TWO_Q_IN_DIVISOR = 4;
+inline constexpr size_t TWO_Q_OUT_DIVISOR = 2;
+
+/**
+ * 2Q replacement (full version, with a ghost queue).
+ *  - A1in:  FIFO of pages referenced once. A new page waits here; hitting it again
+ *           while it waits changes nothing (correlated references, like a scan reading
+ *           several records of the same page).
+ *  - A1out: ids of the pages evicted from A1in (no frames).
+ *  - Am:    LRU of the pages requested again while in A1out: the hot set.
+ * Frames are taken from A1in while it holds more than its share, so a scan only
+ * cycles through A1in and never reaches the pages in Am.
+ */
+class TwoQReplacer : public Replacer {
+  private:
+	enum Queue : uint8_t { NO_QUEUE = 0, IN_QUEUE = 1, MAIN_QUEUE = 2 };
+
+	std::mutex latch;
+	size_t in_target; // A1in is drained first while it holds more frames than this
+	size_t out_limit; // Ids kept in A1out
+
+	FrameList a1in;
+	FrameList am;
+	GhostList a1out;
+
+	std::vector<uint8_t> queue_of; // Queue each frame is in
+	std::vector<uint8_t> evictable;
+	std::vector<uint32_t> frame_page;
+	size_t evictable_count;
+
+	// Oldest evictable frame of the list, or FrameList::NONE
+	uint32_t firstEvictable(const FrameList &list) const;
+
+	// Helper: Takes the frame out of its queue (caller holds the latch)
+	void detach(uint32_t frame_id);
+
+  public:
+	explicit TwoQReplacer(size_t num_frames);
+	~TwoQReplacer() override;
+
+	bool victim(uint32_t *frame_id) override;
+	void pin(uint32_t frame_id) override;
+	void unpin(uint32_t frame_id) override;
+	size_t Size() override;
+	void recordAccess(uint32_t frame_id, uint32_t page_id) override;
+	void remove(uint32_t frame_id) override;
+};
+
+} // namespace LuminaDB
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef LUMINADB_LOG_HPP
+#define LUMINADB_LOG_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Log levels, usable in #if (LUMINADB_LOG_LEVEL is set by CMake, see LUMINADB_LOG_LEVEL there)
+#define LUMINADB_LEVEL_TRACE 0
+#define LUMINADB_LEVEL_DEBUG 1
+#define LUMINADB_LEVEL_INFO 2
+#define LUMINADB_LEVEL_WARN 3
+#define LUMINADB_LEVEL_ERROR 4
+#define LUMINADB_LEVEL_OFF 5
+
+#ifndef LUMINADB_LOG_LEVEL
+#define LUMINADB_LOG_LEVEL LUMINADB_LEVEL_INFO
+#endif
+
+#ifndef LUMINADB_ENABLE_TRACE
+#define LUMINADB_ENABLE_TRACE 1
+#endif
+
+namespace LuminaDB {
+
+enum class LogLevel { TRACE = 0, DEBUG = 1, INFO = 2, WARN = 3, ERROR = 4 };
+
+/**
+ * Sink of the LUMINADB_LOG_* macros: one line per message on std::clog,
+ * "[component] message", serialized between threads.
+ * Call sites below LUMINADB_LOG_LEVEL are removed by the preprocessor, so they cost
+ * nothing (their arguments are not even evaluated).
+ */
+class Log {
+  public:
+	static void write(LogLevel level, const char *component, const std::string &message);
+};
+
+// One entry of the trace ring
+struct TraceEvent {
+	uint64_t sequence;	   // Global order of the event
+	uint64_t timestamp_ns; // steady_clock
+	uint64_t thread;	   // Hash of the thread id
+	const char *event;	   // String literal naming the event
+	uint64_t a;
+	uint64_t b;
+};
+
+/**
+ * In-memory ring of the last CAPACITY trace events (LUMINADB_TRACE), for debugging.
+ * Disabled by default: a disabled trace point costs one relaxed atomic load.
+ * Recording is lock-free; snapshot() is best effort while other threads keep recording.
+ */
+class TraceBuffer {
+  private:
+	inline static std::atomic<bool> enabled{false};
+
+  public:
+	static constexpr size_t CAPACITY = 4096; // Power of two
+
+	static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+	static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+	static void record(const char *event, uint64_t a, uint64_t b);
+
+	// Events still in the ring, oldest first
+	static std::vector<TraceEvent> snapshot();
+
+	// Writes snapshot() as text, one event per line
+	static void dump(std::ostream &out);
+
+	static void clear();
+};
+
+} // namespace LuminaDB
+
+#define LUMINADB_LOG_EMIT(level, component, message)                                                                  \
+	do {                                                                                                               \
+		std::ostringstream luminadb_log_stream;                                                                        \
+		luminadb_log_stream << message;                                                                                \
+		::LuminaDB::Log::write(level, component, luminadb_log_stream.str());                                           \
+	} while (0)
+
+#define LUMINADB_LOG_DISABLED(component, message)                                                                     \
+	do {                                                                                                               \
+	} while (0)
+
+// Usage: LUMINADB_LOG_DEBUG("BPM", "Evicted page " << page_id);
+#if LUMINADB_LOG_LEVEL <= LUMINADB_LEVEL_TRACE
+#define LUMINADB_LOG_TRACE(component, message) LUMINADB_LOG_EMIT(::LuminaDB::LogLevel::TRACE, component, message)
+#else
+#define LUMINADB_LOG_TRACE(component, message) LUMINADB_LOG_DISABLED(component, message)
+#endif
+
+#if LUMINADB_LOG_LEVEL <= LUMINADB_LEVEL_DEBUG
+#define LUMINADB_LOG_DEBUG(component, message) LUMINADB_LOG_EMIT(::LuminaDB::LogLevel::DEBUG, component, message)
+#else
+#define LUMINADB_LOG_DEBUG(component, message) LUMINADB_LOG_DISABLED(component, message)
+#endif
+
+#if LUMINADB_LOG_LEVEL <= LUMINADB_LEVEL_INFO
+#define LUMINADB_LOG_INFO(component, message) LUMINADB_LOG_EMIT(::LuminaDB::LogLevel::INFO, component, message)
+#else
+#define LUMINADB_LOG_INFO(component, message) LUMINADB_LOG_DISABLED(component, message)
+#endif
+
+#if LUMINADB_LOG_LEVEL <= LUMINADB_LEVEL_WARN
+#define LUMINADB_LOG_WARN(component, message) LUMINADB_LOG_EMIT(::LuminaDB::LogLevel::WARN, component, message)
+#else
+#define LUMINADB_LOG_WARN(component, message) LUMINADB_LOG_DISABLED(component, message)
+#endif
+
+#if LUMINADB_LOG_LEVEL <= LUMINADB_LEVEL_ERROR
+#define LUMINADB_LOG_ERROR(component, message) LUMINADB_LOG_EMIT(::LuminaDB::LogLevel::ERROR, component, message)
+#else
+#define LUMINADB_LOG_ERROR(component, message) LUMINADB_LOG_DISABLED(component, message)
+#endif
+
+// Usage: LUMINADB_TRACE("leaf_split", page_id, new_page_id); the event name must be a string literal
+#if LUMINADB_ENABLE_TRACE
+#define LUMINADB_TRACE(event, a, b)                                                                                    \
+	do {                                                                                                               \
+		if (::LuminaDB::TraceBuffer::isEnabled())                                                                      \
+			::LuminaDB::TraceBuffer::record(event, static_cast<uint64_t>(a), static_cast<uint64_t>(b));               \
+	} while (0)
+#else
+#define LUMINADB_TRACE(event, a, b)                                                                                    \
+	do {                                                                                                               \
+	} while (0)
+#endif
+
+#endif
@@ -5,6 +5,9 @@
 
 namespace LuminaDB {
 
+// Marks "no page" in page-id fields (0 is a valid page)
+inline constexpr uint32_t INVALID_PAGE_ID = 0xFFFFFFFF;
+
 /**
  * Structure of a Slot within the page.
  * Indicates where a record begins and its length.
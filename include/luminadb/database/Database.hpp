@@ -2,12 +2,23 @@
 #define LUMINADB_DATABASE_HPP
 
 #include "luminadb/buffer/BufferPoolManager.hpp"
+#include "luminadb/database/SecondaryIndex.hpp"
 #include "luminadb/index/BPlusTree.hpp"
 #include "luminadb/model/ModelFactory.hpp"
 #include "luminadb/storage/DiskManager.hpp"
+#include "luminadb/storage/FreeSpaceMap.hpp"
+#include "luminadb/storage/Superblock.hpp"
+#include <algorithm>
+#include <array>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace LuminaDB {
 
@@ -20,44 +31,221 @@ namespace LuminaDB {
  *   User user(1, "Alice", 25);
  *   db.insert<User>(1, user);
  *   User found = db.find<User>(1);
+ *
+ * Key is the type of the primary key (any type BPlusTree is instantiated for, see
+ * KeyTypes.hpp); Database is the uint32_t flavour. The key type is recorded in the
+ * catalog and a file is refused if it is opened with another one:
+ *   BasicDatabase<StringKey32> users("users.db");
+ *   users.insert<User>("alice", user);
+ *
+ * insert/find/remove/rangeScan can be called from several threads at once: the index
+ * latches its nodes and data pages are latched while a record is read or written.
+ * There are no transactions: a find racing with the remove of the same key may
+ * report the key as missing.
+ *
+ * Secondary indexes (createIndex/findBy) look records up by one of their fields:
+ *   db.createIndex<SensorData>("by_sensor", [](const SensorData &s) { return s.getSensorId(); });
+ *   db.findBy<SensorData>("by_sensor", 7u, [](const SensorData &s) { ... });
  */
-class Database {
+template <typename Key> class BasicDatabase {
   private:
+	using Index = BPlusTree<Key>;
+
 	std::unique_ptr<DiskManager> disk_manager;
 	std::unique_ptr<BufferPoolManager> buffer_pool_manager;
-	std::unique_ptr<BPlusTree> index;
+	std::unique_ptr<Index> index;
 	std::string db_file;
-	uint32_t next_data_page_id; // For allocating new data pages
+
+	// Meta page (page 0): root ids, allocator counters and catalog
+	Superblock superblock;
+	std::mutex meta_latch; // Guards superblock and its page
+
+	// Readers that hold RecordIDs taken from the index (find, rangeScan) share it; remove takes it
+	// exclusively to free a record's slot, so a slot is never reused under a reader that still points to it
+	std::shared_mutex reclaim_latch;
+
+	// Data pages with room left, per type (persisted in a chain of pages that starts at the superblock's fsm page)
+	FreeSpaceMap free_space_map;
+	std::vector<uint32_t> fsm_pages; // That chain, in order (guarded by meta_latch)
+
+	// Name of the primary index in the catalog
+	static constexpr const char *PRIMARY_INDEX = "primary";
+
+	// Secondary indexes declared with createIndex(), kept up to date by insert/bulkLoad/remove
+	std::vector<std::unique_ptr<SecondaryIndexBase>> secondary_indexes;
+
+	// Secondary indexes in the catalog that haven't been declared again since open();
+	// writes are refused until they are, or those indexes would miss the changes
+	size_t undeclared_indexes = 0;
+
+	// Helpers: Lay out a new file / open an existing one from its superblock
+	void format();
+	void open();
+
+	// Helper: Write the in-memory superblock (with the current counters and roots) to page 0
+	void persistSuperblock();
+	void persistSuperblockLocked(); // Caller holds meta_latch
+
+	// Helper: Persist the superblock right away if an index got a new root
+	void syncCatalog();
+
+	// Helper: Throw if a secondary index of the catalog is not declared yet
+	void checkWritable() const;
+
+	// Helper: The secondary index called 'name', or nullptr
+	SecondaryIndexBase *findSecondaryIndex(const std::string &name) const;
+
+	// Helper: Add a just-stored record to the secondary indexes of its type
+	void indexObject(const Storable &obj, const RecordID &record_id);
+
+	// Helper: Remove the record at RecordID from the secondary indexes of its type
+	void unindexObject(const RecordID &record_id);
 
 	// Helper: Convert object to RecordID (find where to store it)
 	RecordID storeObject(const Storable &obj);
 
-	// Helper: Retrieve object from page using RecordID
-	std::vector<char> retrieveObjectBuffer(const RecordID &record_id);
+	// Helper: Delete the record at RecordID and release its page if it became empty
+	void releaseObject(const RecordID &record_id);
+
+	// Helper: Save the free-space map to its chain of pages, growing or shrinking the chain to fit
+	void persistFreeSpaceMap();
+
+	// Helper: Free the index pages that were still pinned when their tree let go of them
+	void freePendingIndexPages();
+
+	// Helper: Deserialize the object stored at RecordID straight from its page (no intermediate copy)
+	template <typename T> T readObject(const RecordID &record_id) {
+		const Page *page = buffer_pool_manager->fetchPageForRead(record_id.page_id);
+
+		if (page == nullptr) {
+			throw std::runtime_error("Data page not found: " + std::to_string(record_id.page_id));
+		}
+
+		buffer_pool_manager->latchPage(page, false);
+
+		uint16_t data_size = 0;
+		const char *page_data = page->getRecord(record_id.slot_num, data_size);
+
+		if (page_data == nullptr) {
+			buffer_pool_manager->unlatchPage(page, false);
+			buffer_pool_manager->unpinPageForRead(record_id.page_id, page);
+			throw std::runtime_error("Record slot not found in page: " + std::to_string(record_id.page_id));
+		}
+
+		T obj = ModelFactory::deserialize<T>(page_data);
+		buffer_pool_manager->unlatchPage(page, false);
+		buffer_pool_manager->unpinPageForRead(record_id.page_id, page);
+		return obj;
+	}
 
-	// Helper: Allocate a new data page
-	uint32_t allocateDataPage();
+	// Helper: Allocate a new data page (returned pinned and latched exclusively)
+	Page *allocateDataPage(ModelType type, uint32_t &page_id);
+
+	// Helper: Read the record at RecordID into obj if it is a T (false for a record of another model)
+	template <typename T> bool readObjectIf(const RecordID &record_id, T &obj) {
+		const Page *page = buffer_pool_manager->fetchPageForRead(record_id.page_id);
+
+		if (page == nullptr) {
+			throw std::runtime_error("Data page not found: " + std::to_string(record_id.page_id));
+		}
+
+		buffer_pool_manager->latchPage(page, false);
+
+		uint16_t data_size = 0;
+		const char *page_data = page->getRecord(record_id.slot_num, data_size);
+		bool same_type =
+			page_data != nullptr && page->getHeader()->object_type == static_cast<uint32_t>(obj.getType());
+		if (same_type) {
+			obj = ModelFactory::deserialize<T>(page_data);
+		}
+
+		buffer_pool_manager->unlatchPage(page, false);
+		buffer_pool_manager->unpinPageForRead(record_id.page_id, page);
+		return same_type;
+	}
+
+	// Keys gathered by rangeScan() before their data pages are prefetched together
+	static constexpr size_t RANGE_SCAN_BATCH = 64;
+
+	// Helper: Prefetch the data pages of these RecordIDs (sorted by page), a batch at a time, and hand out the objects
+	template <typename T, typename Fn> size_t emitRecords(const std::vector<RecordID> &record_ids, Fn &fn) {
+		for (size_t start = 0; start < record_ids.size(); start += RANGE_SCAN_BATCH) {
+			size_t end = std::min(record_ids.size(), start + RANGE_SCAN_BATCH);
+
+			std::vector<uint32_t> data_pages;
+			for (size_t i = start; i < end; i++) {
+				if (data_pages.empty() || data_pages.back() != record_ids[i].page_id) {
+					data_pages.push_back(record_ids[i].page_id);
+				}
+			}
+			buffer_pool_manager->prefetchPages(data_pages);
+
+			for (size_t i = start; i < end; i++) {
+				fn(readObject<T>(record_ids[i]));
+			}
+		}
+		return record_ids.size();
+	}
+
+	// Helper: Prefetch the data pages of a batch of scanned keys, then hand out the objects in key order
+	template <typename T, typename Fn>
+	size_t emitScanBatch(std::vector<std::pair<Key, RecordID>> &batch, Fn &fn) {
+		std::vector<uint32_t> data_pages;
+		for (const auto &entry : batch) {
+			if (data_pages.empty() || data_pages.back() != entry.second.page_id) {
+				data_pages.push_back(entry.second.page_id);
+			}
+		}
+		buffer_pool_manager->prefetchPages(data_pages);
+
+		for (const auto &entry : batch) {
+			fn(entry.first, readObject<T>(entry.second));
+		}
+
+		size_t emitted = batch.size();
+		batch.clear();
+		return emitted;
+	}
 
   public:
-	// Constructor: Opens or creates database
-	explicit Database(const std::string &filename, uint32_t buffer_pool_size = 10);
+	/**
+	 * Constructor: Opens or creates database.
+	 * memory_mapped_reads = true serves lookups from a read-only mapping of the file
+	 * instead of copying pages into the buffer pool (for large, read-mostly files).
+	 * replacer_policy chooses the buffer pool's eviction policy: LRU, CLOCK, LRU_K, TWO_Q or ARC
+	 * (see ReplacerPolicy in Replacer.hpp).
+	 */
+	explicit BasicDatabase(const std::string &filename, uint32_t buffer_pool_size = 10,
+						   const DurabilityOptions &durability = {}, bool memory_mapped_reads = false,
+						   ReplacerPolicy replacer_policy = ReplacerPolicy::LRU);
 
 	// Destructor: Flushes all pages to disk
-	~Database();
+	~BasicDatabase();
 
 	/**
 	 * Insert a typed object with a key.
 	 * Returns true if inserted, false if key already exists.
 	 */
-	template <typename T> bool insert(uint32_t key, const T &obj) {
+	template <typename T> bool insert(const Key &key, const T &obj) {
 		static_assert(std::is_base_of<Storable, T>::value, "T must inherit from Storable");
+		checkWritable();
 
 		try {
 			// Step 1: Store the object in a page
 			RecordID record_id = storeObject(obj);
 
 			// Step 2: Insert into B+ Tree index
-			index->insert(key, record_id);
+			if (!index->insert(key, record_id)) {
+				// Key already exists: no one else has seen this record, drop it right away
+				releaseObject(record_id);
+				return false;
+			}
+
+			// Step 3: Secondary indexes of this model
+			indexObject(obj, record_id);
+
+			// Step 4: A root split must reach the superblock, or a reopen would miss the new root
+			syncCatalog();
 
 			return true;
 		} catch (const std::exception &) {
@@ -67,43 +255,230 @@ class Database {
 		}
 	}
 
+	/**
+	 * Loads an empty database from a stream of objects sorted by strictly increasing key.
+	 * next(key, obj) fills in the next pair and returns false at the end of the stream.
+	 * Objects are packed into data pages in stream order and the index is built
+	 * bottom-up with BPlusTree::bulkLoad (see there for fill_factor).
+	 * Returns the number of objects loaded; throws if the database is not empty, or on the
+ * first key that is not greater than the one before it (nothing of that object is stored).
+	 */
+	template <typename T>
+	size_t bulkLoad(const std::function<bool(Key &key, T &obj)> &next, double fill_factor = 1.0) {
+		static_assert(std::is_base_of<Storable, T>::value, "T must inherit from Storable");
+		checkWritable();
+
+		T obj;
+		Key previous{};
+		bool has_previous = false;
+		size_t loaded;
+		try {
+			loaded = index->bulkLoad(
+				[&](Key &key, RecordID &record_id) {
+					if (!next(key, obj)) {
+						return false;
+					}
+
+					// Reject an out-of-order key here, before its record and secondary entries exist
+					// (the tree would only notice once they had been written)
+					if (has_previous && !std::less<Key>{}(previous, key)) {
+						throw std::runtime_error("bulkLoad: keys must be strictly increasing (" + keyToString(key) +
+												 " after " + keyToString(previous) + ")");
+					}
+					previous = key;
+					has_previous = true;
+
+					record_id = storeObject(obj);
+					indexObject(obj, record_id);
+					return true;
+				},
+				fill_factor);
+		} catch (...) {
+			// Pages allocated so far must still reach the superblock's counters
+			syncCatalog();
+			throw;
+		}
+
+		// The root is a new page now
+		syncCatalog();
+		return loaded;
+	}
+
 	/**
 	 * Find a typed object by key.
 	 * Returns the object if found, throws exception if not found.
 	 */
-	template <typename T> T find(uint32_t key) {
+	template <typename T> T find(const Key &key) {
 		static_assert(std::is_base_of<Storable, T>::value, "T must inherit from Storable");
 
+		std::shared_lock<std::shared_mutex> reclaim_lock(reclaim_latch);
+
 		// Step 1: Search B+ Tree for the key
 		RecordID record_id;
 		if (!index->getValue(key, record_id)) {
-			throw std::runtime_error("Key not found: " + std::to_string(key));
+			throw std::runtime_error("Key not found: " + keyToString(key));
+		}
+
+		// Step 2: Deserialize using ModelFactory, reading the page in place
+		return readObject<T>(record_id);
+	}
+
+	/**
+	 * Calls fn(key, object) for every key in [lo, hi], in key order, and returns how many.
+	 * The index is descended once and its leaves are walked in order. The data pages
+	 * of each batch of keys are read with a single prefetch.
+	 * fn must not modify the database. Concurrent removes free their records' slots only
+	 * once the scan returns, so a key seen by the scan is always read with its own object.
+	 */
+	template <typename T, typename Fn> size_t rangeScan(const Key &lo, const Key &hi, Fn &&fn) {
+		static_assert(std::is_base_of<Storable, T>::value, "T must inherit from Storable");
+
+		std::shared_lock<std::shared_mutex> reclaim_lock(reclaim_latch);
+
+		size_t count = 0;
+		std::vector<std::pair<Key, RecordID>> batch;
+		batch.reserve(RANGE_SCAN_BATCH);
+
+		for (typename Index::Iterator it = index->scan(lo, hi); !it.isEnd(); ++it) {
+			batch.emplace_back(it.key(), it.value());
+			if (batch.size() == RANGE_SCAN_BATCH) {
+				count += emitScanBatch<T>(batch, fn);
+			}
+		}
+		count += emitScanBatch<T>(batch, fn);
+
+		return count;
+	}
+
+	/**
+	 * Declares a secondary index over the field extract(obj) of every T record, stored in its
+	 * own BPlusTree under 'name' in the catalog. The field must be an unsigned integer.
+	 *
+	 * A new index is filled from the records already in the database (one pass over the
+	 * primary index); from then on insert/bulkLoad/remove keep it up to date. An index found
+	 * in the catalog is reopened as is: declare every index again after opening the file,
+	 * with the same extractor, before writing to it (writes throw until then).
+	 * Call it before the database is used from several threads.
+	 */
+	template <typename T, typename Extractor> void createIndex(const std::string &name, Extractor extract) {
+		static_assert(std::is_base_of<Storable, T>::value, "T must inherit from Storable");
+		using Raw = std::decay_t<std::invoke_result_t<Extractor, const T &>>;
+		using Field = typename IndexedField<Raw>::type;
+		using Secondary = SecondaryIndex<T, Field>;
+
+		std::function<Field(const T &)> extractor = [extract](const T &obj) {
+			return static_cast<Field>(extract(obj));
+		};
+
+		std::lock_guard<std::mutex> lock(meta_latch);
+
+		// STEP 1: One declaration per name
+		if (name == PRIMARY_INDEX || findSecondaryIndex(name) != nullptr) {
+			throw std::runtime_error("Index already declared: " + name);
+		}
+
+		// STEP 2: Already in the catalog: reopen its tree
+		uint32_t root_page_id = superblock.getIndexRoot(name);
+		if (root_page_id != INVALID_PAGE_ID) {
+			uint32_t key_type = superblock.getIndexKeyType(name);
+			if (key_type != KeyTraits<Field>::TYPE_ID) {
+				throw std::runtime_error("Index " + name + " was created with key type " + std::to_string(key_type) +
+										 ", cannot open it with key type " +
+										 std::to_string(KeyTraits<Field>::TYPE_ID));
+			}
+			secondary_indexes.push_back(
+				std::make_unique<Secondary>(name, root_page_id, buffer_pool_manager.get(), std::move(extractor)));
+			undeclared_indexes--;
+			return;
+		}
+
+		// STEP 3: New index: fill it from the records the primary index points to
+		auto secondary = std::make_unique<Secondary>(name, INVALID_PAGE_ID, buffer_pool_manager.get(), extractor);
+
+		std::array<uint8_t, KeyCodec<Key>::WIDTH + 8> bytes{};
+		Key lo = KeyCodec<Key>::decode(bytes.data());
+		bytes.fill(0xFF);
+		Key hi = KeyCodec<Key>::decode(bytes.data());
+
+		std::vector<RecordID> record_ids;
+		for (typename Index::Iterator it = index->scan(lo, hi); !it.isEnd(); ++it) {
+			record_ids.push_back(it.value());
 		}
 
-		// Step 2: Retrieve raw bytes from page
-		std::vector<char> buffer = retrieveObjectBuffer(record_id);
+		T obj;
+		for (const RecordID &record_id : record_ids) {
+			if (readObjectIf(record_id, obj)) {
+				secondary->insert(obj, record_id);
+			}
+		}
 
-		// Step 3: Deserialize using ModelFactory
-		return ModelFactory::deserialize<T>(buffer.data());
+		// STEP 4: Record it in the catalog
+		secondary_indexes.push_back(std::move(secondary));
+		persistSuperblockLocked();
+	}
+
+	/**
+	 * Calls fn(object) for every T record whose field in the secondary index 'index_name'
+	 * lies in [lo, hi], and returns how many. The matching RecordIDs are sorted by page
+	 * before the records are read, so each data page is fetched once and the pages of a
+	 * batch are prefetched together; fn sees the records in that (RecordID) order.
+	 * fn must not modify the database.
+	 */
+	template <typename T, typename Field, typename Fn>
+	size_t findBy(const std::string &index_name, const Field &lo, const Field &hi, Fn &&fn) {
+		static_assert(std::is_base_of<Storable, T>::value, "T must inherit from Storable");
+		static_assert(std::is_integral_v<Field> && std::is_unsigned_v<Field>,
+					  "Secondary indexes need unsigned integer fields");
+
+		SecondaryIndexBase *secondary = findSecondaryIndex(index_name);
+		if (secondary == nullptr) {
+			throw std::runtime_error("Index not declared: " + index_name);
+		}
+		if (secondary->getModelType() != T().getType()) {
+			throw std::runtime_error("Index " + index_name + " is on another model");
+		}
+
+		std::shared_lock<std::shared_mutex> reclaim_lock(reclaim_latch);
+
+		// Step 1: Matching records, in field order
+		std::vector<RecordID> record_ids;
+		secondary->collect(lo, hi, record_ids);
+
+		// Step 2: Read them in page order
+		std::sort(record_ids.begin(), record_ids.end(), [](const RecordID &a, const RecordID &b) {
+			return packRecordID(a) < packRecordID(b);
+		});
+		return emitRecords<T>(record_ids, fn);
+	}
+
+	// Every T record whose field in 'index_name' equals value
+	template <typename T, typename Field, typename Fn>
+	size_t findBy(const std::string &index_name, const Field &value, Fn &&fn) {
+		return findBy<T>(index_name, value, value, std::forward<Fn>(fn));
 	}
 
 	/**
 	 * Check if key exists.
 	 */
-	bool exists(uint32_t key) {
+	bool exists(const Key &key) {
 		RecordID dummy;
 		return index->getValue(key, dummy);
 	}
 
 	/**
 	 * Remove an object by key.
-	 * Note: This doesn't reclaim space (no vacuum in this version).
+	 * The record's slot is tombstoned and its space reused by later inserts; a data
+	 * page left empty (and any index page emptied by a merge) goes back to the allocator.
+	 * Returns false if the key doesn't exist.
 	 */
-	bool remove([[maybe_unused]] uint32_t key) {
-		// TODO: Implement when B+ Tree delete is available
-		// For now, just return false
-		return false;
-	}
+	bool remove(const Key &key);
+
+	/**
+	 * Writes every modified page and makes it durable according to the
+	 * DurabilityOptions given at open time (see DurabilityMode).
+	 * With GROUP_COMMIT, concurrent commit() calls share a single fdatasync.
+	 */
+	void commit();
 
 	/**
 	 * Get database filename.
@@ -111,6 +486,9 @@ class Database {
 	std::string getFilename() const { return db_file; }
 };
 
+// Database keyed by uint32_t, the original key type
+using Database = BasicDatabase<uint32_t>;
+
 } // namespace LuminaDB
 
 #endif
@@ -0,0 +1,111 @@
+#ifndef LUMINADB_SECONDARY_INDEX_HPP
+#define LUMINADB_SECONDARY_INDEX_HPP
+
+#include "luminadb/index/BPlusTree.hpp"
+#include "luminadb/model/ModelFactory.hpp"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace LuminaDB {
+
+/**
+ * Field types a secondary index can store: unsigned integers, widened to uint32_t or
+ * uint64_t (the key types the B+ Tree is compiled for).
+ */
+template <typename F> struct IndexedField {
+	static_assert(std::is_integral_v<F> && std::is_unsigned_v<F>, "Secondary indexes need unsigned integer fields");
+	using type = std::conditional_t<sizeof(F) <= sizeof(uint32_t), uint32_t, uint64_t>;
+};
+
+// RecordID as one number, ordered by page, then slot
+inline uint64_t packRecordID(const RecordID &record_id) {
+	return (static_cast<uint64_t>(record_id.page_id) << 16) | record_id.slot_num;
+}
+
+/**
+ * A secondary index as the database sees it, whatever its model and field type.
+ * Records of getModelType() are indexed; any other record is ignored.
+ */
+class SecondaryIndexBase {
+  public:
+	virtual ~SecondaryIndexBase() = default;
+
+	virtual const std::string &getName() const = 0;
+	virtual ModelType getModelType() const = 0;
+
+	// KeyTraits id of the tree's key, recorded in the catalog
+	virtual uint32_t getKeyType() const = 0;
+	virtual uint32_t getRootPageId() const = 0;
+
+	// Adds the entry of a record just stored at record_id (obj is of getModelType())
+	virtual void insert(const Storable &obj, const RecordID &record_id) = 0;
+
+	// Removes the entry of the record stored at record_id; record is its serialized form
+	virtual void remove(const char *record, const RecordID &record_id) = 0;
+
+	// Appends the RecordIDs of every record whose field lies in [lo, hi], in field order
+	virtual void collect(uint64_t lo, uint64_t hi, std::vector<RecordID> &out) = 0;
+
+	// See BPlusTree::freePendingPages
+	virtual void freePendingPages() = 0;
+};
+
+/**
+ * Secondary index over the field extract(obj) of model T, kept in its own NON_UNIQUE
+ * BPlusTree keyed by the field: the records sharing a value are one posting list.
+ */
+template <typename T, typename Field> class SecondaryIndex : public SecondaryIndexBase {
+  private:
+	using Key = Field;
+
+	std::string name;
+	ModelType model_type;
+	std::function<Field(const T &)> extract;
+	std::unique_ptr<BPlusTree<Key>> tree;
+
+  public:
+	// root_id = INVALID_PAGE_ID creates an empty index
+	SecondaryIndex(const std::string &index_name, uint32_t root_id, BufferPoolManager *bpm,
+				   std::function<Field(const T &)> extractor)
+		: name(index_name), model_type(T().getType()), extract(std::move(extractor)),
+		  tree(std::make_unique<BPlusTree<Key>>(root_id, bpm, IndexMode::NON_UNIQUE)) {}
+
+	const std::string &getName() const override { return name; }
+	ModelType getModelType() const override { return model_type; }
+	uint32_t getKeyType() const override { return KeyTraits<Key>::TYPE_ID; }
+	uint32_t getRootPageId() const override { return tree->getRootPageId(); }
+
+	void insert(const Storable &obj, const RecordID &record_id) override {
+		tree->insert(extract(static_cast<const T &>(obj)), record_id);
+	}
+
+	void remove(const char *record, const RecordID &record_id) override {
+		T obj = ModelFactory::deserialize<T>(record);
+		tree->remove(extract(obj), record_id);
+	}
+
+	void collect(uint64_t lo, uint64_t hi, std::vector<RecordID> &out) override {
+		// Bounds past the field's range select nothing / everything up to its maximum
+		constexpr uint64_t FIELD_MAX = std::numeric_limits<Field>::max();
+		if (lo > hi || lo > FIELD_MAX) {
+			return;
+		}
+		Key first = static_cast<Key>(lo);
+		Key last = static_cast<Key>(std::min(hi, FIELD_MAX));
+
+		for (typename BPlusTree<Key>::Iterator it = tree->scan(first, last); !it.isEnd(); ++it) {
+			tree->expandValue(it.value(), out);
+		}
+	}
+
+	void freePendingPages() override { tree->freePendingPages(); }
+};
+
+} // namespace LuminaDB
+
+#endif
@@ -1,41 +1,269 @@
 #ifndef LUMINADB_BPLUSTREE_HPP
 #define LUMINADB_BPLUSTREE_HPP
 
+#include "BPlusTreeIterator.hpp"
 #include "BPlusTreePage.hpp"
 #include "luminadb/buffer/BufferPoolManager.hpp"
 #include "luminadb/common/types.hpp"
+#include "luminadb/index/HotPageCache.hpp"
+#include "luminadb/index/PostingList.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
 
 namespace LuminaDB {
-class BPlusTree {
+
+/**
+ * UNIQUE: one value per key; insert() rejects a key that is already there (primary indexes).
+ * NON_UNIQUE: a key may have many values. The first one is kept in the leaf entry like in a
+ * unique tree; from the second one on the entry points to a posting list (see PostingList.hpp).
+ */
+enum class IndexMode { UNIQUE, NON_UNIQUE };
+
+/**
+ * B+ Tree index over fixed-width keys ordered by Compare (stateless, a strict weak order).
+ * Compiled for the key types instantiated at the end of BPlusTree.cpp: uint32_t, uint64_t,
+ * SensorKey and StringKey32 (see KeyTypes.hpp).
+ *
+ * Safe to use from many threads. Nodes are protected by the buffer pool's frame latches
+ * with latch crabbing: a child is latched before its parent is released, always top-down.
+ *  - Lookups and scans hold shared latches on at most two nodes at a time.
+ *  - Inserts/deletes first descend optimistically (shared latches, exclusive only on the
+ *    leaf). If the leaf may split or underflow, they restart pessimistically: exclusive
+ *    latches, releasing every ancestor as soon as a node is safe (can't split/underflow),
+ *    so only the subtree that is actually restructured stays locked.
+ *  - The root and the level below it stay pinned in a HotPageCache. Shared-latch descents
+ *    take them from there, so only the lower levels go through the buffer pool's latch.
+ *  - Increasing keys (time series) skip the descent: an insert that lands past the end of
+ *    the rightmost leaf remembers that leaf, and the next insert tries it first.
+ * Nodes don't point to their parent: a split or merge walks back up the path of latched
+ * pages its pessimistic descent recorded, so it only writes the pages on that path and the
+ * new sibling, never the children that moved.
+ * Posting lists are only read or written under the latch of the leaf that points to them.
+ */
+template <typename Key, typename Compare = std::less<Key>> class BPlusTree {
+  public:
+	using LeafPage = BPlusTreeLeafPage<Key, Compare>;
+	using InternalPage = BPlusTreeInternalPage<Key, Compare>;
+	using Iterator = BPlusTreeIterator<Key, Compare>;
+
   private:
 	// Attributes
-	uint32_t root_page_id;
+	std::atomic<uint32_t> root_page_id;
 	BufferPoolManager *bpm;
+	IndexMode mode;
+	std::unique_ptr<PostingStore> postings; // NON_UNIQUE only
+
+	// Rightmost leaf, while inserts keep going past its end (INVALID_PAGE_ID otherwise).
+	// Only changed with that leaf latched exclusively, so a merge that frees it can't go unnoticed
+	std::atomic<uint32_t> tail_leaf_id;
+
+	// Root and the level below it, pinned: descents take them from here without the pool latch
+	HotPageCache hot_pages;
+
+	// Guards root_page_id: shared to enter the tree, exclusive while the root may split or collapse
+	std::shared_mutex root_latch;
+
+	// Emptied nodes that were still pinned when they were freed (a reader or a write-back had
+	// them); retried on every freePage() and by freePendingPages()
+	std::mutex pending_free_latch;
+	std::vector<uint32_t> pending_free;
+
+	// UPDATE changes a leaf entry in place: never unsafe, the caller checks the leaf
+	enum class Operation { INSERT, DELETE, UPDATE };
+
+	// What removeValue() did to a leaf entry
+	enum class ValueRemoval { NOT_FOUND, REMOVED, LAST_VALUE };
 
 	// --- AUXILIARY METHODS ---
 
-	// Find the leaf page that should contain the key 'key'
-	Page *findLeafPage(uint32_t key);
+	// True if 'op' with this key on this node can't propagate to its parent (no split / no underflow)
+	bool isSafe(const Page *page, Operation op, bool is_root, const Key &key) const;
+
+	/**
+	 * Optimistic descent for a write: shared latches on the way down and an exclusive
+	 * latch on the leaf. Returns the pinned, exclusively latched leaf if 'op' can be done
+	 * there without touching its parent; otherwise releases everything and returns nullptr.
+	 */
+	Page *findLeafOptimistic(const Key &key, Operation op);
+
+	/**
+	 * Pessimistic descent for a write: exclusive latches, keeping in 'path' every node from
+	 * the highest one that may change down to the leaf (last element). root_lock stays
+	 * locked only if the root itself may change.
+	 */
+	Page *findLeafPessimistic(const Key &key, Operation op, std::vector<Page *> &path,
+							  std::unique_lock<std::shared_mutex> &root_lock);
+
+	/**
+	 * Fast path for increasing keys: inserts into the cached rightmost leaf if the key goes past
+	 * its last one and fits without a split. Returns false (nothing done) if it doesn't apply;
+	 * a key that isn't past the end turns the fast path off until an insert appends again.
+	 */
+	bool appendToTail(const Key &key, const RecordID &value);
+
+	// Adds a value to the entry at 'index' of an exclusively latched leaf (false for UNIQUE)
+	bool addValue(LeafPage &leaf, int index, const RecordID &value);
+
+	/**
+	 * Takes 'value' out of the entry at 'index' of an exclusively latched leaf. LAST_VALUE means
+	 * it is the entry's only value and nothing changed: the whole entry has to go.
+	 */
+	ValueRemoval removeValue(LeafPage &leaf, int index, const RecordID &value);
+
+	/**
+	 * remove(key) / remove(key, value): value = nullptr removes the key with every value,
+	 * and then 'removed' (if given) receives the value the entry held when it was unlinked
+	 */
+	bool removeEntry(const Key &key, const RecordID *value, RecordID *removed);
+
+	// Frees what the value of a removed entry owned (its posting list)
+	void dropValue(const RecordID &value);
+
+	// Unlatches and unpins the pages of a pessimistic descent
+	void releasePath(std::vector<Page *> &path, bool dirty);
+
+	// Descent for lookups (shared latches); pages may come straight from the file mapping
+	const Page *findLeafPageForRead(const Key &key);
+
+	// A node for a shared-latch descent: from the hot cache (hot = true, not pinned) or pinned from the pool
+	Page *fetchNode(uint32_t page_id, bool &hot);
+	const Page *fetchNodeForRead(uint32_t page_id, bool &hot);
 
-	// NOT USED - insertIntoParent() incomplete
-	// Phase 5.3.2 (internal node split) was not fully implemented.
-	// This only works when parent has space; doesn't handle recursive parent splits.
-	void insertIntoParent(uint32_t left_child_id, uint32_t key, uint32_t right_child_id);
+	// Releases what fetchNode() / fetchNodeForRead() returned (nothing to do for a hot page)
+	void unpinNode(uint32_t page_id, const Page *page, bool hot);
+
+	// Adds an internal node met at 'depth' of a descent to the hot cache, if it is an upper one
+	void keepHot(uint32_t page_id, size_t depth, bool hot);
+
+	// Insert the separator of a split of path[depth] into its parent, path[depth - 1].
+	// A full parent is split as well, recursively, up to a new root.
+	void insertIntoParent(std::vector<Page *> &path, size_t depth, const Key &key, uint32_t right_child_id);
 
 	// Create a new root when the current root splits
-	void createNewRoot(uint32_t left_child_id, uint32_t key, uint32_t right_child_id);
+	void createNewRoot(uint32_t left_child_id, const Key &key, uint32_t right_child_id);
+
+	/**
+	 * Restores the minimum fill of path[depth] after a delete: borrows one entry from a
+	 * sibling if it can spare it, otherwise merges the two and removes the separator
+	 * from the parent (recursively). An internal root left with one child is collapsed.
+	 * Pages emptied on the way are added to 'freed' (they are still latched by the caller).
+	 * A leaf whose left sibling is busy in a scan is left under-full instead of waiting,
+	 * and so is a node whose packed keys fit neither a borrow nor a merge.
+	 */
+	void rebalance(std::vector<Page *> &path, size_t depth, std::vector<uint32_t> &freed);
+
+	// Gives an emptied node back to the buffer pool's free list, or defers it while it is pinned
+	void freePage(uint32_t page_id);
+
+	// Retries the deferred frees; the caller holds pending_free_latch
+	void retryPendingFrees();
+
+	// --- BULK LOAD ---
+
+	// Nodes of one level waiting for a parent: separators[i] goes before pages[i]
+	struct BulkLoadLevel {
+		std::vector<Key> separators; // separators[0] goes one level up with the parent
+		std::vector<uint32_t> pages;
+	};
+
+	// Bottom-up build state
+	struct BulkLoadState {
+		double fill_factor;
+		uint32_t next_leaf_id; // Page reserved for the next leaf, so the previous one can link to it
+		bool has_leaf;		   // A leaf has been written, last_key is its largest key
+		Key last_key;
+		std::vector<Key> pending_keys; // Entries waiting for a leaf
+		std::vector<RecordID> pending_values;
+		std::vector<BulkLoadLevel> levels; // [0] = leaves
+	};
+
+	// Writes a leaf with the first 'count' pending entries
+	void emitLeaf(BulkLoadState &state, size_t count, bool last_leaf);
+
+	// Writes an internal node over the first 'count' waiting nodes of 'level'
+	void emitInternal(BulkLoadState &state, size_t level, size_t count);
+
+	// Adds a finished node to the level above, emitting a parent once enough nodes are waiting
+	void addToLevel(BulkLoadState &state, size_t level, const Key &separator, uint32_t page_id);
 
 	// Create a new blank page for the tree
 	// Page *createNewNode(IndexPageType type);
 
   public:
-	BPlusTree(uint32_t root_id, BufferPoolManager *bpm);
+	/**
+	 * Opens the tree whose root is root_id (as recorded in the catalog).
+	 * root_id = INVALID_PAGE_ID creates a new, empty tree.
+	 * The mode is not recorded in the pages: open a tree with the mode it was built with.
+	 */
+	BPlusTree(uint32_t root_id, BufferPoolManager *bpm, IndexMode mode = IndexMode::UNIQUE);
+
+	// Current root; changes when the root splits
+	uint32_t getRootPageId() const;
+
+	/**
+	 * Frees the emptied pages (nodes and posting list pages) that were still pinned when the
+	 * tree let go of them. Call it before the free list is persisted (commit, close).
+	 */
+	void freePendingPages();
+
+	IndexMode getMode() const;
+
+	// Main function to search for data (NON_UNIQUE: one of the key's values)
+	bool getValue(const Key &key, RecordID &result);
+
+	// Appends every value of the key to 'out' and returns how many
+	size_t getValues(const Key &key, std::vector<RecordID> &out);
+
+	/**
+	 * Main function to insert. UNIQUE: returns false if the key is already in the tree.
+	 * NON_UNIQUE: the value is added to the key's values (it is not checked for repeats).
+	 */
+	bool insert(const Key &key, const RecordID &value);
+
+	/**
+	 * Main function to delete: the key and all its values. Returns false if the key is not in the tree.
+	 * 'removed' (if given) receives the value of the entry this call unlinked, read under the
+	 * leaf latch: a lookup before the remove may have seen an older entry for the same key.
+	 * In a NON_UNIQUE tree it may refer to a posting list, which is freed by then.
+	 */
+	bool remove(const Key &key, RecordID *removed = nullptr);
+
+	// Deletes one value of the key (the key goes with its last value). Returns false if it isn't there.
+	bool remove(const Key &key, const RecordID &value);
+
+	/**
+	 * Cursor over the keys in [lo, hi], in order. One descent to the first leaf,
+	 * then the leaf chain is followed; only the current leaf stays pinned.
+	 * NON_UNIQUE: each key shows up once; pass its value() to expandValue() to get them all.
+	 */
+	Iterator scan(const Key &lo, const Key &hi);
 
-	// Main function to search for data
-	bool getValue(uint32_t key, RecordID &result);
+	/**
+	 * Appends the values a leaf entry stands for: the value itself, or those of the posting list
+	 * it points to. Call it while the entry's leaf is latched (e.g. with an Iterator on it).
+	 */
+	void expandValue(const RecordID &value, std::vector<RecordID> &out);
 
-	// Main function to insert
-	void insert(uint32_t key, const RecordID &value);
+	/**
+	 * Builds the tree bottom-up from a stream of entries sorted by strictly increasing key
+	 * (also in NON_UNIQUE mode: each key gets one value; insert() adds more).
+	 * next() fills in the next entry and returns false at the end of the stream.
+	 *
+	 * Leaves and internal nodes are filled to fill_factor (0.5 - 1.0) of what their keys
+	 * allow and written once, in order, instead of descending and splitting per key.
+	 * Every node but the root ends up at least half full (packed keys whose layout gets
+	 * wider near the end of a level may leave its last node below that). The tree must be empty and the whole load holds the root latch
+	 * exclusively (other operations wait). If the stream is not sorted a
+	 * std::runtime_error is thrown and the tree is left incomplete.
+	 * Returns the number of entries loaded.
+	 */
+	size_t bulkLoad(const std::function<bool(Key &key, RecordID &value)> &next, double fill_factor = 1.0);
 };
 
 } // namespace LuminaDB
@@ -0,0 +1,60 @@
+#ifndef LUMINADB_BPLUSTREE_ITERATOR_HPP
+#define LUMINADB_BPLUSTREE_ITERATOR_HPP
+
+#include "luminadb/buffer/BufferPoolManager.hpp"
+#include "luminadb/common/types.hpp"
+#include <functional>
+
+namespace LuminaDB {
+
+/**
+ * Forward cursor over the leaf chain, from a start key up to an upper bound (inclusive).
+ *
+ * Only the leaf being read is pinned and share-latched: when the cursor runs off its end,
+ * the next one (next_page_id) is latched and then the current one is released, so every
+ * leaf is fetched once and writers can't change the leaf being read. Keep cursors
+ * short-lived: a leaf held by a cursor blocks inserts and deletes on it.
+ * The cursor must not outlive the BufferPoolManager.
+ */
+template <typename Key, typename Compare = std::less<Key>> class BPlusTreeIterator {
+  private:
+	BufferPoolManager *bpm;
+	const Page *leaf_page; // Pinned and share-latched current leaf, nullptr at the end
+	uint32_t leaf_id;
+	uint32_t index; // Position inside the current leaf
+	Key hi;			// Last key to return
+
+	// Moves to the next leaf until there is an entry to return (or the chain ends)
+	void skipExhaustedLeaves();
+
+	// Unlatches and unpins the current leaf and marks the end
+	void release();
+
+  public:
+	// Empty cursor (already at the end)
+	BPlusTreeIterator();
+
+	// Starts at 'index' inside the pinned, share-latched leaf 'leaf_page'; takes over both
+	BPlusTreeIterator(BufferPoolManager *bpm, const Page *leaf_page, uint32_t index, const Key &hi);
+
+	~BPlusTreeIterator();
+
+	BPlusTreeIterator(const BPlusTreeIterator &) = delete;
+	BPlusTreeIterator &operator=(const BPlusTreeIterator &) = delete;
+	BPlusTreeIterator(BPlusTreeIterator &&other) noexcept;
+	BPlusTreeIterator &operator=(BPlusTreeIterator &&other) noexcept;
+
+	// True when there are no more keys in the range
+	bool isEnd() const;
+
+	// Current entry (only valid while !isEnd())
+	Key key() const;
+	RecordID value() const;
+
+	// Advances to the next key in the range
+	BPlusTreeIterator &operator++();
+};
+
+} // namespace LuminaDB
+
+#endif
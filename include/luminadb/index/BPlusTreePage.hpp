@@ -2,36 +2,72 @@
 #define LUMINADB_BPLUSTREEPAGE_HPP
 
 #include "luminadb/common/types.hpp"
+#include "luminadb/index/KeyTypes.hpp"
+#include "luminadb/storage/Page.hpp"
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
 
 namespace LuminaDB {
 
 // Forward declaration
 class BufferPoolManager;
 
-enum class IndexPageType { INTERNAL_NODE = 0, LEAF_NODE = 1 };
+// Stored at the offset of PageHeader::object_type, so a node is never taken for a page of a model
+enum class IndexPageType : uint32_t {
+	INTERNAL_NODE = static_cast<uint32_t>(ModelType::B_PLUS_TREE_INTERNAL),
+	LEAF_NODE = static_cast<uint32_t>(ModelType::B_PLUS_TREE_LEAF)
+};
 
 /**
  * Structure returned when a split occurs.
  * Contains the key that must go up to the parent and the ID of the new sibling.
  */
-struct SplitResult {
-	uint32_t middle_key;  // Key to promote to parent
+template <typename Key> struct SplitResult {
+	Key middle_key;		  // Key to promote to parent
 	uint32_t new_page_id; // ID of the new sibling page created
 };
 
 /**
  * Specific header for the pages that make up the B+ Tree.
  * It is located at the beginning of the 4096 bytes of the page.
+ * There is no parent pointer: writers find the parent in the path of their descent.
  */
 struct BPlusTreeHeader {
 	uint32_t page_id; // ID of this page
 	IndexPageType page_type;
-	uint32_t parent_page_id; // Parent page ID (0 if root)
-	uint32_t current_size;	 // How many keys do you have today
-	uint32_t max_size;		 // How many keys fit maximum
-	uint32_t next_page_id;	 // For leaves only: pointer to right sibling
+	uint32_t current_size; // How many keys do you have today
+	uint32_t max_size;	   // How many keys fit maximum (with the current key layout)
+	uint32_t next_page_id; // For leaves only: pointer to right sibling
+};
+static_assert(offsetof(BPlusTreeHeader, page_type) == offsetof(PageHeader, object_type),
+			  "page_type must overlay the object_type of the other pages");
+
+/**
+ * Key layout of a page with packed keys, right after the BPlusTreeHeader and followed
+ * by the prefix bytes. Every key of the page starts with the same prefix_length bytes
+ * (in KeyCodec form), so only the next slot_width bytes are stored per key and the
+ * rest of the encoding is zero. Slots of 4 or 8 bytes hold the bytes as a native
+ * integer, so they are still searched with SIMD.
+ */
+struct KeyPrefixHeader {
+	uint16_t prefix_length;
+	uint16_t slot_width;
 };
 
+/**
+ * Share of the entries the left half keeps when a node splits because a key went past its
+ * last one (the rightmost leaf under increasing keys). The right half gets the next inserts,
+ * so the left one is left nearly full instead of half empty for good.
+ */
+inline constexpr double RIGHTMOST_SPLIT_FRACTION = 0.9;
+
+// Keys wider than 4 bytes in their natural order are packed; 4-byte keys would gain nothing
+template <typename Key, typename Compare>
+inline constexpr bool PACKED_KEYS = (KeyCodec<Key>::WIDTH > 4) && std::is_same_v<Compare, std::less<Key>>;
+
 class BPlusTreePage {
   protected:
 	char *data;
@@ -50,60 +86,238 @@ class BPlusTreePage {
 
 	void setSize(uint32_t size);
 
-	void init(IndexPageType type, uint32_t parent = 0, uint32_t max_keys = 0);
+	// Fewest keys a non-root node may keep after a delete (half full)
+	uint32_t getMinSize() const;
+
+	void init(IndexPageType type, uint32_t max_keys = 0);
 };
 
-class BPlusTreeLeafPage : public BPlusTreePage {
+/**
+ * Key and value arrays shared by leaves (Value = RecordID) and internal nodes
+ * (Value = child page id, one more value than keys).
+ *
+ * Layout: header | [KeyPrefixHeader | prefix] | key slots[max_size] | values[max_size + EXTRA_VALUES].
+ * Plain keys (PACKED = false) use sizeof(Key) slots and no prefix, so max_size is fixed.
+ * Packed keys get the tightest layout for the keys in the page: the longer the shared prefix and
+ * the shorter the keys (e.g. truncated separators), the narrower the slots and the more entries fit.
+ * A key outside the layout makes the page re-layout itself, which may make it full.
+ */
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+class BPlusTreeKeyedPage : public BPlusTreePage {
   public:
-	using BPlusTreePage::BPlusTreePage; // Use the base constructor
+	static constexpr bool PACKED = PACKED_KEYS<Key, Compare>;
+
+  protected:
+	static constexpr size_t WIDTH = KeyCodec<Key>::WIDTH;
+
+	// Encoded key, with zeros past WIDTH so a slot may read beyond the end of the encoding
+	using Encoded = std::array<uint8_t, WIDTH + 8>;
+
+	struct KeyLayout {
+		uint32_t prefix_length;
+		uint32_t slot_width;
+	};
+
+	static constexpr uint32_t KEYS_OFFSET =
+		PACKED ? (sizeof(BPlusTreeHeader) + sizeof(KeyPrefixHeader) + WIDTH + 7) / 8 * 8 : sizeof(BPlusTreeHeader);
+
+	static Encoded encode(const Key &key);
+
+	// Bytes up to the last non-zero one
+	static uint32_t significantLength(const Encoded &encoded);
+
+	// Tightest layout for a sorted run of keys
+	static KeyLayout layoutFor(const Key *keys, size_t count);
 
-	// --- ACCESS METHODS ---
+	// Narrowest slot that holds 'bytes' bytes of every key: 4, 8 or exactly 'bytes'
+	static uint32_t slotWidthFor(uint32_t bytes);
 
-	// Returns the key at index 'index'
-	uint32_t keyAt(int index) const;
+	// Entries that fit in a page with slots of this width
+	static uint32_t capacityFor(uint32_t slot_width);
 
-	// Returns the RecordID at index 'index'
-	RecordID valueAt(int index) const;
+	const KeyPrefixHeader *prefixHeader() const;
+	uint32_t prefixLength() const;
+	uint32_t slotWidth() const;
+	const char *keySlot(int index) const;
+	char *keySlot(int index);
+	const char *valueSlot(int index) const;
+	char *valueSlot(int index);
+
+	// The encoded key at 'index' (prefix + slot)
+	Encoded encodedKeyAt(int index) const;
+
+	// First index i in [0, size] with !(key_i < key) / key < key_i
+	size_t lowerBound(const Key &key) const;
+	size_t upperBound(const Key &key) const;
+
+	// True if the key can be stored with the current layout
+	bool covers(const Key &key) const;
+
+	// Writes a covered key into slot 'index'
+	void writeKey(int index, const Key &key);
+
+	// Shift key slots / values [from, from + count) to start at 'to'
+	void moveKeys(int to, int from, int count);
+	void moveValues(int to, int from, int count);
+
+	// Copies out every key and value
+	void readEntries(std::vector<Key> &keys, std::vector<Value> &values) const;
+
+	/**
+	 * Where to split these sorted keys: left_fraction of the way in (the middle by default), or the
+	 * closest index to it that leaves both halves fitting in a page (packed keys). keys[mid] starts
+	 * the right half, or goes up to the parent when promote_middle is set. Throws if there is no such index.
+	 */
+	static size_t splitPoint(const std::vector<Key> &keys, bool promote_middle, double left_fraction = 0.5);
+
+  public:
+	using BPlusTreePage::BPlusTreePage;
+
+	// Equality as seen by Compare (neither key orders before the other)
+	static bool keysEqual(const Key &a, const Key &b) { return !Compare{}(a, b) && !Compare{}(b, a); }
+
+	// True if 'count' sorted keys fit in one page of this kind
+	static bool fits(const Key *keys, size_t count);
+
+	// Most entries a page of this kind can hold (with the narrowest layout)
+	static uint32_t maxCapacity();
+
+	/**
+	 * Largest n <= count such that the first n keys fill a page to about fill_factor
+	 * (never less than half full). Used by the bulk loader.
+	 */
+	static size_t fillCount(const Key *keys, size_t count, double fill_factor);
+
+	/**
+	 * Shortest key s with left < s <= right. Packed keys drop every byte after the first one
+	 * that differs (suffix truncation), so separators in internal nodes take fewer bytes.
+	 */
+	static Key shortestSeparator(const Key &left, const Key &right);
+
+	// Empty page with the widest capacity
+	void initKeys(IndexPageType type);
+
+	Key keyAt(int index) const;
+
+	Value valueAt(int index) const;
+	void setValueAt(int index, const Value &value);
+
+	// True if the page can take one more key (this one) without splitting
+	bool canInsert(const Key &key) const;
+
+	// True if key_{index} can be replaced by 'key' without splitting
+	bool canSetKeyAt(int index, const Key &key) const;
+
+	/**
+	 * Replaces the whole content with these sorted entries and the tightest layout for them.
+	 * Returns false (page untouched) if they don't fit.
+	 */
+	bool rebuild(const std::vector<Key> &keys, const std::vector<Value> &values);
+};
+
+/**
+ * Leaf layout: header | keys[max_size] | RecordIDs[max_size].
+ * Keys are sorted by Compare, which must be stateless.
+ * The page classes are compiled for the key types listed at the end of BPlusTreePage.cpp.
+ */
+template <typename Key, typename Compare = std::less<Key>>
+class BPlusTreeLeafPage : public BPlusTreeKeyedPage<Key, Compare, RecordID, 0> {
+  public:
+	using BPlusTreeKeyedPage<Key, Compare, RecordID, 0>::BPlusTreeKeyedPage;
+
+	// Empty leaf
+	void init();
 
 	// --- SEARCH METHODS ---
 
-	// Find the first index where KeyAt(index) >= key (Binary Search)
-	int lookup(uint32_t key) const;
+	// Find the first index where KeyAt(index) >= key (SIMD search, see KeySearch.hpp)
+	int lookup(const Key &key) const;
 
 	// --- DATA WRITE ---
-	bool insert(uint32_t key, const RecordID &value);
+
+	// Returns false if the key is already here or the page is full
+	bool insert(const Key &key, const RecordID &value);
+
+	// Removes the key; returns false if it isn't here
+	bool remove(const Key &key);
+
+	// Removes the entry at 'index', shifting the rest to the left
+	void removeAt(int index);
+
+	// Appends every entry of the right sibling (merge). Returns false (nothing moved) if they don't fit
+	bool absorb(const BPlusTreeLeafPage &right);
 
 	// --- SPLIT OPERATION ---
 	/**
 	 * Splits a full leaf page when inserting a new key/value.
-	 * Creates a new sibling page and distributes the entries.
-	 * Returns the key to promote to parent and the new page ID.
+	 * Creates a new sibling page and distributes the entries: half and half, or
+	 * RIGHTMOST_SPLIT_FRACTION / the rest when the key goes past the end of the last leaf.
+	 * Returns the separator to promote to parent and the new page ID.
 	 */
-	SplitResult split(uint32_t key, const RecordID &value, BufferPoolManager *bpm);
+	SplitResult<Key> split(const Key &key, const RecordID &value, BufferPoolManager *bpm);
 
 	// --- UTILITY ---
 	uint32_t getNextPageId() const;
 	void setNextPageId(uint32_t next_id);
 };
 
-class BPlusTreeInternalPage : public BPlusTreePage {
+/**
+ * Internal layout: header | keys[max_size] | children[max_size + 1] (page ids).
+ * child_i holds the keys k with key_{i-1} <= k < key_i.
+ */
+template <typename Key, typename Compare = std::less<Key>>
+class BPlusTreeInternalPage : public BPlusTreeKeyedPage<Key, Compare, uint32_t, 1> {
   public:
-	using BPlusTreePage::BPlusTreePage;
+	using BPlusTreeKeyedPage<Key, Compare, uint32_t, 1>::BPlusTreeKeyedPage;
 
-	// Methods to manage keys and PageIDs (children)
-	uint32_t keyAt(int index) const;
-	void setKeyAt(int index, uint32_t key);
+	// Empty internal node
+	void init();
 
-	uint32_t valueAt(int index) const; // "value" is a PageID
-	void setValueAt(int index, uint32_t value);
+	// Replaces key_{index}; returns false (page untouched) if it doesn't fit
+	bool setKeyAt(int index, const Key &key);
 
 	// Search which thread to go down based on the key
-	uint32_t lookup(uint32_t key) const;
+	uint32_t lookup(const Key &key) const;
+
+	/**
+	 * True if a split of the child that 'key' leads to is certain to fit here. Conservative
+	 * for packed keys: the separator is not known yet, so it is assumed to need a full slot.
+	 */
+	bool canTakeSplitOf(const Key &key) const;
+
+	// Insert a key and its right child into this internal node; returns false if it is full
+	bool insertAfter(const Key &key, uint32_t right_child);
+
+	// Position of child_id in the children array, or -1 if it isn't a child of this node
+	int childIndex(uint32_t child_id) const;
 
-	// Insert a key and its right child into this internal node (assumes space available)
-	bool insertAfter(uint32_t key, uint32_t right_child);
+	// Removes key_{index} and the child to its right (child_{index+1})
+	void removeAt(int index);
+
+	// Removes child_0 and key_0 (the leftmost pair)
+	void removeFirst();
+
+	// Adds a leftmost pair: 'child' becomes child_0 and 'key' separates it from the old child_0
+	bool pushFront(uint32_t child, const Key &key);
+
+	// Adds a rightmost pair: 'key' separates the old last child from 'child'
+	bool pushBack(const Key &key, uint32_t child);
+
+	// Appends 'separator' and every key and child of the right sibling (merge). False if they don't fit
+	bool absorb(const Key &separator, const BPlusTreeInternalPage &right);
+
+	// --- SPLIT OPERATION ---
+	/**
+	 * Splits a full internal page when inserting key/right_child.
+	 * The middle key moves up (it is kept in neither half); the sibling gets the
+	 * keys and children to its right. A key past the last one (its rightmost child split)
+	 * moves the split point to RIGHTMOST_SPLIT_FRACTION, as for leaves.
+	 * The moved children are not touched: nodes don't point to their parent.
+	 * Returns the key to promote to parent and the new page ID.
+	 */
+	SplitResult<Key> split(const Key &key, uint32_t right_child, BufferPoolManager *bpm);
 };
 
 } // namespace LuminaDB
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,82 @@
+#ifndef LUMINADB_HOT_PAGE_CACHE_HPP
+#define LUMINADB_HOT_PAGE_CACHE_HPP
+
+#include "luminadb/buffer/BufferPoolManager.hpp"
+#include "luminadb/common/types.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace LuminaDB {
+
+// Levels of a tree kept in its HotPageCache: the root and the internal nodes right below it
+inline constexpr size_t HOT_LEVELS = 2;
+
+// Most pages one tree keeps pinned, and the share of the buffer pool it may take (1 / divisor)
+inline constexpr size_t HOT_PAGE_LIMIT = 64;
+inline constexpr size_t HOT_POOL_DIVISOR = 8;
+
+/**
+ * Upper internal nodes of one BPlusTree, pinned in the buffer pool for as long as the tree
+ * lives. Descents resolve these page ids here instead of going through fetchPage() and
+ * unpinPage(), so every lookup only takes the pool latch for the levels below.
+ *
+ * lookup() takes no lock: the table is read under a version number that admit()/evict()
+ * make odd while they change it. A lookup that sees the version move is a miss, and the
+ * caller falls back to the buffer pool. A cached page keeps its frame because the cache
+ * holds a pin on it.
+ *
+ * Pages are admitted by a thread that holds them latched and evicted when the tree frees
+ * them (nobody can reach them any more), so a page found here stays cached until the
+ * thread that found it lets go of it.
+ */
+class HotPageCache {
+  private:
+	struct Slot {
+		std::atomic<uint32_t> page_id{INVALID_PAGE_ID};
+		std::atomic<Page *> page{nullptr};
+	};
+
+	BufferPoolManager *bpm;
+	size_t capacity;				// 0 turns the cache off
+	std::unique_ptr<Slot[]> slots;	// Open addressing, at least twice the capacity
+	size_t mask;					// Slot count - 1 (a power of two)
+	std::atomic<size_t> count;		// Pages cached (written under latch)
+	std::atomic<uint64_t> version;	// Odd while the table is being changed
+	std::mutex latch;				// Serializes admit() / evict()
+
+	size_t home(uint32_t page_id) const;
+
+	// Helpers: Make the version odd / even again around a change (caller holds the latch)
+	void beginWrite();
+	void endWrite();
+
+	// Puts a page in its slot (caller holds the latch, inside a write)
+	void place(uint32_t page_id, Page *page);
+
+  public:
+	HotPageCache(BufferPoolManager *bpm, size_t capacity);
+	~HotPageCache();
+
+	HotPageCache(const HotPageCache &) = delete;
+	HotPageCache &operator=(const HotPageCache &) = delete;
+
+	// The cached frame of page_id, or nullptr (not cached, or the table changed meanwhile)
+	Page *lookup(uint32_t page_id) const;
+
+	// True once no more pages will be admitted
+	bool isFull() const { return count.load(std::memory_order_relaxed) >= capacity; }
+
+	/**
+	 * Pins page_id and keeps it. The caller must hold the page latched (it is reachable).
+	 * Does nothing if it is already cached, the cache is full or the pool has no frame.
+	 */
+	void admit(uint32_t page_id);
+
+	// Drops page_id and its pin, if cached. Call it before freeing the page
+	void evict(uint32_t page_id);
+};
+
+} // namespace LuminaDB
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef LUMINADB_KEY_SEARCH_HPP
+#define LUMINADB_KEY_SEARCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+namespace LuminaDB {
+
+/**
+ * Search over the sorted key arrays of B+ Tree pages.
+ *
+ * For uint32_t and uint64_t keys in natural order, a few branchless halving steps narrow
+ * the array down to a small window, whose keys are then compared all at once with SIMD
+ * (AVX2 or SSE2 on x86-64, plain C++ elsewhere). The implementation is picked once
+ * at runtime from the CPU features. Other key types use a branchless binary search.
+ */
+
+// First index i in [0, count] with keys[i] >= key
+size_t keyLowerBound(const uint32_t *keys, size_t count, uint32_t key);
+size_t keyLowerBound(const uint64_t *keys, size_t count, uint64_t key);
+
+// First index i in [0, count] with keys[i] > key
+size_t keyUpperBound(const uint32_t *keys, size_t count, uint32_t key);
+size_t keyUpperBound(const uint64_t *keys, size_t count, uint64_t key);
+
+// Name of the implementation in use: "avx2", "sse2" or "scalar"
+const char *keySearchImplementation();
+
+/**
+ * Switches to another implementation by name. Returns false (and changes nothing) if this
+ * build or CPU can't run it; "scalar" is always available. For tests and benchmarks that
+ * compare the paths: don't call it while other threads are searching.
+ */
+bool setKeySearchImplementation(const char *name);
+
+// Integer keys in their natural order can take the SIMD path
+template <typename Key, typename Compare>
+inline constexpr bool SIMD_KEY_SEARCH =
+	(std::is_same_v<Key, uint32_t> || std::is_same_v<Key, uint64_t>) && std::is_same_v<Compare, std::less<Key>>;
+
+// First index i in [0, count] with !comp(keys[i], key)
+template <typename Key, typename Compare>
+size_t keyLowerBound(const Key *keys, size_t count, const Key &key, const Compare &comp) {
+	if constexpr (SIMD_KEY_SEARCH<Key, Compare>) {
+		return keyLowerBound(keys, count, key);
+	} else {
+		size_t base = 0;
+		while (count > 1) {
+			size_t half = count / 2;
+			base = comp(keys[base + half - 1], key) ? base + half : base;
+			count -= half;
+		}
+		return base + (count == 1 && comp(keys[base], key) ? 1 : 0);
+	}
+}
+
+// First index i in [0, count] with comp(key, keys[i])
+template <typename Key, typename Compare>
+size_t keyUpperBound(const Key *keys, size_t count, const Key &key, const Compare &comp) {
+	if constexpr (SIMD_KEY_SEARCH<Key, Compare>) {
+		return keyUpperBound(keys, count, key);
+	} else {
+		size_t base = 0;
+		while (count > 1) {
+			size_t half = count / 2;
+			base = comp(key, keys[base + half - 1]) ? base : base + half;
+			count -= half;
+		}
+		return base + (count == 1 && !comp(key, keys[base]) ? 1 : 0);
+	}
+}
+
+} // namespace LuminaDB
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef LUMINADB_KEY_TYPES_HPP
+#define LUMINADB_KEY_TYPES_HPP
+
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace LuminaDB {
+
+/**
+ * Key types of the B+ Tree. Keys are stored inline in fixed-width slots of the node
+ * (memcpy-able, see BPlusTreePage.hpp), so every key type must be trivially copyable
+ * and have a fixed size. Besides uint32_t and uint64_t:
+ *  - CompositeKey<A, B>: two fields compared lexicographically, e.g. (sensor_id, timestamp).
+ *  - StringKey<N>: a string of up to N - 1 bytes (no NUL bytes), compared like std::string (bytewise).
+ */
+
+/**
+ * Two-field key ordered by (first, second). Padding is zeroed so equal keys are
+ * byte-identical on disk.
+ */
+template <typename A, typename B> struct CompositeKey {
+	A first;
+	B second;
+
+	CompositeKey() {
+		std::memset(static_cast<void *>(this), 0, sizeof(*this));
+	}
+
+	CompositeKey(A first_value, B second_value) : CompositeKey() {
+		first = first_value;
+		second = second_value;
+	}
+
+	friend auto operator<=>(const CompositeKey &lhs, const CompositeKey &rhs) {
+		if (auto order = lhs.first <=> rhs.first; order != 0) {
+			return order;
+		}
+		return lhs.second <=> rhs.second;
+	}
+
+	friend bool operator==(const CompositeKey &lhs, const CompositeKey &rhs) {
+		return lhs.first == rhs.first && lhs.second == rhs.second;
+	}
+
+	friend std::ostream &operator<<(std::ostream &out, const CompositeKey &key) {
+		return out << "(" << key.first << ", " << key.second << ")";
+	}
+};
+
+/**
+ * Variable-length string key of up to N - 1 bytes. Stored padded to N bytes
+ * (length byte + data) so it fits the fixed-width slots of the nodes.
+ * NUL bytes are not allowed: the zero padding ends the string in its encoded form (KeyCodec).
+ */
+template <size_t N> struct StringKey {
+	static_assert(N >= 4 && N <= 256 && N % 4 == 0, "StringKey<N>: N must be a multiple of 4 in [4, 256]");
+	static constexpr size_t MAX_LENGTH = N - 1;
+
+	uint8_t length;
+	char bytes[N - 1];
+
+	StringKey() : length(0) { std::memset(bytes, 0, sizeof(bytes)); }
+
+	// Throws std::invalid_argument if the string is longer than MAX_LENGTH or contains a NUL byte
+	StringKey(std::string_view text) : StringKey() {
+		if (text.size() > MAX_LENGTH) {
+			throw std::invalid_argument("String key longer than " + std::to_string(MAX_LENGTH) + " bytes");
+		}
+		if (text.find('\0') != std::string_view::npos) {
+			throw std::invalid_argument("String key contains a NUL byte");
+		}
+		length = static_cast<uint8_t>(text.size());
+		std::memcpy(bytes, text.data(), text.size());
+	}
+
+	StringKey(const char *text) : StringKey(std::string_view(text)) {}
+	StringKey(const std::string &text) : StringKey(std::string_view(text)) {}
+
+	std::string_view view() const { return std::string_view(bytes, length); }
+	std::string str() const { return std::string(bytes, length); }
+
+	friend std::strong_ordering operator<=>(const StringKey &lhs, const StringKey &rhs) {
+		// Bytes as unsigned, like std::string::compare
+		int order = std::memcmp(lhs.bytes, rhs.bytes, std::min(lhs.length, rhs.length));
+		if (order != 0) {
+			return order < 0 ? std::strong_ordering::less : std::strong_ordering::greater;
+		}
+		return lhs.length <=> rhs.length;
+	}
+
+	friend bool operator==(const StringKey &lhs, const StringKey &rhs) {
+		return lhs.length == rhs.length && std::memcmp(lhs.bytes, rhs.bytes, lhs.length) == 0;
+	}
+
+	friend std::ostream &operator<<(std::ostream &out, const StringKey &key) { return out << '"' << key.view() << '"'; }
+};
+
+// Key for sensor readings: (sensor_id, timestamp)
+using SensorKey = CompositeKey<uint32_t, uint64_t>;
+
+// Default string key: up to 31 bytes
+using StringKey32 = StringKey<32>;
+
+/**
+ * Order-preserving binary form of a key: WIDTH bytes such that memcmp() of two encodings
+ * orders them like std::less on the keys. The B+ Tree pages use it to store only the bytes
+ * that differ between the keys of a page (prefix compression) and to promote the shortest
+ * separator that still splits two leaves (suffix truncation).
+ * Integers are big-endian, composite keys concatenate their fields and strings are zero-padded.
+ * WIDTH = 0 means the key type has no encoding and is always stored as is.
+ */
+template <typename Key> struct KeyCodec {
+	static constexpr size_t WIDTH = 0;
+};
+
+template <> struct KeyCodec<uint32_t> {
+	static constexpr size_t WIDTH = 4;
+
+	static void encode(const uint32_t &key, uint8_t *out) {
+		for (size_t i = 0; i < WIDTH; i++) {
+			out[i] = static_cast<uint8_t>(key >> (8 * (WIDTH - 1 - i)));
+		}
+	}
+
+	static uint32_t decode(const uint8_t *in) {
+		uint32_t key = 0;
+		for (size_t i = 0; i < WIDTH; i++) {
+			key = (key << 8) | in[i];
+		}
+		return key;
+	}
+};
+
+template <> struct KeyCodec<uint64_t> {
+	static constexpr size_t WIDTH = 8;
+
+	static void encode(const uint64_t &key, uint8_t *out) {
+		for (size_t i = 0; i < WIDTH; i++) {
+			out[i] = static_cast<uint8_t>(key >> (8 * (WIDTH - 1 - i)));
+		}
+	}
+
+	static uint64_t decode(const uint8_t *in) {
+		uint64_t key = 0;
+		for (size_t i = 0; i < WIDTH; i++) {
+			key = (key << 8) | in[i];
+		}
+		return key;
+	}
+};
+
+template <typename A, typename B> struct KeyCodec<CompositeKey<A, B>> {
+	static_assert(KeyCodec<A>::WIDTH > 0 && KeyCodec<B>::WIDTH > 0, "CompositeKey fields need a KeyCodec");
+	static constexpr size_t WIDTH = KeyCodec<A>::WIDTH + KeyCodec<B>::WIDTH;
+
+	static void encode(const CompositeKey<A, B> &key, uint8_t *out) {
+		KeyCodec<A>::encode(key.first, out);
+		KeyCodec<B>::encode(key.second, out + KeyCodec<A>::WIDTH);
+	}
+
+	static CompositeKey<A, B> decode(const uint8_t *in) {
+		return CompositeKey<A, B>(KeyCodec<A>::decode(in), KeyCodec<B>::decode(in + KeyCodec<A>::WIDTH));
+	}
+};
+
+template <size_t N> struct KeyCodec<StringKey<N>> {
+	static constexpr size_t WIDTH = N - 1;
+
+	// The bytes after the string are already zero
+	static void encode(const StringKey<N> &key, uint8_t *out) { std::memcpy(out, key.bytes, WIDTH); }
+
+	static StringKey<N> decode(const uint8_t *in) {
+		const void *end = std::memchr(in, 0, WIDTH);
+		size_t length = end != nullptr ? static_cast<size_t>(static_cast<const uint8_t *>(end) - in) : WIDTH;
+		return StringKey<N>(std::string_view(reinterpret_cast<const char *>(in), length));
+	}
+};
+
+/**
+ * Identifies the key type of an index in the catalog, so a file is never opened
+ * with a different key type than the one it was built with.
+ */
+template <typename Key> struct KeyTraits;
+
+template <> struct KeyTraits<uint32_t> {
+	static constexpr uint32_t TYPE_ID = 1;
+};
+
+template <> struct KeyTraits<uint64_t> {
+	static constexpr uint32_t TYPE_ID = 2;
+};
+
+template <> struct KeyTraits<SensorKey> {
+	static constexpr uint32_t TYPE_ID = 3;
+};
+
+template <size_t N> struct KeyTraits<StringKey<N>> {
+	static constexpr uint32_t TYPE_ID = 0x100 + static_cast<uint32_t>(N);
+};
+
+// Text form of a key, for error messages and logs
+template <typename Key> std::string keyToString(const Key &key) {
+	std::ostringstream out;
+	out << key;
+	return out.str();
+}
+
+} // namespace LuminaDB
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef LUMINADB_POSTING_LIST_HPP
+#define LUMINADB_POSTING_LIST_HPP
+
+#include "luminadb/buffer/BufferPoolManager.hpp"
+#include "luminadb/common/types.hpp"
+#include <mutex>
+#include <vector>
+
+namespace LuminaDB {
+
+/**
+ * A leaf value with this bit set in slot_num doesn't point to a record: it points to the
+ * posting list (page_id, slot_num without the bit) holding every value of a duplicate key.
+ * Real slots never reach it (a 4 KB page has far fewer than 32768 slots).
+ */
+inline constexpr uint16_t POSTING_LIST_FLAG = 0x8000;
+
+inline bool isPostingList(const RecordID &value) { return (value.slot_num & POSTING_LIST_FLAG) != 0; }
+
+/**
+ * Head of a posting list record, followed by 'count' packed RecordIDs (6 bytes each).
+ * Records live in slotted POSTING_LIST pages shared by many lists.
+ */
+struct PostingHeader {
+	uint16_t count;			   // RecordIDs stored in the record itself
+	uint16_t reserved;
+	uint32_t overflow_page_id; // First overflow page, INVALID_PAGE_ID if none
+};
+
+/**
+ * Overflow page of a posting list (POSTING_OVERFLOW), right after the PageHeader and
+ * followed by 'count' packed RecordIDs. Only the first page of the chain has room left.
+ */
+struct PostingOverflowHeader {
+	uint32_t next_page_id;
+	uint16_t count;
+	uint16_t reserved;
+};
+
+/**
+ * Storage for the posting lists of one non-unique BPlusTree.
+ *
+ * A key with a single value keeps it in its leaf entry. From the second value on, the
+ * entry points to a posting list: a record with up to RECORD_CAPACITY RecordIDs, packed
+ * together with the small lists of other keys in POSTING_LIST pages, plus a chain of
+ * dedicated overflow pages for keys with more values than that. Values are unordered.
+ *
+ * A list is only touched by a thread holding the exclusive latch of the leaf that points
+ * to it (shared to read it). The pages themselves are latched while they are read or
+ * written, and every change goes through 'latch', which also guards the page that
+ * receives new records.
+ */
+class PostingStore {
+  private:
+	BufferPoolManager *bpm;
+
+	std::mutex latch;
+	uint32_t current_page_id; // POSTING_LIST page new records go to first (guarded by latch)
+
+	// Emptied pages that were still pinned when freed, retried on the next freePage() (guarded by latch)
+	std::vector<uint32_t> pending_free;
+
+	static constexpr size_t ENTRY_SIZE = sizeof(uint32_t) + sizeof(uint16_t);
+
+	// Helpers: Packed RecordID at 'at'
+	static RecordID readEntry(const char *at);
+	static void writeEntry(char *at, const RecordID &value);
+
+	// Helper: A record's bytes (header, then the packed entries)
+	static std::vector<char> serializeRecord(const PostingHeader &header, const std::vector<RecordID> &entries);
+
+	// The helpers below are called with 'latch' held
+
+	// Stores a new record and returns its reference (flag set)
+	RecordID storeRecord(const PostingHeader &header, const std::vector<RecordID> &entries);
+
+	// Deletes the record at 'list'; a page left empty is freed
+	void deleteRecord(const RecordID &list);
+
+	// Copies the record out
+	PostingHeader readRecord(const RecordID &list, std::vector<RecordID> &entries);
+
+	// Rewrites a record in place (same number of entries)
+	void overwriteRecord(const RecordID &list, const PostingHeader &header, const std::vector<RecordID> &entries);
+
+	// Rewrites a record whose size changed: in its page if it fits, elsewhere if not. Returns its new reference
+	RecordID replaceRecord(const RecordID &list, const PostingHeader &header, const std::vector<RecordID> &entries);
+
+	// Takes the last value of the first overflow page, freeing the page (and updating header) when it empties
+	RecordID popOverflow(PostingHeader &header);
+
+	// Frees a page of this store, or defers it while it is still pinned
+	void freePage(uint32_t page_id);
+
+	// Retries the deferred frees
+	void retryPendingFrees();
+
+  public:
+	// Entries in the record itself; the rest go to overflow pages
+	static constexpr uint16_t RECORD_CAPACITY = 64;
+
+	// Entries in one overflow page
+	static constexpr uint16_t OVERFLOW_CAPACITY =
+		static_cast<uint16_t>((PAGE_SIZE - sizeof(PageHeader) - sizeof(PostingOverflowHeader)) / ENTRY_SIZE);
+
+	explicit PostingStore(BufferPoolManager *bpm);
+
+	// New list holding these two values; returns the reference to put in the leaf
+	RecordID create(const RecordID &first, const RecordID &second);
+
+	// Adds a value; returns the list's reference, which changes when its record moves
+	RecordID append(const RecordID &list, const RecordID &value);
+
+	/**
+	 * Removes one occurrence of value. Returns false if the list doesn't hold it.
+	 * Otherwise 'list' is updated to what the leaf must hold now: the list's new reference,
+	 * or, once a single value is left, that value itself (the list is gone).
+	 */
+	bool remove(RecordID &list, const RecordID &value);
+
+	// Appends every value of the list to 'out'
+	void read(const RecordID &list, std::vector<RecordID> &out);
+
+	// Frees the record and the overflow pages of a list
+	void destroy(const RecordID &list);
+
+	// Frees the pages whose free was deferred because they were pinned (see BPlusTree::freePendingPages)
+	void freePendingPages();
+};
+
+} // namespace LuminaDB
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef LUMINADB_STORABLE_HPP
 #define LUMINADB_STORABLE_HPP
 
+#include <cstddef>
 #include <cstdint>
 
 namespace LuminaDB {
@@ -11,6 +12,14 @@ enum class ModelType : uint32_t {
 	USER = 2,
 	COURSE = 3,
 	B_PLUS_TREE = 4,
+	FREE_SPACE_MAP = 5,
+	SUPERBLOCK = 6,
+	FREE_PAGE = 7,
+	POSTING_LIST = 8,
+	POSTING_OVERFLOW = 9,
+	// Kept by B+Tree nodes in BPlusTreeHeader::page_type, where other pages keep their type
+	B_PLUS_TREE_INTERNAL = 10,
+	B_PLUS_TREE_LEAF = 11,
 };
 
 class Storable {
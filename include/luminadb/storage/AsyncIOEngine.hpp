@@ -0,0 +1,112 @@
+#ifndef LUMINADB_ASYNC_IO_ENGINE_HPP
+#define LUMINADB_ASYNC_IO_ENGINE_HPP
+
+#include "DiskManager.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace LuminaDB {
+
+enum class IOOp { READ = 0, WRITE = 1 };
+
+/**
+ * One page-sized transfer. For READ the buffer receives the page,
+ * for WRITE the page is taken from it. The buffer must stay valid
+ * until the batch that contains the request has been waited on.
+ */
+struct IORequest {
+	IOOp op;
+	uint32_t page_id;
+	char *buffer;
+};
+
+/**
+ * Asynchronous page I/O next to DiskManager.
+ *
+ * Callers submit a batch of reads/writes, get a ticket back and wait on it
+ * later, so several transfers can be in flight at once. On Linux the batch is
+ * handed to io_uring in a single io_uring_enter(); when io_uring is not
+ * compiled in or the kernel refuses it, a small thread pool runs the requests
+ * through DiskManager's positional I/O instead.
+ */
+class AsyncIOEngine {
+  private:
+	struct BatchState {
+		uint32_t remaining; // Requests of the batch still in flight
+		std::string error;	// First failure seen, empty if none
+	};
+
+	struct PendingRequest {
+		uint64_t ticket;
+		IORequest request;
+	};
+
+	DiskManager *disk_manager;
+	uint32_t queue_depth;
+
+	std::mutex latch;
+	std::condition_variable completion_cv;
+	std::unordered_map<uint64_t, BatchState> batches; // ticket -> progress
+	uint64_t next_ticket;
+
+	// --- io_uring backend (raw syscalls, no liburing needed) ---
+	struct UringState;	// Ring mappings, defined in the .cpp to keep Linux headers out of here
+	UringState *uring; // nullptr when the thread-pool fallback is in use
+	uint32_t in_flight; // SQEs submitted but not reaped yet
+	bool reaping;		// A thread is blocked in io_uring_enter waiting for CQEs (without the latch)
+	std::vector<PendingRequest> uring_slots; // In-flight requests, indexed by SQE user_data
+	std::vector<uint32_t> uring_free_slots;	 // Unused indices of uring_slots
+
+	// --- Thread-pool fallback ---
+	std::vector<std::thread> workers;
+	std::deque<PendingRequest> work_queue;
+	std::condition_variable work_cv;
+	bool shutting_down;
+
+	bool setupUring();
+	void teardownUring();
+	void submitUring(uint64_t ticket, const std::vector<IORequest> &batch, std::unique_lock<std::mutex> &lock);
+	void collectCompletions(std::vector<PendingRequest> &redo);
+	void reapUring(std::unique_lock<std::mutex> &lock);
+	void waitUring(uint64_t ticket, std::unique_lock<std::mutex> &lock);
+
+	void workerLoop();
+	void runSync(const IORequest &request, std::string &error);
+	void redoSync(std::vector<PendingRequest> &redo, std::unique_lock<std::mutex> &lock);
+	void complete(uint64_t ticket, const std::string &error);
+
+  public:
+	AsyncIOEngine(DiskManager *disk_manager, uint32_t queue_depth = 64, uint32_t worker_threads = 4);
+	~AsyncIOEngine();
+
+	AsyncIOEngine(const AsyncIOEngine &) = delete;
+	AsyncIOEngine &operator=(const AsyncIOEngine &) = delete;
+
+	/**
+	 * Queues every request of the batch and returns immediately.
+	 * The returned ticket must be passed to wait() exactly once.
+	 */
+	uint64_t submit(const std::vector<IORequest> &batch);
+
+	/**
+	 * Blocks until every request of the batch has completed.
+	 * Throws std::runtime_error if any of them failed.
+	 */
+	void wait(uint64_t ticket);
+
+	// Convenience: submit + wait.
+	void execute(const std::vector<IORequest> &batch);
+
+	// True when requests go through io_uring, false for the thread-pool fallback.
+	bool usingIoUring() const;
+};
+
+} // namespace LuminaDB
+
+#endif
@@ -1,22 +1,124 @@
 #ifndef LUMINADB_DISKMANAGER_HPP
 #define LUMINADB_DISKMANAGER_HPP
 
-#include <fstream>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <thread>
 
 namespace LuminaDB {
+
+/**
+ * When page writes become durable.
+ *  - NONE:         only on an explicit sync (awaitDurability() or closing the database).
+ *  - PERIODIC:     a background thread fdatasyncs at most max_delay after the first unsynced write.
+ *  - GROUP_COMMIT: like PERIODIC, but also syncs as soon as max_batch writes are pending, and
+ *                  awaitDurability() blocks until the shared fdatasync covering its writes is done.
+ */
+enum class DurabilityMode { NONE = 0, PERIODIC = 1, GROUP_COMMIT = 2 };
+
+struct DurabilityOptions {
+	DurabilityMode mode = DurabilityMode::NONE;
+	std::chrono::milliseconds max_delay{10}; // Upper bound of the durability window
+	uint32_t max_batch = 128;				 // GROUP_COMMIT: pending writes that trigger a sync
+};
+
+/**
+ * Page-granular access to the database file.
+ *
+ * Every read and write is positional (pread/pwrite), so there is no shared
+ * stream cursor and the methods can be called from many threads at once.
+ * Writes only reach the OS page cache; they become durable according to the
+ * DurabilityOptions, or when sync() is called.
+ */
 class DiskManager {
   private:
-	std::fstream db_io;
+#ifdef _WIN32
+	void *file_handle; // HANDLE returned by CreateFileA
+#else
+	int fd; // Descriptor opened with O_RDWR | O_CREAT
+#endif
 	std::string file_name;
 
+	// Read-only shared mapping of the file (see mapFile()), nullptr when not mapped
+	char *mapped_data;
+	size_t mapped_size;
+
+	// --- Durability bookkeeping ---
+	DurabilityOptions durability;
+	std::mutex sync_latch;
+	std::condition_variable sync_cv;	// Wakes the syncer thread
+	std::condition_variable durable_cv; // Wakes threads waiting in awaitDurability()
+	uint64_t written_seq;				// Page writes completed so far
+	uint64_t synced_seq;				// Page writes covered by the last successful sync
+	std::chrono::steady_clock::time_point first_unsynced; // When written_seq last moved past synced_seq
+	std::string sync_error; // First failed sync; once set no sync is trusted again (see sync())
+	uint64_t failed_seq;	// Page writes issued before that failed sync
+	bool stop_syncer;
+	std::thread syncer;
+
+	void startSyncer();
+	void stopSyncer();
+	void syncerLoop();
+	void syncFile(); // Raw fdatasync/FlushFileBuffers, no bookkeeping
+
+	// Error for a caller whose writes up to target can't be made durable (sync_latch held)
+	std::string durabilityError(uint64_t target) const;
+
   public:
-	DiskManager(const std::string &db_file);
+	explicit DiskManager(const std::string &db_file, const DurabilityOptions &durability = {});
+	DiskManager(const DiskManager &) = delete;
+	DiskManager &operator=(const DiskManager &) = delete;
+
 	void writePage(uint32_t page_id, const char *page_data);
 	void readPage(uint32_t page_id, char *buffer);
+
+	/**
+	 * Blocks until every write issued so far is on stable storage (fdatasync).
+	 * A failed sync is final: the kernel may have dropped the pages it could not write back,
+	 * so a later successful fdatasync would not prove them durable. From then on sync() and
+	 * awaitDurability() throw and the background syncer stops.
+	 */
+	void sync();
+
+	/**
+	 * Returns once the writes issued so far are as durable as the policy promises:
+	 * NONE syncs right away, PERIODIC returns immediately (the window is bounded by
+	 * max_delay) and GROUP_COMMIT waits for the next shared fdatasync.
+	 */
+	void awaitDurability();
+
+	// Accounts for page writes done outside writePage() (e.g. by AsyncIOEngine).
+	void recordWrites(uint32_t count);
+
+	const DurabilityOptions &getDurability() const;
+
+	/**
+	 * Maps the current contents of the file read-only (MAP_SHARED), so clean pages can
+	 * be read in place instead of being copied into a frame. Pages written afterwards
+	 * through writePage() are visible through the mapping (shared page cache), but the
+	 * mapping does not grow: pages appended later are only reachable through readPage().
+	 * Returns false if the file is empty or mapping is not supported on this platform.
+	 */
+	bool mapFile();
+
+	// Start of the page inside the mapping, or nullptr if it lies outside the mapped range.
+	const char *getMappedPage(uint32_t page_id) const;
+
+	// True if ptr points into the mapping.
+	bool isMapped(const void *ptr) const;
+
 	uint32_t getExistingPageCount();
+
+#ifndef _WIN32
+	// Raw descriptor, for engines that submit I/O themselves (AsyncIOEngine).
+	int getFileDescriptor() const;
+#endif
+
 	~DiskManager();
 };
 } // namespace LuminaDB
 
-#endif
\ No newline at end of file
+#endif
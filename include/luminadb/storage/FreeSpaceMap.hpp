@@ -0,0 +1,87 @@
+#ifndef LUMINADB_FREE_SPACE_MAP_HPP
+#define LUMINADB_FREE_SPACE_MAP_HPP
+
+#include "luminadb/common/types.hpp"
+#include "luminadb/model/Storable.hpp"
+#include "luminadb/storage/Page.hpp"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace LuminaDB {
+
+/**
+ * One tracked data page. Serialized as-is after the FreeSpacePageHeader of an FSM page.
+ */
+struct FreeSpaceEntry {
+	uint32_t page_id;
+	uint16_t object_type; // ModelType of the records stored in the page
+	uint16_t free_space;  // Bytes left between the slot directory and the data
+};
+
+/**
+ * Follows the PageHeader of every FREE_SPACE_MAP page; slot_count holds the entries in the page.
+ */
+struct FreeSpacePageHeader {
+	uint32_t next_page_id; // Next page of the chain, INVALID_PAGE_ID in the last one
+};
+
+/**
+ * Free-space map: which data pages of each type still have room for records.
+ *
+ * Database::storeObject() asks it for a page before allocating a new one, so
+ * records of the same type share slotted pages instead of taking one page each.
+ * It is only a hint: callers re-check the page and report the real free space
+ * back with update(). Every page with at least MIN_TRACKED_SPACE free bytes is kept,
+ * however many there are; on disk the map spans a chain of FREE_SPACE_MAP pages.
+ */
+class FreeSpaceMap {
+  private:
+	std::mutex latch;
+	std::vector<FreeSpaceEntry> entries;
+	std::unordered_map<uint32_t, size_t> positions; // page_id -> index in entries
+
+	// Helper: Drops entries[index] (latch held); the last entry takes its place
+	void eraseAt(size_t index);
+
+	// Helper: Adds or overwrites the entry of a page (latch held)
+	void put(const FreeSpaceEntry &entry);
+
+  public:
+	// Pages with less room than this are not worth tracking
+	static constexpr uint16_t MIN_TRACKED_SPACE = 32;
+
+	// Entries that fit in one page of the chain
+	static constexpr size_t ENTRIES_PER_PAGE =
+		(PAGE_SIZE - sizeof(PageHeader) - sizeof(FreeSpacePageHeader)) / sizeof(FreeSpaceEntry);
+
+	/**
+	 * Returns a page of the given type with at least 'needed' free bytes,
+	 * or INVALID_PAGE_ID if none is known.
+	 */
+	uint32_t findPage(ModelType type, uint16_t needed);
+
+	// Records the current free space of a page (after an insert, a delete or a failed attempt)
+	void update(ModelType type, uint32_t page_id, uint16_t free_space);
+
+	// Forgets a page (e.g. it was freed)
+	void remove(uint32_t page_id);
+
+	// --- PERSISTENCE ---
+	// Copy of the entries, to be written out ENTRIES_PER_PAGE at a time
+	std::vector<FreeSpaceEntry> snapshot();
+
+	// Lays out one page of the chain with 'count' entries
+	static void serializePage(Page *page, const FreeSpaceEntry *entries, size_t count, uint32_t next_page_id);
+
+	// Adds the entries of one page of the chain; returns the next page of the chain
+	uint32_t deserializePage(const Page *page);
+
+	void clear();
+
+	size_t size();
+};
+
+} // namespace LuminaDB
+
+#endif
@@ -35,17 +35,31 @@ class Page {
 
 	uint32_t getPageId() const;
 
-	// Returns how much space is left between the slots directory and the data
-	uint16_t getFreeSpace();
+	// Returns how much space an insert can use (including the bytes of deleted records)
+	uint16_t getFreeSpace() const;
 
 	/**
-	 * Inserts a serialized object into the page.
-	 * Returns true if successful, false if there is no space.
+	 * Inserts a serialized object into the page and returns its slot in slot_idx.
+	 * A deleted slot is reused before the directory grows; the page is compacted
+	 * first if the free bytes are fragmented. Returns false if there is no space.
 	 */
-	bool insertRecord(const char *record_data, uint16_t record_size);
+	bool insertRecord(const char *record_data, uint16_t record_size, uint16_t &slot_idx);
 
-	// Get the bytes of a specific object by its slot index
-	const char *getRecord(uint16_t slot_idx, uint16_t &out_size);
+	// Get the bytes of a specific object by its slot index (nullptr if out of range or deleted)
+	const char *getRecord(uint16_t slot_idx, uint16_t &out_size) const;
+
+	/**
+	 * Deletes a record by turning its slot into a tombstone (size 0).
+	 * The other slot numbers don't change, so their RecordIDs stay valid.
+	 * Returns false if the slot doesn't hold a record.
+	 */
+	bool deleteRecord(uint16_t slot_idx);
+
+	// Moves the live records together at the end of the page (slot numbers are kept)
+	void compact();
+
+	// Number of slots that hold a record
+	uint16_t getLiveCount() const;
 	const char *getRawData() const;
 };
 
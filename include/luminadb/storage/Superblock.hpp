@@ -0,0 +1,94 @@
+#ifndef LUMINADB_SUPERBLOCK_HPP
+#define LUMINADB_SUPERBLOCK_HPP
+
+#include "luminadb/common/types.hpp"
+#include "luminadb/storage/Page.hpp"
+#include <string>
+#include <vector>
+
+namespace LuminaDB {
+
+// The superblock always lives in the first page of the file
+inline constexpr uint32_t SUPERBLOCK_PAGE_ID = 0;
+
+// Bump whenever the on-disk layout changes; older/newer files are rejected on open
+inline constexpr uint32_t SUPERBLOCK_VERSION = 6;
+
+/**
+ * Fixed part of the superblock. Stored right after the PageHeader of page 0
+ * (the PageHeader stays first so the buffer pool can identify the page).
+ */
+struct SuperblockData {
+	char magic[8];			 // "LUMINADB"
+	uint32_t version;		 // SUPERBLOCK_VERSION of the writer
+	uint32_t page_size;		 // PAGE_SIZE of the writer
+	uint32_t next_page_id;	 // Allocator counter: first never-used page id
+	uint32_t free_list_head; // First freed page available for reuse (INVALID_PAGE_ID if none)
+	uint32_t fsm_page_id;	 // First page of the FreeSpaceMap chain
+	uint32_t catalog_count;	 // Number of CatalogEntry that follow
+};
+
+/**
+ * One index of the catalog: its name, where its root is and which key type it was built with.
+ */
+struct CatalogEntry {
+	char name[32]; // NUL-padded
+	uint32_t root_page_id;
+	uint32_t key_type; // KeyTraits<Key>::TYPE_ID of the tree (see KeyTypes.hpp)
+};
+
+/**
+ * In-memory copy of the meta page: everything needed to open the file in O(1),
+ * without scanning pages or guessing from their contents.
+ */
+class Superblock {
+  private:
+	SuperblockData data;
+	std::vector<CatalogEntry> catalog;
+
+  public:
+	static constexpr size_t MAX_NAME_LENGTH = sizeof(CatalogEntry::name) - 1;
+	static constexpr size_t CATALOG_CAPACITY =
+		(PAGE_SIZE - sizeof(PageHeader) - sizeof(SuperblockData)) / sizeof(CatalogEntry);
+
+	Superblock();
+
+	// Resets to the state of an empty database
+	void format();
+
+	/**
+	 * Reads the superblock from page 0.
+	 * Throws std::runtime_error if the page is not a LuminaDB superblock of this version.
+	 */
+	void load(const Page *page);
+
+	// Writes the superblock into page 0 (whole page is rewritten)
+	void store(Page *page) const;
+
+	// --- ALLOCATOR ---
+	uint32_t getNextPageId() const;
+	void setNextPageId(uint32_t page_id);
+
+	uint32_t getFreeListHead() const;
+	void setFreeListHead(uint32_t page_id);
+
+	uint32_t getFsmPageId() const;
+	void setFsmPageId(uint32_t page_id);
+
+	// --- CATALOG ---
+
+	// Root page of the index, or INVALID_PAGE_ID if there is no such index
+	uint32_t getIndexRoot(const std::string &name) const;
+
+	// Key type id the index was created with, or 0 if there is no such index
+	uint32_t getIndexKeyType(const std::string &name) const;
+
+	// Adds the index or moves its root. Throws if the name is too long or the catalog is full.
+	void setIndexRoot(const std::string &name, uint32_t root_page_id, uint32_t key_type);
+
+	const std::vector<CatalogEntry> &getCatalog() const;
+};
+
+} // namespace LuminaDB
+
+#endif
@@ -0,0 +1,166 @@
+#include "luminadb/buffer/ARCReplacer.hpp"
+#include "luminadb/common/types.hpp"
+
+#include <algorithm>
+
+namespace LuminaDB {
+ARCReplacer::ARCReplacer(size_t num_frames)
+	: capacity(num_frames), target(0), current_time(0),
+	  correlated_period(std::max<size_t>(num_frames / CORRELATED_REFERENCE_DIVISOR, 1)), t1(num_frames),
+	  t2(num_frames), list_of(num_frames, NO_LIST), evictable(num_frames, 0), frame_page(num_frames, INVALID_PAGE_ID),
+	  arrival(num_frames, 0), evictable_count(0) {}
+
+ARCReplacer::~ARCReplacer() = default;
+
+uint32_t ARCReplacer::firstEvictable(const FrameList &list) const {
+	uint32_t frame = list.front();
+	while (frame != FrameList::NONE && !evictable[frame]) {
+		frame = list.after(frame);
+	}
+	return frame;
+}
+
+void ARCReplacer::detach(uint32_t frame_id) {
+	if (list_of[frame_id] == RECENT) {
+		t1.remove(frame_id);
+	} else if (list_of[frame_id] == FREQUENT) {
+		t2.remove(frame_id);
+	}
+	list_of[frame_id] = NO_LIST;
+}
+
+void ARCReplacer::trimGhosts() {
+	while (t1.size() + b1.size() > capacity && !b1.empty()) {
+		b1.popFront();
+	}
+	while (t1.size() + t2.size() + b1.size() + b2.size() > 2 * capacity) {
+		if (!b2.empty()) {
+			b2.popFront();
+		} else if (!b1.empty()) {
+			b1.popFront();
+		} else {
+			break;
+		}
+	}
+}
+
+/**
+ * VICTIM: The least recently used page of T1 if T1 is over its target, of T2 otherwise
+ * (or of the other list when all the frames of the chosen one are pinned).
+ * The page id is remembered in the ghost list of the list it left.
+ */
+bool ARCReplacer::victim(uint32_t *frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (evictable_count == 0)
+		return false;
+
+	uint32_t from_recent = firstEvictable(t1);
+	uint32_t chosen = from_recent;
+	if (t1.size() <= target || from_recent == FrameList::NONE) {
+		uint32_t from_frequent = firstEvictable(t2);
+		if (from_frequent != FrameList::NONE) {
+			chosen = from_frequent;
+		}
+	}
+
+	if (frame_page[chosen] != INVALID_PAGE_ID) {
+		(list_of[chosen] == RECENT ? b1 : b2).pushBack(frame_page[chosen]);
+	}
+
+	detach(chosen);
+	evictable[chosen] = 0;
+	evictable_count--;
+	frame_page[chosen] = INVALID_PAGE_ID;
+	trimGhosts();
+
+	*frame_id = chosen;
+	return true;
+}
+
+void ARCReplacer::pin(uint32_t frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (evictable[frame_id]) {
+		evictable[frame_id] = 0;
+		evictable_count--;
+	}
+}
+
+/**
+ * UNPIN: A frame that was never referenced (prefetched) joins T1 as a new page.
+ */
+void ARCReplacer::unpin(uint32_t frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (evictable[frame_id])
+		return;
+
+	evictable[frame_id] = 1;
+	evictable_count++;
+	if (list_of[frame_id] == NO_LIST) {
+		t1.pushBack(frame_id);
+		list_of[frame_id] = RECENT;
+		trimGhosts();
+	}
+}
+
+size_t ARCReplacer::Size() {
+	std::lock_guard<std::mutex> lock(latch);
+	return evictable_count;
+}
+
+/**
+ * ACCESS: A hit moves the page to the back of T2, except a hit on a T1 page still within
+ * the correlated reference period of its arrival, which changes nothing.
+ * A page new to the frame goes to T2 if a ghost list remembers it (adapting the target
+ * toward the list that missed it), and to T1 otherwise.
+ */
+void ARCReplacer::recordAccess(uint32_t frame_id, uint32_t page_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	uint64_t now = ++current_time;
+	if (frame_page[frame_id] == page_id) {
+		if (list_of[frame_id] == RECENT && now - arrival[frame_id] <= correlated_period) {
+			return;
+		}
+		detach(frame_id);
+		t2.pushBack(frame_id);
+		list_of[frame_id] = FREQUENT;
+		return;
+	}
+
+	detach(frame_id);
+	frame_page[frame_id] = page_id;
+	arrival[frame_id] = now;
+
+	size_t b1_size = b1.size();
+	size_t b2_size = b2.size();
+	if (b1.erase(page_id)) {
+		target = std::min(capacity, target + std::max<size_t>(b2_size / b1_size, 1));
+		t2.pushBack(frame_id);
+		list_of[frame_id] = FREQUENT;
+	} else if (b2.erase(page_id)) {
+		size_t step = std::max<size_t>(b1_size / b2_size, 1);
+		target = target > step ? target - step : 0;
+		t2.pushBack(frame_id);
+		list_of[frame_id] = FREQUENT;
+	} else {
+		t1.pushBack(frame_id);
+		list_of[frame_id] = RECENT;
+	}
+	trimGhosts();
+}
+
+void ARCReplacer::remove(uint32_t frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (evictable[frame_id]) {
+		evictable[frame_id] = 0;
+		evictable_count--;
+	}
+	detach(frame_id);
+	frame_page[frame_id] = INVALID_PAGE_ID;
+}
+
+} // namespace LuminaDB
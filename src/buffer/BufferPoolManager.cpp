@@ -1,205 +1,846 @@
 #include "luminadb/buffer/BufferPoolManager.hpp"
+#include "luminadb/common/Log.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
 
 namespace LuminaDB {
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-	: pool_size(pool_size), disk_manager(disk_manager) {
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, bool mmap_reads, size_t shard_count,
+									 ReplacerPolicy replacer_policy)
+	: pool_size(pool_size), disk_manager(disk_manager), mmap_reads(mmap_reads) {
 
 	// Recover the previous state
 	next_page_id = disk_manager->getExistingPageCount();
+	free_page_head = INVALID_PAGE_ID;
+	free_page_link = INVALID_PAGE_ID;
+	free_link_known = false;
+	reading_free_link = false;
 
 	// Reset the memory block for the pages
 	pages = new Page[pool_size];
-	replacer = new LRUReplacer(pool_size);
+	io_engine = new AsyncIOEngine(disk_manager);
 
-	is_dirty = new bool[pool_size];
-	pin_count = new uint32_t[pool_size];
+	frames = new FrameDescriptor[pool_size]; // All free, clean and unpinned
+	frame_latches = new std::shared_mutex[pool_size];
 
-	// Initially, all frames are empty.
-	for (size_t i = 0; i < pool_size; ++i) {
-		is_dirty[i] = false;
-		pin_count[i] = 0;
-		free_list.push_back(static_cast<uint32_t>(i));
+	// Split the frames in shards of consecutive frames; the first ones take the remainder
+	if (shard_count == 0) {
+		shard_count = std::clamp<size_t>(pool_size / MIN_FRAMES_PER_SHARD, 1, MAX_BUFFER_POOL_SHARDS);
+	}
+	shard_count = std::clamp<size_t>(shard_count, 1, std::max<size_t>(pool_size, 1));
+
+	uint32_t next_frame = 0;
+	for (size_t s = 0; s < shard_count; ++s) {
+		auto shard = std::make_unique<Shard>(pool_size / shard_count + (s < pool_size % shard_count ? 1 : 0));
+		shard->first_frame = next_frame;
+		shard->replacer = makeReplacer(replacer_policy, shard->frame_count);
+
+		// Initially, all frames are empty.
+		for (size_t i = 0; i < shard->frame_count; ++i) {
+			shard->free_list.push_back(next_frame++);
+		}
+		shards.push_back(std::move(shard));
+	}
+
+	// Nothing to map in an empty file: everything goes through the frames
+	if (this->mmap_reads) {
+		this->mmap_reads = disk_manager->mapFile();
 	}
 
-	// Debug
 	if (next_page_id > 0) {
-		std::cout << "[BPM] Resuming from page ID: " << next_page_id << std::endl;
+		LUMINADB_LOG_INFO("BPM", "Resuming from page ID: " << next_page_id);
 	}
 }
 
-Page *BufferPoolManager::fetchPage(uint32_t page_id) {
-	std::lock_guard<std::mutex> lock(latch);
+bool FrameDescriptor::tryPin(uint32_t page_id, bool &first) {
+	uint64_t current = state.load(std::memory_order_acquire);
+	while (static_cast<uint32_t>(current >> 32) == page_id && !(current & LOADING)) {
+		if (state.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel)) {
+			first = (current & PIN_MASK) == 0;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FrameDescriptor::unpin(uint32_t page_id, bool &last) {
+	uint64_t current = state.load(std::memory_order_acquire);
+	while (static_cast<uint32_t>(current >> 32) == page_id && (current & PIN_MASK) > 0) {
+		if (state.compare_exchange_weak(current, current - 1, std::memory_order_acq_rel)) {
+			last = (current & PIN_MASK) == 1;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FrameDescriptor::tryReplace(uint32_t page_id, uint32_t new_page_id, bool loading) {
+	uint64_t expected = pack(page_id, false, 0);
+	return state.compare_exchange_strong(expected, pack(new_page_id, loading, 0), std::memory_order_acq_rel);
+}
+
+BufferPoolManager::Shard &BufferPoolManager::shardOf(uint32_t page_id) { return *shards[page_id % shards.size()]; }
+
+void BufferPoolManager::mapFrame(Shard &shard, uint32_t page_id, uint32_t frame_id, uint32_t pins, bool loading) {
+	// The descriptor first: a lock-free lookup that finds the entry must see the frame's new page
+	frames[frame_id].dirty.store(false, std::memory_order_relaxed);
+	frames[frame_id].state.store(FrameDescriptor::pack(page_id, loading, pins), std::memory_order_release);
+	shard.page_table.insert(page_id, frame_id);
+}
+
+void BufferPoolManager::unmapFrame(Shard &shard, uint32_t page_id, uint32_t frame_id) {
+	shard.page_table.erase(page_id);
+	frames[frame_id].state.store(FrameDescriptor::pack(INVALID_PAGE_ID, false, 0), std::memory_order_release);
+}
+
+void BufferPoolManager::pinFrame(Shard &shard, uint32_t frame_id) {
+	shard.pin(frame_id);
+	if (frames[frame_id].pinCount() == 0) {
+		shard.unpin(frame_id);
+	}
+}
 
-	// CASE A: Is the page already in RAM?
-	if (page_table.find(page_id) != page_table.end()) {
-		uint32_t frame_id = page_table[page_id];
-		pin_count[frame_id]++;
-		replacer->pin(frame_id); // Remove from the victims list
+void BufferPoolManager::finishLoading(Shard &shard, uint32_t frame_id) {
+	frames[frame_id].state.fetch_and(~FrameDescriptor::LOADING, std::memory_order_release);
+	shard.io_done.notify_all();
+}
+
+void BufferPoolManager::waitForIO(Shard &shard, std::unique_lock<std::mutex> &lock, uint32_t page_id) {
+	shard.io_done.wait(lock, [&] {
+		uint32_t frame_id = shard.page_table.find(page_id);
+		bool in_flight = frame_id != PageTable::NOT_FOUND ? frames[frame_id].isLoading() : shard.writing.count(page_id) > 0;
+		return !in_flight;
+	});
+}
+
+bool BufferPoolManager::acquireFrame(Shard &shard, uint32_t &frame_id, std::unique_ptr<char[]> &staging,
+									 uint32_t &victim_id) {
+	// A frame that has never been used
+	if (!shard.free_list.empty()) {
+		frame_id = shard.free_list.front();
+		shard.free_list.pop_front();
+		return true;
+	}
+
+	// A victim pinned meanwhile by a lock-free fetchPage() is skipped: its unpin hands it back to the replacer
+	while (shard.victim(&frame_id)) {
+		FrameDescriptor &frame = frames[frame_id];
+		victim_id = frame.pageId();
+		if (!frame.tryReplace(victim_id, INVALID_PAGE_ID, false)) {
+			continue;
+		}
+
+		// Stage a dirty victim, so its write-back can run outside the latch while the frame is reused
+		if (frame.dirty.exchange(false, std::memory_order_acq_rel)) {
+			staging = std::make_unique<char[]>(PAGE_SIZE);
+			std::memcpy(staging.get(), pages[frame_id].getRawData(), PAGE_SIZE);
+			shard.writing.insert(victim_id);
+		}
+		shard.page_table.erase(victim_id);
+		LUMINADB_TRACE("evict", victim_id, frame_id);
+		return true;
+	}
+	return false; // There is no space
+}
+
+void BufferPoolManager::finishWriteBack(Shard &shard, uint32_t victim_id) {
+	shard.writing.erase(victim_id);
+	shard.io_done.notify_all();
+}
+
+bool BufferPoolManager::waitForWriteBack(Shard &shard, std::unique_lock<std::mutex> &lock) {
+	if (shard.write_back_pins == 0) {
+		return false;
+	}
+	// One batch ending is enough: its frames are evictable again before the next one is pinned
+	shard.io_done.wait(lock);
+	return true;
+}
+
+void BufferPoolManager::restoreVictim(Shard &shard, uint32_t victim_id, uint32_t frame_id, const char *staging) {
+	std::memcpy(const_cast<char *>(pages[frame_id].getRawData()), staging, PAGE_SIZE);
+	mapFrame(shard, victim_id, frame_id, 0, false);
+	frames[frame_id].dirty.store(true, std::memory_order_release);
+	shard.unpin(frame_id); // victim() took it out of the replacer
+	finishWriteBack(shard, victim_id);
+	LUMINADB_LOG_WARN("BPM", "Write-back of page " << victim_id << " failed; kept dirty in frame " << frame_id);
+}
+
+Page *BufferPoolManager::fetchPage(uint32_t page_id) {
+	Shard &shard = shardOf(page_id);
+
+	// CASE A: Is the page already in RAM? No latch: the pin itself checks that the frame
+	// still holds the page and that it is not being read in
+	uint32_t frame_id = shard.page_table.find(page_id);
+	bool first = false;
+	if (frame_id != PageTable::NOT_FOUND && frames[frame_id].tryPin(page_id, first)) {
+		if (first) {
+			pinFrame(shard, frame_id); // Remove from the victims list
+		}
+		shard.recordAccess(frame_id, page_id);
 		return &pages[frame_id];
 	}
 
-	// CASE B: The page is not in RAM. An empty frame is needed.
-	uint32_t frame_id;
-	if (!free_list.empty()) {
-		frame_id = free_list.front();
-		free_list.pop_front();
-	} else if (replacer->victim(&frame_id)) {
-		if (is_dirty[frame_id]) {
-			disk_manager->writePage(pages[frame_id].getHeader()->page_id, pages[frame_id].getRawData());
-			is_dirty[frame_id] = false;
-		}
-		page_table.erase(pages[frame_id].getHeader()->page_id);
-	} else {
-		return nullptr;
+	// CASE B: Not there, still loading, or remapped meanwhile: look again under the latch
+	// (and again after waiting for a write-back to give its frames back)
+	std::unique_lock<std::mutex> lock(shard.latch);
+	uint32_t victim_id = INVALID_PAGE_ID;
+	std::unique_ptr<char[]> staging;
+	while (true) {
+		waitForIO(shard, lock, page_id);
+		frame_id = shard.page_table.find(page_id);
+		if (frame_id != PageTable::NOT_FOUND && frames[frame_id].tryPin(page_id, first)) {
+			if (first) {
+				pinFrame(shard, frame_id);
+			}
+			shard.recordAccess(frame_id, page_id);
+			return &pages[frame_id];
+		}
+
+		// CASE C: The page is not in RAM. An empty frame is needed.
+		if (acquireFrame(shard, frame_id, staging, victim_id)) {
+			break;
+		}
+		if (!waitForWriteBack(shard, lock)) {
+			return nullptr;
+		}
 	}
 
-	// Bring the page from the disk to the chosen frame
-	char *frame_ptr = const_cast<char *>(pages[frame_id].getRawData());
-	disk_manager->readPage(page_id, frame_ptr);
+	// Claim the frame for the page before letting go of the latch: others wait for the read.
+	// It comes clean from the disc, with its first user's pin
+	mapFrame(shard, page_id, frame_id, 1, true);
+	lock.unlock();
 
-	// Update the table and notify the replacer
-	page_table[page_id] = frame_id;
-	pin_count[frame_id] = 1;	// First user
-	is_dirty[frame_id] = false; // It comes clean from the disc
-	replacer->pin(frame_id);
+	// The victim's write-back and the new read go out together
+	std::vector<IORequest> batch;
+	if (staging) {
+		batch.push_back({IOOp::WRITE, victim_id, staging.get()});
+	}
+	char *frame_ptr = const_cast<char *>(pages[frame_id].getRawData());
+	batch.push_back({IOOp::READ, page_id, frame_ptr});
+
+	try {
+		io_engine->execute(batch);
+	} catch (...) {
+		// The page wasn't read; a staged victim may not have been written either, and its
+		// copy is the only one left: it takes the frame back
+		lock.lock();
+		unmapFrame(shard, page_id, frame_id);
+		if (staging) {
+			restoreVictim(shard, victim_id, frame_id, staging.get());
+		} else {
+			shard.free_list.push_back(frame_id);
+			shard.io_done.notify_all();
+		}
+		throw;
+	}
 
+	lock.lock();
+	if (staging) {
+		shard.writing.erase(victim_id);
+	}
+	shard.recordAccess(frame_id, page_id);
+	finishLoading(shard, frame_id);
 	return &pages[frame_id];
 }
 
 bool BufferPoolManager::unpinPage(uint32_t page_id, bool is_dirty_flag) {
+	Shard &shard = shardOf(page_id);
+
+	// Is the page in RAM? The caller's pin keeps it in its frame; only a lookup that raced
+	// with a change of the table needs to be repeated under the latch
+	uint32_t frame_id = shard.page_table.find(page_id);
+	if (frame_id == PageTable::NOT_FOUND || frames[frame_id].pageId() != page_id) {
+		std::lock_guard<std::mutex> lock(shard.latch);
+		frame_id = shard.page_table.find(page_id);
+		if (frame_id == PageTable::NOT_FOUND) {
+			return false;
+		}
+	}
+	FrameDescriptor &frame = frames[frame_id];
+
+	// If the user modified it, the frame is marked as dirty (before the pin goes, so
+	// whoever evicts the frame next sees it)
+	if (is_dirty_flag) {
+		frame.dirty.store(true, std::memory_order_release);
+	}
 
-	// Is the page in RAM?
-	if (page_table.find(page_id) == page_table.end()) {
+	// Decrease the count (nothing to do if nobody was using it).
+	// If it reaches 0, the Replacer is notified that it CAN now be a victim.
+	bool last = false;
+	if (!frame.unpin(page_id, last)) {
 		return false;
 	}
+	if (last) {
+		shard.unpin(frame_id);
+	}
 
-	uint32_t frame_id = page_table[page_id];
+	return true;
+}
 
-	// If the user modified it, the frame is marked as dirty.
-	if (is_dirty_flag) {
-		is_dirty[frame_id] = true;
+const Page *BufferPoolManager::fetchPageForRead(uint32_t page_id) {
+	if (mmap_reads) {
+		Shard &shard = shardOf(page_id);
+		std::lock_guard<std::mutex> lock(shard.latch);
+
+		// A frame copy may be newer than the file (dirty), and so may a write-back in flight
+		if (shard.page_table.find(page_id) == PageTable::NOT_FOUND && shard.writing.count(page_id) == 0) {
+			const char *mapped = disk_manager->getMappedPage(page_id);
+			if (mapped != nullptr) {
+				return reinterpret_cast<const Page *>(mapped);
+			}
+		}
 	}
 
-	// If nobody is using it (pins_count is already 0), there's nothing to do.
-	if (pin_count[frame_id] <= 0) {
-		return false;
+	return fetchPage(page_id);
+}
+
+bool BufferPoolManager::unpinPageForRead(uint32_t page_id, const Page *page) {
+	// Mapped pages were never pinned
+	if (disk_manager->isMapped(page)) {
+		return true;
 	}
+	return unpinPage(page_id, false);
+}
 
-	// Decrease the count.
-	// If it reaches 0, the Replacer is notified that it CAN now be a victim.
-	pin_count[frame_id]--;
+void BufferPoolManager::latchPage(const Page *page, bool exclusive) {
+	// The frame can't change while the page is pinned, so the shard latch isn't needed
+	if (page < pages || page >= pages + pool_size)
+		return; // Mapped page
 
-	if (pin_count[frame_id] == 0) {
-		replacer->unpin(frame_id);
+	std::shared_mutex &frame_latch = frame_latches[page - pages];
+	if (exclusive) {
+		frame_latch.lock();
+	} else {
+		frame_latch.lock_shared();
 	}
+}
 
-	return true;
+bool BufferPoolManager::tryLatchPage(const Page *page, bool exclusive) {
+	if (page < pages || page >= pages + pool_size)
+		return true;
+
+	std::shared_mutex &frame_latch = frame_latches[page - pages];
+	return exclusive ? frame_latch.try_lock() : frame_latch.try_lock_shared();
 }
 
-Page *BufferPoolManager::newPage(uint32_t &page_id, ModelType object_type) {
-	std::lock_guard<std::mutex> lock(latch);
+void BufferPoolManager::unlatchPage(const Page *page, bool exclusive) {
+	if (page < pages || page >= pages + pool_size)
+		return;
+
+	std::shared_mutex &frame_latch = frame_latches[page - pages];
+	if (exclusive) {
+		frame_latch.unlock();
+	} else {
+		frame_latch.unlock_shared();
+	}
+}
+
+Page *BufferPoolManager::installNewPage(uint32_t page_id) {
+	Shard &shard = shardOf(page_id);
+	std::unique_lock<std::mutex> lock(shard.latch);
 	uint32_t frame_id;
+	uint32_t victim_id = INVALID_PAGE_ID;
+	std::unique_ptr<char[]> staging;
+	while (true) {
+		waitForIO(shard, lock, page_id);
+
+		// A frame may still cache this id from a read past the end of the file (all zeros).
+		// Drop it, otherwise evicting it later would erase the new page's table entry. While
+		// someone holds it, its unpin needs the descriptor as it is: wait for the pin to go
+		// (unpins neither take the latch nor signal, so look again every so often)
+		uint32_t stale_frame = shard.page_table.find(page_id);
+		if (stale_frame != PageTable::NOT_FOUND) {
+			if (!frames[stale_frame].tryReplace(page_id, INVALID_PAGE_ID, false)) {
+				shard.io_done.wait_for(lock, STALE_PIN_POLL_INTERVAL);
+				continue;
+			}
+			shard.page_table.erase(page_id);
+			shard.remove(stale_frame);
+			shard.free_list.push_back(stale_frame);
+		}
 
-	// A. Search for an available frame (Same as in fetchPage)
-	if (!free_list.empty()) {
-		frame_id = free_list.front();
-		free_list.pop_front();
-	} else if (replacer->victim(&frame_id)) {
-		Page *victim_page = &pages[frame_id];
+		if (acquireFrame(shard, frame_id, staging, victim_id)) {
+			break;
+		}
+		if (!waitForWriteBack(shard, lock)) {
+			return nullptr;
+		}
+	}
 
-		// IF THE VICTIM WAS DIRTY, IT WAS RECORDED
-		if (is_dirty[frame_id]) {
-			disk_manager->writePage(victim_page->getHeader()->page_id, victim_page->getRawData());
-			is_dirty[frame_id] = false;
+	// It is marked as used immediately, and as loading until it has been zeroed
+	mapFrame(shard, page_id, frame_id, 1, true);
+
+	// Nothing to read, but a dirty victim still has to reach the disk first
+	if (staging) {
+		lock.unlock();
+		try {
+			disk_manager->writePage(victim_id, staging.get());
+		} catch (...) {
+			lock.lock();
+			unmapFrame(shard, page_id, frame_id);
+			restoreVictim(shard, victim_id, frame_id, staging.get());
+			throw;
 		}
-		page_table.erase(victim_page->getHeader()->page_id);
-	} else {
-		return nullptr; // There is no space
+		lock.lock();
+		finishWriteBack(shard, victim_id);
 	}
 
-	// B. Generate a new ID and "format" the page
-	page_id = next_page_id++;
+	std::memset(const_cast<char *>(pages[frame_id].getRawData()), 0, PAGE_SIZE);
+	shard.recordAccess(frame_id, page_id);
+	finishLoading(shard, frame_id);
+	return &pages[frame_id];
+}
+
+bool BufferPoolManager::popFreePage(uint32_t &page_id, uint32_t &next_free) {
+	std::unique_lock<std::mutex> alloc_lock(alloc_latch);
+	while (free_page_head != INVALID_PAGE_ID) {
+		if (free_link_known) {
+			page_id = free_page_head;
+			next_free = free_page_link;
+			free_page_head = free_page_link;
+			free_link_known = false;
+			return true;
+		}
 
+		// Someone is reading it already: wait for that read (alloc_latch is free meanwhile)
+		if (reading_free_link) {
+			free_link_read.wait(alloc_lock);
+			continue;
+		}
+
+		// The link is stored in the head page: read it without holding the latch
+		uint32_t head = free_page_head;
+		reading_free_link = true;
+		alloc_lock.unlock();
+		uint32_t link = INVALID_PAGE_ID;
+		Page *page = nullptr;
+		try {
+			page = fetchPage(head);
+			if (page != nullptr) {
+				latchPage(page, false);
+				std::memcpy(&link, page->getRawData() + sizeof(PageHeader), sizeof(link));
+				unlatchPage(page, false);
+				unpinPage(head, false);
+			}
+		} catch (...) {
+			alloc_lock.lock();
+			reading_free_link = false;
+			free_link_read.notify_all();
+			throw;
+		}
+		alloc_lock.lock();
+		reading_free_link = false;
+		free_link_read.notify_all();
+
+		if (page == nullptr) {
+			return false;
+		}
+		// A deletePage() meanwhile pushed a new head, whose link it knows: loop and take that one
+		if (free_page_head == head && !free_link_known) {
+			free_page_link = link;
+			free_link_known = true;
+		}
+	}
+	return false;
+}
+
+void BufferPoolManager::returnFreePage(uint32_t page_id, uint32_t next_free, Page *page) {
+	// Nothing changed the head since: the page still links to it as it is
+	bool restored = false;
+	{
+		std::lock_guard<std::mutex> alloc_lock(alloc_latch);
+		if (free_page_head == next_free) {
+			free_page_link = next_free;
+			free_link_known = true;
+			free_page_head = page_id;
+			restored = true;
+		}
+	}
+	if (restored) {
+		// Unpinned after alloc_latch is released: deletePage() takes a shard latch before it
+		if (page != nullptr) {
+			unpinPage(page_id, false);
+		}
+		return;
+	}
+
+	if (page == nullptr) {
+		// Not in a frame: deletePage() rewrites it with the current head as its link
+		if (!deletePage(page_id)) {
+			LUMINADB_LOG_WARN("BPM", "Free page " << page_id << " could not be put back on the free list");
+		}
+		return;
+	}
+
+	// Relink it to the current head under its latch, so a later pop reads the new link
+	latchPage(page, true);
+	{
+		std::lock_guard<std::mutex> alloc_lock(alloc_latch);
+		std::memcpy(const_cast<char *>(page->getRawData()) + sizeof(PageHeader), &free_page_head,
+					sizeof(free_page_head));
+		free_page_link = free_page_head;
+		free_link_known = true;
+		free_page_head = page_id;
+	}
+	unlatchPage(page, true);
+	unpinPage(page_id, true);
+}
+
+void BufferPoolManager::releasePageId(uint32_t page_id) {
+	{
+		std::lock_guard<std::mutex> alloc_lock(alloc_latch);
+		if (next_page_id == page_id + 1) {
+			next_page_id = page_id;
+			return;
+		}
+	}
+
+	// Later ids were handed out meanwhile: put this one on the free list rather than leave a hole
+	if (!deletePage(page_id)) {
+		LUMINADB_LOG_WARN("BPM", "Page id " << page_id << " could not be given back");
+	}
+}
+
+Page *BufferPoolManager::newPage(uint32_t &page_id, ModelType object_type) {
+	// Ids are handed out under alloc_latch; the fetch or install (disk I/O) happens after it is released
+	Page *page = nullptr;
+	uint32_t next_free;
+
+	// A. Reuse the first page of the free list, so the file stays dense
+	if (popFreePage(page_id, next_free)) {
+		page = fetchPage(page_id);
+		if (page == nullptr) {
+			returnFreePage(page_id, next_free, nullptr);
+			return nullptr;
+		}
+
+		if (frames[page - pages].pinCount() > 1) {
+			// Nobody should hold a freed page. If someone still does, it goes back to the head of
+			// the list for a later call and this one takes a page at the end of the file
+			LUMINADB_LOG_DEBUG("BPM", "Free page " << page_id << " is pinned; allocating at the end of the file");
+			returnFreePage(page_id, next_free, page);
+			page = nullptr;
+		}
+	}
+
+	if (page == nullptr) {
+		// B. Generate a new ID at the end of the file
+		{
+			std::lock_guard<std::mutex> alloc_lock(alloc_latch);
+			page_id = next_page_id++;
+		}
+		try {
+			page = installNewPage(page_id);
+		} catch (...) {
+			releasePageId(page_id);
+			throw;
+		}
+		if (page == nullptr) {
+			releasePageId(page_id);
+			return nullptr;
+		}
+	}
+
+	// C. "Format" the page (nobody else can reach it yet)
 	if (object_type == ModelType::B_PLUS_TREE) {
-		char *raw_data = const_cast<char *>(pages[frame_id].getRawData());
+		char *raw_data = const_cast<char *>(page->getRawData());
 		std::memset(raw_data, 0, PAGE_SIZE);
 
-		auto *header = reinterpret_cast<PageHeader *>(const_cast<char *>(pages[frame_id].getRawData()));
+		auto *header = reinterpret_cast<PageHeader *>(raw_data);
 		header->page_id = page_id;
 		header->object_type = static_cast<uint32_t>(object_type);
-	} else {
-		pages[frame_id].init(page_id, object_type);
 	}
 
-	pages[frame_id].init(page_id, object_type);
+	page->init(page_id, object_type);
+	return page;
+}
 
-	// C. Update Manager metadata
-	page_table[page_id] = frame_id;
-	pin_count[frame_id] = 1; // It is marked as used immediately.
-	is_dirty[frame_id] = false;
+void BufferPoolManager::writeFrames(Shard &shard, std::unique_lock<std::mutex> &lock,
+									const std::vector<uint32_t> &frame_ids) {
+	// Each frame goes to the page its descriptor maps (the pin keeps it), never to whatever
+	// its header says: a header being rewritten must not redirect the write to another page
+	std::vector<IORequest> batch;
+	for (uint32_t frame_id : frame_ids) {
+		batch.push_back({IOOp::WRITE, frames[frame_id].pageId(), const_cast<char *>(pages[frame_id].getRawData())});
+	}
 
-	return &pages[frame_id];
+	shard.write_back_pins += frame_ids.size();
+	lock.unlock();
+	std::exception_ptr failure;
+	try {
+		io_engine->execute(batch);
+	} catch (...) {
+		failure = std::current_exception();
+	}
+	for (uint32_t frame_id : frame_ids) {
+		frame_latches[frame_id].unlock_shared();
+	}
+	lock.lock();
+
+	for (uint32_t frame_id : frame_ids) {
+		FrameDescriptor &frame = frames[frame_id];
+		if (failure) {
+			frame.dirty.store(true, std::memory_order_release);
+		}
+		bool last = false;
+		if (frame.unpin(frame.pageId(), last) && last) {
+			shard.unpin(frame_id);
+		}
+	}
+	shard.write_back_pins -= frame_ids.size();
+	shard.io_done.notify_all(); // A fetch may be waiting for these frames
+
+	if (failure) {
+		std::rethrow_exception(failure);
+	}
 }
 
 bool BufferPoolManager::flushPage(uint32_t page_id) {
-	std::lock_guard<std::mutex> lock(latch);
+	Shard &shard = shardOf(page_id);
+	std::unique_lock<std::mutex> lock(shard.latch);
 
-	// If the page is not in RAM, there is nothing to "flash".
-	if (page_table.find(page_id) == page_table.end())
+	// If the page is not in RAM (or not read in yet), there is nothing to "flash".
+	uint32_t frame_id = shard.page_table.find(page_id);
+	if (frame_id == PageTable::NOT_FOUND || frames[frame_id].isLoading())
 		return false;
 
-	uint32_t frame_id = page_table[page_id];
-
-	// Disk Manager is used to write
-	disk_manager->writePage(page_id, pages[frame_id].getRawData());
+	// Someone is changing it: writing now could tear the page. Never wait here while
+	// holding the shard latch (the writer may be waiting for it).
+	if (!frame_latches[frame_id].try_lock_shared())
+		return false;
 
 	// Important: It's no longer "dirty", RAM and Disk are now the same
-	is_dirty[frame_id] = false;
+	bool first = false;
+	frames[frame_id].tryPin(page_id, first); // Mapped and loaded, and the latch keeps it so
+	if (first) {
+		pinFrame(shard, frame_id);
+	}
+	frames[frame_id].dirty.store(false, std::memory_order_release);
+	writeFrames(shard, lock, {frame_id});
 	return true;
 }
 
 bool BufferPoolManager::deletePage(uint32_t page_id) {
-	std::lock_guard<std::mutex> lock(latch);
+	Shard &shard = shardOf(page_id);
+	std::unique_lock<std::mutex> lock(shard.latch);
+	waitForIO(shard, lock, page_id);
+
+	// STEP 1: Does anyone use it? If so, it can't be deleted. If not, the frame is marked
+	// as loading while it is rewritten, so no lock-free fetchPage() can pin it meanwhile
+	uint32_t frame_id = shard.page_table.find(page_id);
+	if (frame_id != PageTable::NOT_FOUND && !frames[frame_id].tryReplace(page_id, page_id, true)) {
+		return false;
+	}
 
-	// Is it in RAM?
-	if (page_table.find(page_id) != page_table.end()) {
-		uint32_t frame_id = page_table[page_id];
+	// STEP 2: Push it onto the free list. The link is kept in memory too, so the next newPage()
+	// pops it without reading the page (which is still loading or in flight until STEP 3 is done)
+	uint32_t next_free;
+	{
+		std::lock_guard<std::mutex> alloc_lock(alloc_latch);
+		next_free = free_page_head;
+		free_page_link = next_free;
+		free_link_known = true;
+		free_page_head = page_id;
+	}
 
-		// Does anyone use it? If so, it can't be deleted.
-		if (pin_count[frame_id] > 0) {
-			return false;
+	// STEP 3: Turn it into a free page that links to the previous head
+	if (frame_id != PageTable::NOT_FOUND) {
+		Page *target = &pages[frame_id];
+		target->init(page_id, ModelType::FREE_PAGE);
+		std::memcpy(const_cast<char *>(target->getRawData()) + sizeof(PageHeader), &next_free, sizeof(next_free));
+		frames[frame_id].dirty.store(true, std::memory_order_release);
+		finishLoading(shard, frame_id);
+	} else {
+		// Not in RAM: build it aside and write it out, without the latch but marked as in flight
+		auto buffer = std::make_unique<char[]>(PAGE_SIZE);
+		std::memset(buffer.get(), 0, PAGE_SIZE);
+		Page *target = reinterpret_cast<Page *>(buffer.get());
+		target->init(page_id, ModelType::FREE_PAGE);
+		std::memcpy(buffer.get() + sizeof(PageHeader), &next_free, sizeof(next_free));
+
+		shard.writing.insert(page_id);
+		lock.unlock();
+		try {
+			disk_manager->writePage(page_id, buffer.get());
+		} catch (...) {
+			// Take it back off the list while nobody has popped or covered it yet
+			{
+				std::lock_guard<std::mutex> alloc_lock(alloc_latch);
+				if (free_page_head == page_id) {
+					free_page_head = next_free;
+					free_link_known = false;
+				}
+			}
+			lock.lock();
+			finishWriteBack(shard, page_id);
+			throw;
 		}
+		lock.lock();
+		finishWriteBack(shard, page_id);
+	}
+	return true;
+}
+
+uint32_t BufferPoolManager::getFreePageHead() {
+	std::lock_guard<std::mutex> lock(alloc_latch);
+	return free_page_head;
+}
+
+void BufferPoolManager::setFreePageHead(uint32_t page_id) {
+	std::lock_guard<std::mutex> lock(alloc_latch);
+	free_page_head = page_id;
+	free_link_known = false; // Read from the page when it is first popped
+}
 
-		// Clean metadata in RAM
-		page_table.erase(page_id);
-		replacer->pin(frame_id); // It is removed from the replacer because it no longer exists
+void BufferPoolManager::writeBackDirtyPages(Shard &shard) {
+	std::unique_lock<std::mutex> lock(shard.latch);
+
+	// The dirty frames that nobody is modifying go out in batches, pinned so they stay put.
+	// A batch takes at most a fraction of the shard, so the rest remains evictable meanwhile
+	size_t chunk = std::max<size_t>(1, shard.frame_count / WRITE_BACK_CHUNK_DIVISOR);
+	uint32_t end_frame = shard.first_frame + static_cast<uint32_t>(shard.frame_count);
+	uint32_t frame_id = shard.first_frame;
+	while (frame_id < end_frame) {
+		std::vector<uint32_t> frame_ids;
+		for (; frame_id < end_frame && frame_ids.size() < chunk; ++frame_id) {
+			FrameDescriptor &frame = frames[frame_id];
+			uint32_t page_id = frame.pageId();
+			if (page_id == INVALID_PAGE_ID || frame.isLoading() || !frame.dirty.load(std::memory_order_acquire) ||
+				!frame_latches[frame_id].try_lock_shared()) {
+				continue;
+			}
+
+			bool first = false;
+			frame.tryPin(page_id, first); // Mapped and loaded, and the latch keeps it so
+			if (first) {
+				pinFrame(shard, frame_id);
+			}
+			frame.dirty.store(false, std::memory_order_release);
+			frame_ids.push_back(frame_id);
+		}
 
-		is_dirty[frame_id] = false;
-		pin_count[frame_id] = 0;
+		if (!frame_ids.empty()) {
+			writeFrames(shard, lock, frame_ids);
+		}
+	}
+}
 
-		// The frame is available again for anyone
-		free_list.push_back(frame_id);
+void BufferPoolManager::flushAllPages() {
+	for (auto &shard : shards) {
+		writeBackDirtyPages(*shard);
 	}
 
-	// In a real database, you would call disk manager->allocate Page(page_id)
-	return true;
+	// The writes only reached the OS cache; the policy decides how long to wait for fdatasync
+	disk_manager->awaitDurability();
 }
 
-BufferPoolManager::~BufferPoolManager() {
+size_t BufferPoolManager::prefetchPages(const std::vector<uint32_t> &page_ids) {
+	struct Reserved {
+		uint32_t page_id;
+		uint32_t frame_id;
+		uint32_t victim_id;				 // Evicted from the frame (INVALID_PAGE_ID: none)
+		std::unique_ptr<char[]> staging; // The victim's copy, if it has to be written back
+	};
 
-	for (size_t i = 0; i < pool_size; ++i) {
-		if (is_dirty[i]) {
-			uint32_t p_id = pages[i].getHeader()->page_id;
-			disk_manager->writePage(p_id, pages[i].getRawData());
+	size_t budget = pool_size / 2;
+	std::vector<IORequest> batch;
+	std::vector<Reserved> loaded;
+
+	// STEP 1: Reserve a frame for every page that is not in RAM yet, shard by shard
+	for (uint32_t page_id : page_ids) {
+		if (loaded.size() >= budget)
+			break;
+
+		Shard &shard = shardOf(page_id);
+		std::lock_guard<std::mutex> lock(shard.latch);
+
+		if (shard.page_table.find(page_id) != PageTable::NOT_FOUND || shard.writing.count(page_id) > 0)
+			continue;
+
+		// fetchPageForRead() serves it from the mapping, no need to copy it into a frame
+		if (mmap_reads && disk_manager->getMappedPage(page_id) != nullptr)
+			continue;
+
+		Reserved entry{page_id, 0, INVALID_PAGE_ID, nullptr};
+		if (!acquireFrame(shard, entry.frame_id, entry.staging, entry.victim_id)) {
+			continue; // Everything else in this shard is pinned
+		}
+		if (entry.staging) {
+			batch.push_back({IOOp::WRITE, entry.victim_id, entry.staging.get()});
+		}
+
+		mapFrame(shard, page_id, entry.frame_id, 0, true);
+		batch.push_back({IOOp::READ, page_id, const_cast<char *>(pages[entry.frame_id].getRawData())});
+		loaded.push_back(std::move(entry));
+	}
+
+	// STEP 2: One submission for all of them, without any latch
+	std::exception_ptr failure;
+	try {
+		io_engine->execute(batch);
+	} catch (...) {
+		failure = std::current_exception();
+	}
+
+	// STEP 3: Nobody holds them, so they are eviction candidates like any unpinned page.
+	// The victim of a frame is in the same shard as the page loaded into it
+	for (const Reserved &entry : loaded) {
+		Shard &shard = shardOf(entry.page_id);
+		std::lock_guard<std::mutex> lock(shard.latch);
+		if (failure) {
+			// Which request failed is unknown: every staged victim takes its frame back
+			unmapFrame(shard, entry.page_id, entry.frame_id);
+			if (entry.staging) {
+				restoreVictim(shard, entry.victim_id, entry.frame_id, entry.staging.get());
+			} else {
+				shard.free_list.push_back(entry.frame_id);
+				shard.io_done.notify_all();
+			}
+		} else {
+			// Usable first, then a candidate (the replacer must never hold a frame it can't take)
+			finishLoading(shard, entry.frame_id);
+			shard.unpin(entry.frame_id);
+			if (entry.staging) {
+				finishWriteBack(shard, entry.victim_id);
+			}
 		}
 	}
 
+	if (failure) {
+		std::rethrow_exception(failure);
+	}
+	return loaded.size();
+}
+
+BufferPoolManager::~BufferPoolManager() {
+	// Destructors must not throw; report the failure instead.
+	// Closing always syncs, whatever the durability policy.
+	try {
+		for (auto &shard : shards) {
+			writeBackDirtyPages(*shard);
+		}
+		disk_manager->sync();
+	} catch (const std::exception &e) {
+		LUMINADB_LOG_ERROR("BPM", "Failed to flush pages on shutdown: " << e.what());
+	}
+
 	delete[] pages;
-	delete[] is_dirty;
-	delete[] pin_count;
-	delete replacer;
+	delete[] frames;
+	delete[] frame_latches;
+	delete io_engine;
+}
+
+uint32_t BufferPoolManager::getNextPageId() {
+	std::lock_guard<std::mutex> lock(alloc_latch);
+	return next_page_id;
+}
+
+void BufferPoolManager::setNextPageId(uint32_t page_id) {
+	std::lock_guard<std::mutex> lock(alloc_latch);
+	next_page_id = page_id;
 }
 
-} // namespace LuminaDB
\ No newline at end of file
+} // namespace LuminaDB
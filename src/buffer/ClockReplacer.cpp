@@ -0,0 +1,70 @@
+#include "luminadb/buffer/ClockReplacer.hpp"
+
+namespace LuminaDB {
+ClockReplacer::ClockReplacer(size_t num_frames)
+	: num_frames(num_frames), state(std::make_unique<std::atomic<uint8_t>[]>(num_frames)), hand(0), evictable(0) {
+	for (size_t i = 0; i < num_frames; ++i) {
+		state[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+ClockReplacer::~ClockReplacer() = default;
+
+/**
+ * VICTIM: Turn the hand. A referenced frame gets a second chance (its bit is cleared and
+ * the hand moves on); the first evictable frame without the bit is claimed.
+ * Two laps are enough: the first one clears every bit it passes.
+ */
+bool ClockReplacer::victim(uint32_t *frame_id) {
+	if (num_frames == 0) {
+		return false;
+	}
+
+	for (size_t step = 0; step < 2 * num_frames; ++step) {
+		if (evictable.load(std::memory_order_acquire) == 0) {
+			return false;
+		}
+
+		size_t frame = hand.fetch_add(1, std::memory_order_relaxed) % num_frames;
+		uint8_t current = state[frame].load(std::memory_order_acquire);
+
+		// A pin() or unpin() racing with the CAS makes it fail: look at the frame again next lap
+		while (current & EVICTABLE) {
+			if (current & REFERENCED) {
+				if (state[frame].compare_exchange_weak(current, EVICTABLE, std::memory_order_acq_rel)) {
+					break; // Second chance
+				}
+			} else if (state[frame].compare_exchange_weak(current, 0, std::memory_order_acq_rel)) {
+				evictable.fetch_sub(1, std::memory_order_relaxed);
+				*frame_id = static_cast<uint32_t>(frame);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * PIN: The frame leaves the candidates (its reference bit goes with it).
+ */
+void ClockReplacer::pin(uint32_t frame_id) {
+	uint8_t previous = state[frame_id].exchange(0, std::memory_order_acq_rel);
+	if (previous & EVICTABLE) {
+		evictable.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+/**
+ * UNPIN: The frame becomes a candidate, marked as recently used so the hand spares it once.
+ * Unpinning a frame that already is a candidate only refreshes the bit.
+ */
+void ClockReplacer::unpin(uint32_t frame_id) {
+	uint8_t previous = state[frame_id].fetch_or(EVICTABLE | REFERENCED, std::memory_order_acq_rel);
+	if (!(previous & EVICTABLE)) {
+		evictable.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+size_t ClockReplacer::Size() { return evictable.load(std::memory_order_relaxed); }
+
+} // namespace LuminaDB
@@ -0,0 +1,66 @@
+#include "luminadb/buffer/FrameList.hpp"
+
+namespace LuminaDB {
+FrameList::FrameList(size_t num_frames) : prev(num_frames, NONE), next(num_frames, NONE), head(NONE), tail(NONE), count(0) {}
+
+void FrameList::pushBack(uint32_t frame_id) {
+	prev[frame_id] = tail;
+	next[frame_id] = NONE;
+	if (tail != NONE) {
+		next[tail] = frame_id;
+	} else {
+		head = frame_id;
+	}
+	tail = frame_id;
+	count++;
+}
+
+void FrameList::remove(uint32_t frame_id) {
+	if (prev[frame_id] != NONE) {
+		next[prev[frame_id]] = next[frame_id];
+	} else {
+		head = next[frame_id];
+	}
+	if (next[frame_id] != NONE) {
+		prev[next[frame_id]] = prev[frame_id];
+	} else {
+		tail = prev[frame_id];
+	}
+	prev[frame_id] = NONE;
+	next[frame_id] = NONE;
+	count--;
+}
+
+void FrameList::moveToBack(uint32_t frame_id) {
+	if (frame_id == tail) {
+		return;
+	}
+	remove(frame_id);
+	pushBack(frame_id);
+}
+
+void GhostList::pushBack(uint32_t page_id) {
+	erase(page_id);
+	order.push_back(page_id);
+	index[page_id] = std::prev(order.end());
+}
+
+bool GhostList::erase(uint32_t page_id) {
+	auto found = index.find(page_id);
+	if (found == index.end()) {
+		return false;
+	}
+	order.erase(found->second);
+	index.erase(found);
+	return true;
+}
+
+void GhostList::popFront() {
+	if (order.empty()) {
+		return;
+	}
+	index.erase(order.front());
+	order.pop_front();
+}
+
+} // namespace LuminaDB
@@ -0,0 +1,136 @@
+#include "luminadb/buffer/LRUKReplacer.hpp"
+#include "luminadb/common/types.hpp"
+
+#include <algorithm>
+
+namespace LuminaDB {
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+	: num_frames(num_frames), k(std::max<size_t>(k, 1)), current_time(0),
+	  correlated_period(std::max<size_t>(num_frames / CORRELATED_REFERENCE_DIVISOR, 1)),
+	  frame_page(num_frames, INVALID_PAGE_ID),
+	  stamps(num_frames * this->k, 0), evictable(num_frames, 0), keys(num_frames, 0) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+uint64_t LRUKReplacer::evictionKey(uint32_t frame_id) const {
+	const uint64_t *history = &stamps[frame_id * k];
+	if (history[k - 1] != 0) {
+		return (1ULL << 63) | history[k - 1];
+	}
+
+	// Fewer than k references: the oldest one recorded (0 if never referenced)
+	uint64_t first = 0;
+	for (size_t i = 0; i < k && history[i] != 0; i++) {
+		first = history[i];
+	}
+	return first;
+}
+
+void LRUKReplacer::forget(uint32_t frame_id) {
+	frame_page[frame_id] = INVALID_PAGE_ID;
+	std::fill_n(stamps.begin() + frame_id * k, k, 0);
+}
+
+/**
+ * VICTIM: The evictable frame with the smallest key.
+ * Its page's history is kept aside in case the page is requested again.
+ */
+bool LRUKReplacer::victim(uint32_t *frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (candidates.empty())
+		return false;
+
+	uint32_t victim_id = candidates.begin()->second;
+	candidates.erase(candidates.begin());
+	evictable[victim_id] = 0;
+
+	uint32_t page_id = frame_page[victim_id];
+	if (page_id != INVALID_PAGE_ID) {
+		retained[page_id].assign(stamps.begin() + victim_id * k, stamps.begin() + (victim_id + 1) * k);
+		retained_order.pushBack(page_id);
+		while (retained_order.size() > num_frames) {
+			retained.erase(retained_order.front());
+			retained_order.popFront();
+		}
+	}
+	forget(victim_id);
+
+	*frame_id = victim_id;
+	return true;
+}
+
+void LRUKReplacer::pin(uint32_t frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (evictable[frame_id]) {
+		candidates.erase({keys[frame_id], frame_id});
+		evictable[frame_id] = 0;
+	}
+}
+
+void LRUKReplacer::unpin(uint32_t frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (evictable[frame_id])
+		return;
+
+	evictable[frame_id] = 1;
+	keys[frame_id] = evictionKey(frame_id);
+	candidates.insert({keys[frame_id], frame_id});
+}
+
+size_t LRUKReplacer::Size() {
+	std::lock_guard<std::mutex> lock(latch);
+	return candidates.size();
+}
+
+/**
+ * ACCESS: Shift the frame's history and stamp the new reference, unless it is correlated
+ * to the last one recorded (within correlated_period of it).
+ * A frame that now holds another page starts from that page's retained history, if any.
+ */
+void LRUKReplacer::recordAccess(uint32_t frame_id, uint32_t page_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	uint64_t *history = &stamps[frame_id * k];
+	if (frame_page[frame_id] != page_id) {
+		forget(frame_id);
+		frame_page[frame_id] = page_id;
+
+		auto kept = retained.find(page_id);
+		if (kept != retained.end()) {
+			std::copy(kept->second.begin(), kept->second.end(), history);
+			retained.erase(kept);
+			retained_order.erase(page_id);
+		}
+	}
+
+	// Same burst as the last recorded reference: its place among the candidates doesn't change
+	uint64_t now = ++current_time;
+	if (history[0] != 0 && now - history[0] <= correlated_period) {
+		return;
+	}
+
+	std::copy_backward(history, history + k - 1, history + k);
+	history[0] = now;
+
+	// Usually pinned by now; otherwise its position among the candidates changes
+	if (evictable[frame_id]) {
+		candidates.erase({keys[frame_id], frame_id});
+		keys[frame_id] = evictionKey(frame_id);
+		candidates.insert({keys[frame_id], frame_id});
+	}
+}
+
+void LRUKReplacer::remove(uint32_t frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (evictable[frame_id]) {
+		candidates.erase({keys[frame_id], frame_id});
+		evictable[frame_id] = 0;
+	}
+	forget(frame_id);
+}
+
+} // namespace LuminaDB
@@ -0,0 +1,83 @@
+#include "luminadb/buffer/PageTable.hpp"
+#include "luminadb/common/types.hpp"
+
+#include <stdexcept>
+
+namespace LuminaDB {
+PageTable::PageTable(size_t max_entries) : count(0) {
+	size_t slot_count = 2;
+	while (slot_count < 2 * max_entries) {
+		slot_count *= 2;
+	}
+	entries = std::make_unique<std::atomic<uint64_t>[]>(slot_count);
+	for (size_t i = 0; i < slot_count; i++) {
+		entries[i].store(pack(INVALID_PAGE_ID, 0), std::memory_order_relaxed);
+	}
+	mask = slot_count - 1;
+}
+
+size_t PageTable::home(uint32_t page_id) const {
+	// Fibonacci hashing: the pages of a shard are page_id % shard count apart, this spreads them
+	return static_cast<size_t>((static_cast<uint64_t>(page_id) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+uint32_t PageTable::find(uint32_t page_id) const {
+	// Entries being moved by a concurrent erase() may leave no empty slot on the way: one lap at most
+	size_t i = home(page_id);
+	for (size_t probes = 0; probes <= mask; probes++, i = (i + 1) & mask) {
+		uint64_t entry = entries[i].load(std::memory_order_acquire);
+		if (pageOf(entry) == page_id) {
+			return static_cast<uint32_t>(entry);
+		}
+		if (pageOf(entry) == INVALID_PAGE_ID) {
+			return NOT_FOUND;
+		}
+	}
+	return NOT_FOUND;
+}
+
+void PageTable::insert(uint32_t page_id, uint32_t frame_id) {
+	// Never more pages than frames, so at least half of the slots are free
+	if (count >= (mask + 1) / 2) {
+		throw std::runtime_error("Page table is full");
+	}
+
+	size_t i = home(page_id);
+	while (pageOf(entries[i].load(std::memory_order_relaxed)) != INVALID_PAGE_ID) {
+		i = (i + 1) & mask;
+	}
+	entries[i].store(pack(page_id, frame_id), std::memory_order_release);
+	count++;
+}
+
+bool PageTable::erase(uint32_t page_id) {
+	// STEP 1: Find the entry
+	size_t hole = home(page_id);
+	while (pageOf(entries[hole].load(std::memory_order_relaxed)) != page_id) {
+		if (pageOf(entries[hole].load(std::memory_order_relaxed)) == INVALID_PAGE_ID) {
+			return false;
+		}
+		hole = (hole + 1) & mask;
+	}
+
+	// STEP 2: Move back every later entry of the run that may sit in the hole (its home
+	// does not lie cyclically in (hole, i]), so no probe has to skip over an empty slot
+	for (size_t i = (hole + 1) & mask;; i = (i + 1) & mask) {
+		uint64_t entry = entries[i].load(std::memory_order_relaxed);
+		if (pageOf(entry) == INVALID_PAGE_ID) {
+			break;
+		}
+		size_t wanted = home(pageOf(entry));
+		bool reachable = hole <= i ? (hole < wanted && wanted <= i) : (hole < wanted || wanted <= i);
+		if (!reachable) {
+			entries[hole].store(entry, std::memory_order_release);
+			hole = i;
+		}
+	}
+
+	entries[hole].store(pack(INVALID_PAGE_ID, 0), std::memory_order_release);
+	count--;
+	return true;
+}
+
+} // namespace LuminaDB
@@ -0,0 +1,26 @@
+#include "luminadb/buffer/Replacer.hpp"
+#include "luminadb/buffer/ARCReplacer.hpp"
+#include "luminadb/buffer/ClockReplacer.hpp"
+#include "luminadb/buffer/LRUKReplacer.hpp"
+#include "luminadb/buffer/LRUReplacer.hpp"
+#include "luminadb/buffer/TwoQReplacer.hpp"
+
+namespace LuminaDB {
+
+std::unique_ptr<Replacer> makeReplacer(ReplacerPolicy policy, size_t num_frames) {
+	switch (policy) {
+	case ReplacerPolicy::CLOCK:
+		return std::make_unique<ClockReplacer>(num_frames);
+	case ReplacerPolicy::LRU_K:
+		return std::make_unique<LRUKReplacer>(num_frames);
+	case ReplacerPolicy::TWO_Q:
+		return std::make_unique<TwoQReplacer>(num_frames);
+	case ReplacerPolicy::ARC:
+		return std::make_unique<ARCReplacer>(num_frames);
+	case ReplacerPolicy::LRU:
+	default:
+		return std::make_unique<LRUReplacer>(num_frames);
+	}
+}
+
+} // namespace LuminaDB
@@ -0,0 +1,135 @@
+#include "luminadb/buffer/TwoQReplacer.hpp"
+#include "luminadb/common/types.hpp"
+
+#include <algorithm>
+
+namespace LuminaDB {
+TwoQReplacer::TwoQReplacer(size_t num_frames)
+	: in_target(std::max<size_t>(num_frames / TWO_Q_IN_DIVISOR, 1)),
+	  out_limit(std::max<size_t>(num_frames / TWO_Q_OUT_DIVISOR, 1)), a1in(num_frames), am(num_frames),
+	  queue_of(num_frames, NO_QUEUE), evictable(num_frames, 0), frame_page(num_frames, INVALID_PAGE_ID),
+	  evictable_count(0) {}
+
+TwoQReplacer::~TwoQReplacer() = default;
+
+uint32_t TwoQReplacer::firstEvictable(const FrameList &list) const {
+	uint32_t frame = list.front();
+	while (frame != FrameList::NONE && !evictable[frame]) {
+		frame = list.after(frame);
+	}
+	return frame;
+}
+
+void TwoQReplacer::detach(uint32_t frame_id) {
+	if (queue_of[frame_id] == IN_QUEUE) {
+		a1in.remove(frame_id);
+	} else if (queue_of[frame_id] == MAIN_QUEUE) {
+		am.remove(frame_id);
+	}
+	queue_of[frame_id] = NO_QUEUE;
+}
+
+/**
+ * VICTIM: The head of A1in while it is over its share (its page id moves to A1out),
+ * otherwise the least recently used page of Am. Either queue stands in for the other
+ * when all of its frames are pinned.
+ */
+bool TwoQReplacer::victim(uint32_t *frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (evictable_count == 0)
+		return false;
+
+	uint32_t from_in = firstEvictable(a1in);
+	uint32_t chosen = from_in;
+	if (a1in.size() <= in_target || from_in == FrameList::NONE) {
+		uint32_t from_main = firstEvictable(am);
+		if (from_main != FrameList::NONE) {
+			chosen = from_main;
+		}
+	}
+
+	if (queue_of[chosen] == IN_QUEUE && frame_page[chosen] != INVALID_PAGE_ID) {
+		a1out.pushBack(frame_page[chosen]);
+		while (a1out.size() > out_limit) {
+			a1out.popFront();
+		}
+	}
+
+	detach(chosen);
+	evictable[chosen] = 0;
+	evictable_count--;
+	frame_page[chosen] = INVALID_PAGE_ID;
+
+	*frame_id = chosen;
+	return true;
+}
+
+void TwoQReplacer::pin(uint32_t frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (evictable[frame_id]) {
+		evictable[frame_id] = 0;
+		evictable_count--;
+	}
+}
+
+/**
+ * UNPIN: A frame that was never referenced (prefetched) joins A1in as a new page.
+ */
+void TwoQReplacer::unpin(uint32_t frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (evictable[frame_id])
+		return;
+
+	evictable[frame_id] = 1;
+	evictable_count++;
+	if (queue_of[frame_id] == NO_QUEUE) {
+		a1in.pushBack(frame_id);
+		queue_of[frame_id] = IN_QUEUE;
+	}
+}
+
+size_t TwoQReplacer::Size() {
+	std::lock_guard<std::mutex> lock(latch);
+	return evictable_count;
+}
+
+/**
+ * ACCESS: A page new to the frame goes to Am if A1out remembers it, to A1in otherwise.
+ * A hit moves the page to the back of Am, or leaves it where it is in A1in.
+ */
+void TwoQReplacer::recordAccess(uint32_t frame_id, uint32_t page_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (frame_page[frame_id] == page_id) {
+		if (queue_of[frame_id] == MAIN_QUEUE) {
+			am.moveToBack(frame_id);
+		}
+		return;
+	}
+
+	detach(frame_id);
+	frame_page[frame_id] = page_id;
+	if (a1out.erase(page_id)) {
+		am.pushBack(frame_id);
+		queue_of[frame_id] = MAIN_QUEUE;
+	} else {
+		a1in.pushBack(frame_id);
+		queue_of[frame_id] = IN_QUEUE;
+	}
+}
+
+void TwoQReplacer::remove(uint32_t frame_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	if (evictable[frame_id]) {
+		evictable[frame_id] = 0;
+		evictable_count--;
+	}
+	detach(frame_id);
+	frame_page[frame_id] = INVALID_PAGE_ID;
+}
+
+} // namespace LuminaDB
@@ -0,0 +1,111 @@
+#include "luminadb/common/Log.hpp"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace LuminaDB {
+
+namespace {
+
+std::mutex log_latch;
+
+// Every field is atomic so readers racing with a wrap-around see stale values, not torn ones
+struct TraceSlot {
+	std::atomic<uint64_t> sequence{0}; // sequence + 1 once written, 0 if never used
+	std::atomic<uint64_t> timestamp_ns{0};
+	std::atomic<uint64_t> thread{0};
+	std::atomic<const char *> event{nullptr};
+	std::atomic<uint64_t> a{0};
+	std::atomic<uint64_t> b{0};
+};
+
+TraceSlot trace_slots[TraceBuffer::CAPACITY];
+std::atomic<uint64_t> trace_next{0};
+
+const char *levelTag(LogLevel level) {
+	switch (level) {
+	case LogLevel::WARN:
+		return "WARN ";
+	case LogLevel::ERROR:
+		return "ERROR ";
+	default:
+		return "";
+	}
+}
+
+} // namespace
+
+// --- LOG ---
+
+void Log::write(LogLevel level, const char *component, const std::string &message) {
+	std::lock_guard<std::mutex> lock(log_latch);
+	// std::clog is buffered and '\n' doesn't flush it: logging never waits on the terminal per line
+	std::clog << levelTag(level) << "[" << component << "] " << message << '\n';
+}
+
+// --- TRACE ---
+
+void TraceBuffer::record(const char *event, uint64_t a, uint64_t b) {
+	uint64_t sequence = trace_next.fetch_add(1, std::memory_order_relaxed);
+	TraceSlot &slot = trace_slots[sequence & (CAPACITY - 1)];
+
+	uint64_t now = static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+			.count());
+
+	slot.timestamp_ns.store(now, std::memory_order_relaxed);
+	slot.thread.store(std::hash<std::thread::id>{}(std::this_thread::get_id()), std::memory_order_relaxed);
+	slot.event.store(event, std::memory_order_relaxed);
+	slot.a.store(a, std::memory_order_relaxed);
+	slot.b.store(b, std::memory_order_relaxed);
+	slot.sequence.store(sequence + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> TraceBuffer::snapshot() {
+	uint64_t end = trace_next.load(std::memory_order_acquire);
+	uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+
+	std::vector<TraceEvent> events;
+	events.reserve(static_cast<size_t>(end - begin));
+
+	for (uint64_t sequence = begin; sequence < end; sequence++) {
+		const TraceSlot &slot = trace_slots[sequence & (CAPACITY - 1)];
+
+		// Skip slots not written yet or already reused by a newer event
+		if (slot.sequence.load(std::memory_order_acquire) != sequence + 1) {
+			continue;
+		}
+
+		TraceEvent event;
+		event.sequence = sequence;
+		event.timestamp_ns = slot.timestamp_ns.load(std::memory_order_relaxed);
+		event.thread = slot.thread.load(std::memory_order_relaxed);
+		event.event = slot.event.load(std::memory_order_relaxed);
+		event.a = slot.a.load(std::memory_order_relaxed);
+		event.b = slot.b.load(std::memory_order_relaxed);
+		events.push_back(event);
+	}
+	return events;
+}
+
+void TraceBuffer::dump(std::ostream &out) {
+	std::vector<TraceEvent> events = snapshot();
+	uint64_t start = events.empty() ? 0 : events.front().timestamp_ns;
+
+	for (const TraceEvent &event : events) {
+		int64_t offset_us = (static_cast<int64_t>(event.timestamp_ns) - static_cast<int64_t>(start)) / 1000;
+		out << "#" << event.sequence << " " << offset_us << "us thread=" << std::hex
+			<< (event.thread & 0xFFFF) << std::dec << " " << event.event << " " << event.a << " " << event.b << '\n';
+	}
+}
+
+void TraceBuffer::clear() {
+	for (TraceSlot &slot : trace_slots) {
+		slot.sequence.store(0, std::memory_order_relaxed);
+	}
+	trace_next.store(0, std::memory_order_release);
+}
+
+} // namespace LuminaDB
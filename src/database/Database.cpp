@@ -1,41 +1,314 @@
 #include "luminadb/database/Database.hpp"
-#include <iostream>
+#include "luminadb/common/Log.hpp"
 
 namespace LuminaDB {
 
-Database::Database(const std::string &filename, uint32_t buffer_pool_size)
-	: db_file(filename), next_data_page_id(1000) { // Start data pages at 1000 (B+ Tree uses 0-999)
-	std::cout << "[Database] Initializing with file: " << filename << std::endl;
+template <typename Key>
+BasicDatabase<Key>::BasicDatabase(const std::string &filename, uint32_t buffer_pool_size,
+								  const DurabilityOptions &durability, bool memory_mapped_reads,
+								  ReplacerPolicy replacer_policy)
+	: db_file(filename) {
+	LUMINADB_LOG_INFO("Database", "Initializing with file: " << filename);
 
 	// Step 1: Create DiskManager
-	disk_manager = std::make_unique<DiskManager>(filename);
+	disk_manager = std::make_unique<DiskManager>(filename, durability);
+	bool fresh_file = disk_manager->getExistingPageCount() == 0;
 
 	// Step 2: Create BufferPoolManager
-	buffer_pool_manager = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+	buffer_pool_manager = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(),
+															  memory_mapped_reads, 0, replacer_policy);
 
-	// Step 3: Create B+ Tree index
-	// Root ID = 0 means it will create a new root automatically
-	index = std::make_unique<BPlusTree>(0, buffer_pool_manager.get());
+	// Step 3: Lay out a new file, or open the index and free-space map the superblock points to
+	if (fresh_file) {
+		format();
+	} else {
+		open();
+	}
 
-	std::cout << "[Database] Initialized successfully" << std::endl;
-	std::cout << "[Database] B+ Tree uses pages 0-999, Data uses pages 1000+" << std::endl;
+	LUMINADB_LOG_INFO("Database", "Initialized successfully");
 }
 
-Database::~Database() {
-	std::cout << "[Database] Closing database..." << std::endl;
+template <typename Key>
+BasicDatabase<Key>::~BasicDatabase() {
+	LUMINADB_LOG_INFO("Database", "Closing database...");
+	try {
+		freePendingIndexPages();
+		persistFreeSpaceMap();
+		persistSuperblock();
+	} catch (const std::exception &e) {
+		LUMINADB_LOG_ERROR("Database", "Failed to save metadata: " << e.what());
+	}
+
+	// The trees give their hot pages back to the pool first, while it is still there
+	secondary_indexes.clear();
+	index.reset();
+
 	// BufferPool destructor flushes all dirty pages
 	buffer_pool_manager.reset();
 	disk_manager.reset();
-	std::cout << "[Database] Closed" << std::endl;
+	LUMINADB_LOG_INFO("Database", "Closed");
 }
 
-uint32_t Database::allocateDataPage() {
-	uint32_t page_id = next_data_page_id++;
-	std::cout << "[Database] Allocated data page: " << page_id << std::endl;
-	return page_id;
+template <typename Key>
+void BasicDatabase<Key>::commit() {
+	freePendingIndexPages();
+	persistFreeSpaceMap();
+	persistSuperblock();
+	buffer_pool_manager->flushAllPages();
+}
+
+template <typename Key>
+void BasicDatabase<Key>::freePendingIndexPages() {
+	index->freePendingPages();
+	for (const auto &secondary : secondary_indexes) {
+		secondary->freePendingPages();
+	}
 }
 
-RecordID Database::storeObject(const Storable &obj) {
+template <typename Key>
+void BasicDatabase<Key>::format() {
+	// STEP 1: Reserve page 0 for the superblock
+	uint32_t page_id;
+	Page *page = buffer_pool_manager->newPage(page_id, ModelType::SUPERBLOCK);
+	if (page == nullptr || page_id != SUPERBLOCK_PAGE_ID) {
+		throw std::runtime_error("Failed to allocate superblock page");
+	}
+	buffer_pool_manager->unpinPage(page_id, true);
+	superblock.format();
+
+	// STEP 2: Empty primary index
+	index = std::make_unique<Index>(INVALID_PAGE_ID, buffer_pool_manager.get());
+	superblock.setIndexRoot(PRIMARY_INDEX, index->getRootPageId(), KeyTraits<Key>::TYPE_ID);
+
+	// STEP 3: Empty free-space map
+	page = buffer_pool_manager->newPage(page_id, ModelType::FREE_SPACE_MAP);
+	if (page == nullptr) {
+		throw std::runtime_error("Failed to allocate free-space map page");
+	}
+	FreeSpaceMap::serializePage(page, nullptr, 0, INVALID_PAGE_ID);
+	buffer_pool_manager->unpinPage(page_id, true);
+	superblock.setFsmPageId(page_id);
+	fsm_pages = {page_id};
+
+	// STEP 4: Make the layout reachable
+	persistSuperblock();
+	LUMINADB_LOG_INFO("Database", "Created new database (format version " << SUPERBLOCK_VERSION << ")");
+}
+
+template <typename Key>
+void BasicDatabase<Key>::open() {
+	// STEP 1: Read and validate the superblock (throws if this is not a LuminaDB file of this version)
+	Page *page = buffer_pool_manager->fetchPage(SUPERBLOCK_PAGE_ID);
+	if (page == nullptr) {
+		throw std::runtime_error("Failed to read superblock");
+	}
+	try {
+		superblock.load(page);
+	} catch (...) {
+		buffer_pool_manager->unpinPage(SUPERBLOCK_PAGE_ID, false);
+		throw;
+	}
+	buffer_pool_manager->unpinPage(SUPERBLOCK_PAGE_ID, false);
+
+	// STEP 2: Resume the allocator where it stopped
+	buffer_pool_manager->setNextPageId(superblock.getNextPageId());
+	buffer_pool_manager->setFreePageHead(superblock.getFreeListHead());
+
+	// STEP 3: Primary index
+	uint32_t root_page_id = superblock.getIndexRoot(PRIMARY_INDEX);
+	if (root_page_id == INVALID_PAGE_ID) {
+		throw std::runtime_error("Corrupted superblock: no primary index in the catalog");
+	}
+
+	// The pages only make sense read with the key type they were written with
+	uint32_t key_type = superblock.getIndexKeyType(PRIMARY_INDEX);
+	if (key_type != KeyTraits<Key>::TYPE_ID) {
+		throw std::runtime_error("Primary index was created with key type " + std::to_string(key_type) +
+								 ", cannot open it with key type " + std::to_string(KeyTraits<Key>::TYPE_ID));
+	}
+	index = std::make_unique<Index>(root_page_id, buffer_pool_manager.get());
+
+	// Secondary indexes are reopened when createIndex() declares them again
+	undeclared_indexes = superblock.getCatalog().size() - 1;
+
+	// STEP 4: Free-space map, page by page along its chain
+	uint32_t fsm_page_id = superblock.getFsmPageId();
+	while (fsm_page_id != INVALID_PAGE_ID) {
+		// A chain longer than the file is a cycle
+		if (fsm_pages.size() >= superblock.getNextPageId()) {
+			throw std::runtime_error("Corrupted free-space map: its chain loops");
+		}
+		page = buffer_pool_manager->fetchPage(fsm_page_id);
+		if (page == nullptr || page->getHeader()->object_type != static_cast<uint32_t>(ModelType::FREE_SPACE_MAP)) {
+			if (page != nullptr) {
+				buffer_pool_manager->unpinPage(fsm_page_id, false);
+			}
+			throw std::runtime_error("Corrupted superblock: free-space map page " + std::to_string(fsm_page_id) +
+									 " is invalid");
+		}
+		fsm_pages.push_back(fsm_page_id);
+		uint32_t next_page_id = free_space_map.deserializePage(page);
+		buffer_pool_manager->unpinPage(fsm_page_id, false);
+		fsm_page_id = next_page_id;
+	}
+	if (fsm_pages.empty()) {
+		throw std::runtime_error("Corrupted superblock: no free-space map page");
+	}
+
+	LUMINADB_LOG_INFO("Database", "Opened: root page " << root_page_id << ", next page " << superblock.getNextPageId());
+}
+
+template <typename Key>
+void BasicDatabase<Key>::persistSuperblock() {
+	std::lock_guard<std::mutex> lock(meta_latch);
+	persistSuperblockLocked();
+}
+
+template <typename Key>
+void BasicDatabase<Key>::persistSuperblockLocked() {
+	superblock.setNextPageId(buffer_pool_manager->getNextPageId());
+	superblock.setFreeListHead(buffer_pool_manager->getFreePageHead());
+	superblock.setIndexRoot(PRIMARY_INDEX, index->getRootPageId(), KeyTraits<Key>::TYPE_ID);
+	for (const auto &secondary : secondary_indexes) {
+		superblock.setIndexRoot(secondary->getName(), secondary->getRootPageId(), secondary->getKeyType());
+	}
+
+	Page *page = buffer_pool_manager->fetchPage(SUPERBLOCK_PAGE_ID);
+	if (page == nullptr) {
+		throw std::runtime_error("Failed to write superblock");
+	}
+	buffer_pool_manager->latchPage(page, true);
+	superblock.store(page);
+	buffer_pool_manager->unlatchPage(page, true);
+	buffer_pool_manager->unpinPage(SUPERBLOCK_PAGE_ID, true);
+}
+
+template <typename Key>
+void BasicDatabase<Key>::syncCatalog() {
+	std::lock_guard<std::mutex> lock(meta_latch);
+	bool moved = index->getRootPageId() != superblock.getIndexRoot(PRIMARY_INDEX);
+	for (const auto &secondary : secondary_indexes) {
+		moved = moved || secondary->getRootPageId() != superblock.getIndexRoot(secondary->getName());
+	}
+
+	if (moved) {
+		persistSuperblockLocked();
+	}
+}
+
+template <typename Key>
+void BasicDatabase<Key>::checkWritable() const {
+	if (undeclared_indexes > 0) {
+		throw std::runtime_error("Declare every secondary index of " + db_file + " with createIndex() before writing");
+	}
+}
+
+template <typename Key>
+SecondaryIndexBase *BasicDatabase<Key>::findSecondaryIndex(const std::string &name) const {
+	for (const auto &secondary : secondary_indexes) {
+		if (secondary->getName() == name) {
+			return secondary.get();
+		}
+	}
+	return nullptr;
+}
+
+template <typename Key>
+void BasicDatabase<Key>::indexObject(const Storable &obj, const RecordID &record_id) {
+	for (const auto &secondary : secondary_indexes) {
+		if (secondary->getModelType() == obj.getType()) {
+			secondary->insert(obj, record_id);
+		}
+	}
+}
+
+template <typename Key>
+void BasicDatabase<Key>::unindexObject(const RecordID &record_id) {
+	if (secondary_indexes.empty()) {
+		return;
+	}
+
+	const Page *page = buffer_pool_manager->fetchPageForRead(record_id.page_id);
+	if (page == nullptr) {
+		throw std::runtime_error("Data page not found: " + std::to_string(record_id.page_id));
+	}
+
+	// Copy the record out: the index pages must not be latched under the data page's latch
+	buffer_pool_manager->latchPage(page, false);
+	uint16_t data_size = 0;
+	const char *page_data = page->getRecord(record_id.slot_num, data_size);
+	std::vector<char> record;
+	if (page_data != nullptr) {
+		record.assign(page_data, page_data + data_size);
+	}
+	ModelType type = static_cast<ModelType>(page->getHeader()->object_type);
+	buffer_pool_manager->unlatchPage(page, false);
+	buffer_pool_manager->unpinPageForRead(record_id.page_id, page);
+
+	if (record.empty()) {
+		throw std::runtime_error("Record slot not found in page: " + std::to_string(record_id.page_id));
+	}
+
+	for (const auto &secondary : secondary_indexes) {
+		if (secondary->getModelType() == type) {
+			secondary->remove(record.data(), record_id);
+		}
+	}
+}
+
+template <typename Key>
+void BasicDatabase<Key>::persistFreeSpaceMap() {
+	std::lock_guard<std::mutex> lock(meta_latch);
+	std::vector<FreeSpaceEntry> entries = free_space_map.snapshot();
+	size_t needed = std::max<size_t>(1, (entries.size() + FreeSpaceMap::ENTRIES_PER_PAGE - 1) /
+											FreeSpaceMap::ENTRIES_PER_PAGE);
+
+	// STEP 1: Grow the chain (the first page never changes, so the superblock keeps pointing to it)
+	while (fsm_pages.size() < needed) {
+		uint32_t page_id;
+		Page *page = buffer_pool_manager->newPage(page_id, ModelType::FREE_SPACE_MAP);
+		if (page == nullptr) {
+			throw std::runtime_error("Failed to allocate free-space map page");
+		}
+		buffer_pool_manager->unpinPage(page_id, true);
+		fsm_pages.push_back(page_id);
+	}
+
+	// STEP 2: Write the pages, the last one ending the chain
+	for (size_t i = 0; i < needed; i++) {
+		size_t first = i * FreeSpaceMap::ENTRIES_PER_PAGE;
+		size_t count = std::min(entries.size() - std::min(first, entries.size()), FreeSpaceMap::ENTRIES_PER_PAGE);
+		uint32_t next_page_id = i + 1 < needed ? fsm_pages[i + 1] : INVALID_PAGE_ID;
+
+		Page *page = buffer_pool_manager->fetchPage(fsm_pages[i]);
+		if (page == nullptr) {
+			throw std::runtime_error("Failed to write free-space map page");
+		}
+		buffer_pool_manager->latchPage(page, true);
+		FreeSpaceMap::serializePage(page, entries.data() + first, count, next_page_id);
+		buffer_pool_manager->unlatchPage(page, true);
+		buffer_pool_manager->unpinPage(fsm_pages[i], true);
+	}
+
+	// STEP 3: Free the pages the chain no longer reaches; one still pinned is retried next time
+	while (fsm_pages.size() > needed && buffer_pool_manager->deletePage(fsm_pages.back())) {
+		fsm_pages.pop_back();
+	}
+}
+
+template <typename Key>
+Page *BasicDatabase<Key>::allocateDataPage(ModelType type, uint32_t &page_id) {
+	Page *page = buffer_pool_manager->newPage(page_id, type);
+	if (page != nullptr) {
+		buffer_pool_manager->latchPage(page, true);
+		LUMINADB_LOG_DEBUG("Database", "Allocated data page: " << page_id);
+		LUMINADB_TRACE("data_page_alloc", page_id, static_cast<uint32_t>(type));
+	}
+	return page;
+}
+
+template <typename Key>
+RecordID BasicDatabase<Key>::storeObject(const Storable &obj) {
 	// Step 1: Get serialized size and allocate buffer
 	size_t serialized_size = obj.getSerializedSize();
 	std::vector<char> buffer(serialized_size);
@@ -43,53 +316,143 @@ RecordID Database::storeObject(const Storable &obj) {
 	// Step 2: Serialize the object to buffer
 	obj.serializeToBuffer(buffer.data());
 
-	// Step 3: Allocate a new data page for this object
-	uint32_t page_id = allocateDataPage();
-	Page *page = buffer_pool_manager->newPage(page_id, obj.getType());
+	uint16_t record_size = static_cast<uint16_t>(serialized_size);
+	uint16_t needed = static_cast<uint16_t>(record_size + sizeof(Slot));
+	ModelType type = obj.getType();
 
-	if (page == nullptr) {
-		throw std::runtime_error("Failed to allocate data page");
+	// Step 3: Reuse a page of the same type that still has room (free-space map)
+	uint32_t page_id = free_space_map.findPage(type, needed);
+	uint16_t slot_num = 0;
+	Page *page = nullptr;
+
+	if (page_id != INVALID_PAGE_ID) {
+		page = buffer_pool_manager->fetchPage(page_id);
+		if (page != nullptr) {
+			buffer_pool_manager->latchPage(page, true);
+		}
+
+		// The map is a hint: re-check the page and correct it if it was wrong. A page of another
+		// type (e.g. one being freed right now, or already reused by an index) is dropped from
+		// the map; B+Tree nodes keep their own ModelType there, so they never pass for data
+		bool same_type = page != nullptr && page->getHeader()->object_type == static_cast<uint32_t>(type);
+		if (same_type && page->insertRecord(buffer.data(), record_size, slot_num)) {
+			free_space_map.update(type, page_id, page->getFreeSpace());
+		} else {
+			if (same_type) {
+				free_space_map.update(type, page_id, page->getFreeSpace());
+			} else {
+				free_space_map.remove(page_id);
+			}
+			if (page != nullptr) {
+				buffer_pool_manager->unlatchPage(page, true);
+				buffer_pool_manager->unpinPage(page_id, false);
+			}
+			page = nullptr;
+		}
 	}
 
-	// Step 4: Insert serialized data using the slotted-page API
-	if (!page->insertRecord(buffer.data(), static_cast<uint16_t>(serialized_size))) {
-		buffer_pool_manager->unpinPage(page_id, false);
-		throw std::runtime_error("Failed to insert record into page (size exceeds capacity)");
+	// Step 4: No page with room, allocate a new one
+	if (page == nullptr) {
+		page = allocateDataPage(type, page_id);
+
+		if (page == nullptr) {
+			throw std::runtime_error("Failed to allocate data page");
+		}
+
+		// Insert serialized data using the slotted-page API
+		if (!page->insertRecord(buffer.data(), record_size, slot_num)) {
+			buffer_pool_manager->unlatchPage(page, true);
+			buffer_pool_manager->unpinPage(page_id, false);
+			throw std::runtime_error("Failed to insert record into page (size exceeds capacity)");
+		}
+		free_space_map.update(type, page_id, page->getFreeSpace());
 	}
 
 	// Step 5: Build RecordID (slot_num stores the slot index)
 	RecordID result{};
 	result.page_id = page_id;
-	result.slot_num = static_cast<uint16_t>(page->getHeader()->slot_count - 1);
+	result.slot_num = slot_num;
 
+	buffer_pool_manager->unlatchPage(page, true);
 	buffer_pool_manager->unpinPage(page_id, true);
 
 	return result;
 }
 
-std::vector<char> Database::retrieveObjectBuffer(const RecordID &record_id) {
-	// Step 1: Fetch the data page
-	Page *page = buffer_pool_manager->fetchPage(record_id.page_id);
+template <typename Key>
+bool BasicDatabase<Key>::remove(const Key &key) {
+	checkWritable();
+
+	// Step 1: Unlink the record from the index first, so the key never points to a freed slot.
+	// Its RecordID comes from the entry actually removed: a separate lookup could race with
+	// another remove + insert of the key and name a record this call doesn't own
+	RecordID record_id;
+	if (!index->remove(key, &record_id)) {
+		return false;
+	}
+
+	// Step 2: Then from the secondary indexes, while the record is still there to say which entries are its own
+	unindexObject(record_id);
+	syncCatalog();
 
+	// Step 3: Reclaim its space once no find/rangeScan can still be holding its RecordID
+	std::unique_lock<std::shared_mutex> reclaim_lock(reclaim_latch);
+	releaseObject(record_id);
+	return true;
+}
+
+template <typename Key>
+void BasicDatabase<Key>::releaseObject(const RecordID &record_id) {
+	Page *page = buffer_pool_manager->fetchPage(record_id.page_id);
 	if (page == nullptr) {
 		throw std::runtime_error("Data page not found: " + std::to_string(record_id.page_id));
 	}
 
-	// Step 2: Read serialized data from the stored slot
-	uint16_t data_size = 0;
-	const char *page_data = page->getRecord(record_id.slot_num, data_size);
+	buffer_pool_manager->latchPage(page, true);
+	page->deleteRecord(record_id.slot_num);
+	ModelType type = static_cast<ModelType>(page->getHeader()->object_type);
 
-	if (page_data == nullptr) {
-		buffer_pool_manager->unpinPage(record_id.page_id, false);
-		throw std::runtime_error("Record slot not found in page: " + std::to_string(record_id.page_id));
+	if (page->getLiveCount() > 0) {
+		// Still in use: the freed bytes are available to the next insert of this type
+		free_space_map.update(type, record_id.page_id, page->getFreeSpace());
+		buffer_pool_manager->unlatchPage(page, true);
+		buffer_pool_manager->unpinPage(record_id.page_id, true);
+		return;
 	}
 
-	// Step 3: Copy data to result buffer
-	std::vector<char> result(page_data, page_data + data_size);
+	// Empty: claim it before letting go of the latch. An insert that got the page from the
+	// map a moment ago sees the type change and looks elsewhere
+	free_space_map.remove(record_id.page_id);
+	page->getHeader()->object_type = static_cast<uint32_t>(ModelType::FREE_PAGE);
+	buffer_pool_manager->unlatchPage(page, true);
+	buffer_pool_manager->unpinPage(record_id.page_id, true);
 
-	buffer_pool_manager->unpinPage(record_id.page_id, false);
+	// Hand the page back to the allocator
+	if (buffer_pool_manager->deletePage(record_id.page_id)) {
+		LUMINADB_LOG_DEBUG("Database", "Freed data page: " << record_id.page_id);
+		LUMINADB_TRACE("data_page_free", record_id.page_id, static_cast<uint32_t>(type));
+		return;
+	}
 
-	return result;
+	// Still pinned (e.g. by that insert, which drops it from the map under the latch): it would be
+	// in neither the map nor the free list, so it goes back to the map as an empty page of its type
+	page = buffer_pool_manager->fetchPage(record_id.page_id);
+	if (page == nullptr) {
+		throw std::runtime_error("Data page not found: " + std::to_string(record_id.page_id));
+	}
+	buffer_pool_manager->latchPage(page, true);
+	page->getHeader()->object_type = static_cast<uint32_t>(type);
+	free_space_map.update(type, record_id.page_id, page->getFreeSpace());
+	buffer_pool_manager->unlatchPage(page, true);
+	buffer_pool_manager->unpinPage(record_id.page_id, true);
+	LUMINADB_LOG_WARN("Database", "Data page " << record_id.page_id << " is pinned, kept for reuse instead of freed");
 }
 
+// --- INSTANTIATIONS ---
+
+template class BasicDatabase<uint32_t>;
+template class BasicDatabase<uint64_t>;
+template class BasicDatabase<SensorKey>;
+template class BasicDatabase<StringKey32>;
+
 } // namespace LuminaDB
@@ -1,159 +1,321 @@
 #include "luminadb/index/BPlusTree.hpp"
-#include <iostream>
+#include "luminadb/common/Log.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
 
 namespace LuminaDB {
 
-BPlusTree::BPlusTree(uint32_t root_id, BufferPoolManager *bpm_param) : root_page_id(root_id), bpm(bpm_param) {
+template <typename Key, typename Compare>
+BPlusTree<Key, Compare>::BPlusTree(uint32_t root_id, BufferPoolManager *bpm_param, IndexMode index_mode)
+	: root_page_id(root_id), bpm(bpm_param), mode(index_mode), tail_leaf_id(INVALID_PAGE_ID),
+	  hot_pages(bpm_param, std::min(HOT_PAGE_LIMIT, bpm_param->getPoolSize() / HOT_POOL_DIVISOR)) {
 
-	// If root_id is 0, try to load existing root from disk page 0, or create new one
-	if (root_page_id == 0) {
-		// First try to fetch page 0 from disk (if it exists and has data)
-		Page *existing_page = bpm->fetchPage(0);
+	if (mode == IndexMode::NON_UNIQUE) {
+		postings = std::make_unique<PostingStore>(bpm);
+	}
 
-		bool valid_root = false;
-		if (existing_page != nullptr) {
-			BPlusTreePage base(const_cast<char *>(existing_page->getRawData()));
-			const BPlusTreeHeader *hdr = base.getHeader();
+	// The root comes from the catalog; only an index without one gets a fresh, empty leaf
+	if (root_page_id == INVALID_PAGE_ID) {
+		uint32_t new_id;
+		Page *page = bpm->newPage(new_id, ModelType::B_PLUS_TREE);
 
-			// Validate header to ensure it's a real B+Tree page
-			if (hdr->page_id == 0 &&
-				(hdr->page_type == IndexPageType::LEAF_NODE || hdr->page_type == IndexPageType::INTERNAL_NODE) &&
-				hdr->max_size > 0 && hdr->max_size <= 2000 && hdr->current_size <= hdr->max_size) {
-				valid_root = true;
-			}
+		if (page == nullptr) {
+			throw std::runtime_error("Failed to allocate B+ Tree root page");
 		}
 
-		if (valid_root) {
-			root_page_id = 0;
-			std::cout << "B+ Tree Root loaded from existing Page: 0" << std::endl;
-			bpm->unpinPage(0, false);
-		} else {
-			if (existing_page != nullptr) {
-				bpm->unpinPage(0, false);
-			}
-			// Page 0 invalid or missing - create new root
-			uint32_t new_id;
-			Page *page = bpm->newPage(new_id, ModelType::B_PLUS_TREE);
-
-			if (page != nullptr) {
-				root_page_id = new_id;
+		root_page_id = new_id;
 
-				char *raw_data = const_cast<char *>(page->getRawData());
-				BPlusTreeLeafPage leaf(raw_data);
-				leaf.init(IndexPageType::LEAF_NODE, 0, 250);
-				leaf.getHeader()->page_id = root_page_id;
+		char *raw_data = const_cast<char *>(page->getRawData());
+		LeafPage leaf(raw_data);
+		leaf.init();
+		leaf.getHeader()->page_id = root_page_id;
 
-				bpm->unpinPage(root_page_id, true);
-				std::cout << "B+ Tree Root created at Page: " << root_page_id << std::endl;
-			}
-		}
+		bpm->unpinPage(root_page_id, true);
+		LUMINADB_LOG_INFO("BPlusTree", "Root created at Page: " << root_page_id);
 	}
 }
 
-bool BPlusTree::getValue(uint32_t key, RecordID &result) {
-	Page *page = findLeafPage(key);
+template <typename Key, typename Compare>
+uint32_t BPlusTree<Key, Compare>::getRootPageId() const { return root_page_id.load(); }
+
+template <typename Key, typename Compare>
+IndexMode BPlusTree<Key, Compare>::getMode() const { return mode; }
+
+template <typename Key, typename Compare>
+bool BPlusTree<Key, Compare>::getValue(const Key &key, RecordID &result) {
+	const Page *page = findLeafPageForRead(key);
 
 	if (page == nullptr)
 		return false;
 
 	// Interpret the page as a sheet
-	BPlusTreeLeafPage leaf(const_cast<char *>(page->getRawData()));
+	uint32_t leaf_id = page->getPageId();
+	LeafPage leaf(const_cast<char *>(page->getRawData()));
 
 	int index = leaf.lookup(key);
 
 	bool found = false;
-	if (index < static_cast<int>(leaf.getSize()) && leaf.keyAt(index) == key) {
+	if (index < static_cast<int>(leaf.getSize()) && LeafPage::keysEqual(leaf.keyAt(index), key)) {
 		result = leaf.valueAt(index);
 		found = true;
 	}
 
+	// A duplicate key: its first value (the list can't change while the leaf is latched)
+	if (found && isPostingList(result)) {
+		std::vector<RecordID> values;
+		try {
+			postings->read(result, values);
+		} catch (...) {
+			bpm->unlatchPage(page, false);
+			bpm->unpinPageForRead(leaf_id, page);
+			throw;
+		}
+		result = values.front();
+	}
+
 	// Release the page (it is not dirty because it was only read)
-	bpm->unpinPage(page->getPageId(), false);
+	bpm->unlatchPage(page, false);
+	bpm->unpinPageForRead(leaf_id, page);
 
 	return found;
 }
 
-void BPlusTree::insert(uint32_t key, const RecordID &value) {
-	Page *page = findLeafPage(key);
+template <typename Key, typename Compare>
+size_t BPlusTree<Key, Compare>::getValues(const Key &key, std::vector<RecordID> &out) {
+	const Page *page = findLeafPageForRead(key);
+
 	if (page == nullptr)
-		return;
+		return 0;
 
-	BPlusTreeLeafPage leaf(const_cast<char *>(page->getRawData()));
+	uint32_t leaf_id = page->getPageId();
+	LeafPage leaf(const_cast<char *>(page->getRawData()));
 
-	bool success = leaf.insert(key, value);
+	int index = leaf.lookup(key);
+	size_t before = out.size();
 
-	if (!success) {
-		// Leaf is full, need to split
-		// Get the page_id from the B+Tree header (not from Page object)
-		uint32_t leaf_id = leaf.getHeader()->page_id;
+	try {
+		if (index < static_cast<int>(leaf.getSize()) && LeafPage::keysEqual(leaf.keyAt(index), key)) {
+			expandValue(leaf.valueAt(index), out);
+		}
+	} catch (...) {
+		bpm->unlatchPage(page, false);
+		bpm->unpinPageForRead(leaf_id, page);
+		throw;
+	}
 
-		// Perform the split
-		SplitResult split_result = leaf.split(key, value, bpm);
+	bpm->unlatchPage(page, false);
+	bpm->unpinPageForRead(leaf_id, page);
 
-		// Mark leaf as dirty before unpinning (split modified it)
-		bpm->unpinPage(leaf_id, true);
+	return out.size() - before;
+}
 
-		// Propagate the split to the parent
-		insertIntoParent(leaf_id, split_result.middle_key, split_result.new_page_id);
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::expandValue(const RecordID &value, std::vector<RecordID> &out) {
+	if (isPostingList(value)) {
+		postings->read(value, out);
 	} else {
-		// Insert was successful, just mark as dirty and release
-		// Get page_id from B+Tree header
-		uint32_t leaf_id = leaf.getHeader()->page_id;
-		bpm->unpinPage(leaf_id, true);
+		out.push_back(value);
 	}
 }
 
-// --- PROPAGATION METHODS ---
+template <typename Key, typename Compare>
+bool BPlusTree<Key, Compare>::appendToTail(const Key &key, const RecordID &value) {
+	uint32_t leaf_id = tail_leaf_id.load();
+	if (leaf_id == INVALID_PAGE_ID) {
+		return false;
+	}
+
+	// The root latch keeps bulkLoad out, as for a descent
+	std::shared_lock<std::shared_mutex> root_lock(root_latch);
+	Page *page = bpm->fetchPage(leaf_id);
+	if (page == nullptr) {
+		return false;
+	}
+	bpm->latchPage(page, true);
+	root_lock.unlock();
+
+	// Still the tail once latched: then it is still a leaf of this tree, and the last one
+	LeafPage leaf(const_cast<char *>(page->getRawData()));
+	bool is_tail = tail_leaf_id.load() == leaf_id && leaf.isLeaf() && leaf.getNextPageId() == 0;
+	bool past_end = is_tail && leaf.getSize() > 0 && Compare{}(leaf.keyAt(leaf.getSize() - 1), key);
+
+	if (is_tail && !past_end) {
+		tail_leaf_id.compare_exchange_strong(leaf_id, INVALID_PAGE_ID);
+	}
+
+	// A full tail is left to the regular path, whose split makes the new sibling the tail
+	bool appended = past_end && leaf.canInsert(key) && leaf.insert(key, value);
 
-void BPlusTree::insertIntoParent(uint32_t left_child_id, uint32_t key, uint32_t right_child_id) {
-	std::cout << "\n[insertIntoParent] Inserting key=" << key << " with right_child=" << right_child_id
-			  << " from left_child=" << left_child_id << std::endl;
+	bpm->unlatchPage(page, true);
+	bpm->unpinPage(leaf_id, appended);
+	return appended;
+}
+
+template <typename Key, typename Compare>
+bool BPlusTree<Key, Compare>::addValue(LeafPage &leaf, int index, const RecordID &value) {
+	if (mode == IndexMode::UNIQUE) {
+		return false;
+	}
+
+	// The second value of a key turns its entry into a posting list; the list may move as it grows
+	RecordID current = leaf.valueAt(index);
+	RecordID list = isPostingList(current) ? postings->append(current, value) : postings->create(current, value);
+	leaf.setValueAt(index, list);
+	return true;
+}
+
+template <typename Key, typename Compare>
+typename BPlusTree<Key, Compare>::ValueRemoval BPlusTree<Key, Compare>::removeValue(LeafPage &leaf, int index,
+																				 const RecordID &value) {
+	RecordID current = leaf.valueAt(index);
 
-	// STEP 1: Fetch the left child to get its parent ID
-	Page *left_child_page = bpm->fetchPage(left_child_id);
-	BPlusTreePage left_child_base(const_cast<char *>(left_child_page->getRawData()));
-	uint32_t parent_id = left_child_base.getHeader()->parent_page_id;
+	if (!isPostingList(current)) {
+		bool same = current.page_id == value.page_id && current.slot_num == value.slot_num;
+		return same ? ValueRemoval::LAST_VALUE : ValueRemoval::NOT_FOUND;
+	}
 
-	bpm->unpinPage(left_child_id, false);
+	// Down to one value, the list is gone and the value goes back into the leaf
+	if (!postings->remove(current, value)) {
+		return ValueRemoval::NOT_FOUND;
+	}
+	leaf.setValueAt(index, current);
+	return ValueRemoval::REMOVED;
+}
 
-	// STEP 2: Special case - if left_child is the root, create a new root
+template <typename Key, typename Compare>
+bool BPlusTree<Key, Compare>::insert(const Key &key, const RecordID &value) {
+	// STEP 1: Increasing keys go straight to the rightmost leaf
+	if (appendToTail(key, value)) {
+		return true;
+	}
+
+	// STEP 2: Optimistic pass, latching only the leaf exclusively. Most inserts find room there,
+	// and a key that is already in the leaf needs none (rejected, or one more value for NON_UNIQUE)
+	Page *page = findLeafOptimistic(key, Operation::UPDATE);
+	{
+		LeafPage leaf(const_cast<char *>(page->getRawData()));
+		uint32_t leaf_id = leaf.getHeader()->page_id;
+
+		int index = leaf.lookup(key);
+		bool present = index < static_cast<int>(leaf.getSize()) && LeafPage::keysEqual(leaf.keyAt(index), key);
+
+		if (present || leaf.canInsert(key)) {
+			bool inserted = false;
+			try {
+				inserted = present ? addValue(leaf, index, value) : leaf.insert(key, value);
+			} catch (...) {
+				bpm->unlatchPage(page, true);
+				bpm->unpinPage(leaf_id, true);
+				throw;
+			}
+
+			// Appended to the last leaf: the next key probably goes there too
+			if (!present && inserted && leaf.getNextPageId() == 0 && index == static_cast<int>(leaf.getSize()) - 1) {
+				tail_leaf_id = leaf_id;
+			}
+
+			bpm->unlatchPage(page, true);
+			bpm->unpinPage(leaf_id, inserted);
+			return inserted;
+		}
+
+		bpm->unlatchPage(page, true);
+		bpm->unpinPage(leaf_id, false);
+	}
+
+	// STEP 3: The leaf is full: descend again holding exclusive latches on every node that may split
+	std::unique_lock<std::shared_mutex> root_lock(root_latch, std::defer_lock);
+	std::vector<Page *> path;
+	page = findLeafPessimistic(key, Operation::INSERT, path, root_lock);
+
+	try {
+		LeafPage leaf(const_cast<char *>(page->getRawData()));
+		uint32_t leaf_id = leaf.getHeader()->page_id;
+
+		// A duplicate must not split the leaf
+		int index = leaf.lookup(key);
+		if (index < static_cast<int>(leaf.getSize()) && LeafPage::keysEqual(leaf.keyAt(index), key)) {
+			bool added = addValue(leaf, index, value);
+			releasePath(path, added);
+			return added;
+		}
+
+		bool appending = leaf.getNextPageId() == 0 && index == static_cast<int>(leaf.getSize());
+		if (!leaf.insert(key, value)) {
+			// Perform the split and propagate it to the parent.
+			// Every page it touches above the leaf is still latched in 'path'
+			SplitResult<Key> split_result = leaf.split(key, value, bpm);
+			insertIntoParent(path, path.size() - 1, split_result.middle_key, split_result.new_page_id);
+
+			// The new sibling is the last leaf now; until then the old tail is still the leaf we hold
+			if (appending) {
+				tail_leaf_id = split_result.new_page_id;
+			}
+		} else if (appending) {
+			tail_leaf_id = leaf_id;
+		}
+	} catch (...) {
+		releasePath(path, true);
+		throw;
+	}
+
+	releasePath(path, true);
+	return true;
+}
+
+// --- PROPAGATION METHODS ---
+
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::insertIntoParent(std::vector<Page *> &path, size_t depth, const Key &key,
+											   uint32_t right_child_id) {
+	uint32_t left_child_id = path[depth]->getPageId();
+	LUMINADB_LOG_DEBUG("insertIntoParent", "Inserting key=" << key << " with right_child=" << right_child_id
+															<< " from left_child=" << left_child_id);
+
+	// STEP 1: Special case - if left_child is the root, create a new root
 	if (left_child_id == root_page_id) {
-		std::cout << "[insertIntoParent] Left child is root, creating new root" << std::endl;
+		LUMINADB_LOG_DEBUG("insertIntoParent", "Left child is root, creating new root");
 		createNewRoot(left_child_id, key, right_child_id);
 		return;
 	}
 
-	// STEP 3: Fetch the parent page
-	Page *parent_page = bpm->fetchPage(parent_id);
-	BPlusTreeInternalPage parent(const_cast<char *>(parent_page->getRawData()));
+	// STEP 2: The parent is the node above it in the path: only a node that can't split lets go of
+	// its ancestors, so the parent of one that did split is still latched there
+	if (depth == 0) {
+		throw std::runtime_error("insertIntoParent: parent of page " + std::to_string(left_child_id) +
+								 " is not in the descent path");
+	}
+	InternalPage parent(const_cast<char *>(path[depth - 1]->getRawData()));
 
-	// STEP 4: Try to insert the key into the parent
-	bool insert_success = parent.insertAfter(key, right_child_id);
+	// STEP 3: Try to insert the key into the parent (releasePath marks it dirty)
+	if (parent.insertAfter(key, right_child_id)) {
+		LUMINADB_LOG_DEBUG("insertIntoParent", "Key inserted into parent successfully");
+		return;
+	}
 
-	if (insert_success) {
-		// Parent had space, just mark it as dirty and we're done
-		std::cout << "[insertIntoParent] Key inserted into parent successfully" << std::endl;
-		bpm->unpinPage(parent_id, true);
-	} else {
-		// Parent is full, need to split it recursively
-		std::cout << "[insertIntoParent] Parent is full, need to split it recursively" << std::endl;
+	// STEP 4: Parent is full: split it and push its middle key one level up.
+	// The children that move to the new sibling are not touched
+	LUMINADB_LOG_DEBUG("insertIntoParent", "Parent is full, splitting it");
 
-		// For now, we'll handle this in a future step (Phase 5.3.2)
-		// TODO: Implement internal node split and recursive propagation
-		std::cout << "[TODO] Internal node split not yet implemented" << std::endl;
-		bpm->unpinPage(parent_id, false);
-	}
+	SplitResult<Key> split_result = parent.split(key, right_child_id, bpm);
+	insertIntoParent(path, depth - 1, split_result.middle_key, split_result.new_page_id);
 }
 
-void BPlusTree::createNewRoot(uint32_t left_child_id, uint32_t key, uint32_t right_child_id) {
-	std::cout << "\n[createNewRoot] Creating new root with key=" << key << std::endl;
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::createNewRoot(uint32_t left_child_id, const Key &key, uint32_t right_child_id) {
+	LUMINADB_LOG_DEBUG("createNewRoot", "Creating new root with key=" << key);
 
 	// STEP 1: Create a new page for the new root (internal node)
 	uint32_t new_root_id;
 	Page *new_root_page = bpm->newPage(new_root_id, ModelType::B_PLUS_TREE);
 
-	BPlusTreeInternalPage new_root(const_cast<char *>(new_root_page->getRawData()));
-	new_root.init(IndexPageType::INTERNAL_NODE, 0, 250); // parent_id=0 (it's the root)
+	if (new_root_page == nullptr) {
+		throw std::runtime_error("Failed to allocate page for new B+ Tree root");
+	}
+
+	InternalPage new_root(const_cast<char *>(new_root_page->getRawData()));
+	new_root.init();
 
 	// Store the page_id in the header
 	new_root.getHeader()->page_id = new_root_id;
@@ -161,53 +323,803 @@ void BPlusTree::createNewRoot(uint32_t left_child_id, uint32_t key, uint32_t rig
 	// STEP 2: Set up the internal structure
 	// The new root has 2 children and 1 key:
 	// [left_child_id] key [right_child_id]
-
-	new_root.setValueAt(0, left_child_id);	// Left child
-	new_root.setKeyAt(0, key);				// Separator key
-	new_root.setValueAt(1, right_child_id); // Right child
-	new_root.setSize(1);					// 1 key = 2 children
+	new_root.rebuild({key}, {left_child_id, right_child_id});
 
 	bpm->unpinPage(new_root_id, true);
 
-	// STEP 3: Update the parent pointers of both children
-	Page *left_child_page = bpm->fetchPage(left_child_id);
-	BPlusTreePage left_child_base(const_cast<char *>(left_child_page->getRawData()));
-	left_child_base.getHeader()->parent_page_id = new_root_id;
-	bpm->unpinPage(left_child_id, true);
+	// STEP 3: Update the tree's root_page_id
+	root_page_id = new_root_id;
 
-	Page *right_child_page = bpm->fetchPage(right_child_id);
-	BPlusTreePage right_child_base(const_cast<char *>(right_child_page->getRawData()));
-	right_child_base.getHeader()->parent_page_id = new_root_id;
-	bpm->unpinPage(right_child_id, true);
+	LUMINADB_LOG_DEBUG("createNewRoot", "New root created at page " << new_root_id);
+	LUMINADB_TRACE("new_root", new_root_id, left_child_id);
+}
 
-	// STEP 4: Update the tree's root_page_id
-	root_page_id = new_root_id;
+template <typename Key, typename Compare>
+BPlusTreeIterator<Key, Compare> BPlusTree<Key, Compare>::scan(const Key &lo, const Key &hi) {
+	if (Compare{}(hi, lo))
+		return Iterator();
+
+	const Page *page = findLeafPageForRead(lo);
+	if (page == nullptr)
+		return Iterator();
+
+	// First entry >= lo; the iterator moves on to the next leaf if there is none here
+	LeafPage leaf(const_cast<char *>(page->getRawData()));
+	int index = leaf.lookup(lo);
+
+	return Iterator(bpm, page, static_cast<uint32_t>(index), hi);
+}
+
+// --- BULK LOAD ---
+
+template <typename Key, typename Compare>
+size_t BPlusTree<Key, Compare>::bulkLoad(const std::function<bool(Key &key, RecordID &value)> &next, double fill_factor) {
+	if (fill_factor < 0.5 || fill_factor > 1.0) {
+		throw std::runtime_error("bulkLoad: fill factor must be between 0.5 and 1.0");
+	}
+
+	// Nothing else can enter the tree until the new root is in place
+	std::unique_lock<std::shared_mutex> root_lock(root_latch);
+	tail_leaf_id = INVALID_PAGE_ID;
+
+	// STEP 1: Only an empty tree can be built bottom-up; its root page becomes the first leaf
+	Page *root_page = bpm->fetchPage(root_page_id);
+	if (root_page == nullptr) {
+		throw std::runtime_error("bulkLoad: failed to fetch root page");
+	}
+	BPlusTreePage root(const_cast<char *>(root_page->getRawData()));
+	bool empty = root.isLeaf() && root.getSize() == 0;
+	bpm->unpinPage(root_page_id, false);
+
+	if (!empty) {
+		throw std::runtime_error("bulkLoad: the tree must be empty");
+	}
+
+	BulkLoadState state;
+	state.fill_factor = fill_factor;
+	state.next_leaf_id = root_page_id;
+	state.has_leaf = false;
+
+	// A leaf is only written once two full leaves' worth of entries are waiting, so what is
+	// left at the end is enough for one or two leaves that are at least half full
+	size_t lookahead = 2 * static_cast<size_t>(LeafPage::maxCapacity());
+
+	// STEP 2: Stream the entries into leaves
+	size_t loaded = 0;
+	Key key;
+	RecordID value;
+	while (next(key, value)) {
+		if (!state.pending_keys.empty() && !Compare{}(state.pending_keys.back(), key)) {
+			throw std::runtime_error("bulkLoad: keys must be strictly increasing (" + keyToString(key) + " after " +
+									 keyToString(state.pending_keys.back()) + ")");
+		}
+		state.pending_keys.push_back(key);
+		state.pending_values.push_back(value);
+		loaded++;
+
+		if (state.pending_keys.size() >= lookahead) {
+			emitLeaf(state, LeafPage::fillCount(state.pending_keys.data(), state.pending_keys.size(), fill_factor),
+					 false);
+		}
+	}
+
+	if (loaded == 0) {
+		return 0;
+	}
+
+	// STEP 3: Last leaves. Whatever is left fits in one leaf or is split evenly in two
+	while (!LeafPage::fits(state.pending_keys.data(), state.pending_keys.size())) {
+		const Key *rest = state.pending_keys.data();
+		size_t half = state.pending_keys.size() / 2;
+		if (LeafPage::fits(rest, half) && LeafPage::fits(rest + half, state.pending_keys.size() - half)) {
+			emitLeaf(state, half, false);
+		} else {
+			emitLeaf(state, LeafPage::fillCount(rest, state.pending_keys.size(), fill_factor), false);
+		}
+	}
+	emitLeaf(state, state.pending_keys.size(), true);
+
+	// STEP 4: Close every level the same way, bottom-up, until a single node is left: the root
+	for (size_t level = 0; level < state.levels.size(); level++) {
+		// Emitting may add a level, so state.levels is indexed again after every emit
+		bool top = (level + 1 == state.levels.size());
+
+		// Nothing was emitted from the top level, so a single node waiting there is the only one
+		if (top && state.levels[level].pages.size() == 1) {
+			root_page_id = state.levels[level].pages[0];
+			break;
+		}
+
+		// A node over n children holds separators [1, n)
+		while (!InternalPage::fits(state.levels[level].separators.data() + 1, state.levels[level].pages.size() - 1)) {
+			const Key *rest = state.levels[level].separators.data() + 1;
+			size_t count = state.levels[level].pages.size();
+			size_t half = count / 2;
+			if (InternalPage::fits(rest, half - 1) && InternalPage::fits(rest + half, count - half - 1)) {
+				emitInternal(state, level, half);
+			} else {
+				emitInternal(state, level, InternalPage::fillCount(rest, count - 1, fill_factor) + 1);
+			}
+		}
+		emitInternal(state, level, state.levels[level].pages.size());
+	}
+
+	LUMINADB_LOG_INFO("bulkLoad", "Loaded " << loaded << " keys, root at page " << root_page_id);
+	return loaded;
+}
+
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::emitLeaf(BulkLoadState &state, size_t count, bool last_leaf) {
+	uint32_t leaf_id = state.next_leaf_id;
+
+	// The following leaf is certain to exist: reserve its page now so this one can link to it
+	uint32_t next_id = 0;
+	if (!last_leaf) {
+		Page *reserved = bpm->newPage(next_id, ModelType::B_PLUS_TREE);
+		if (reserved == nullptr) {
+			throw std::runtime_error("bulkLoad: failed to allocate leaf page");
+		}
+		bpm->unpinPage(next_id, false);
+		state.next_leaf_id = next_id;
+	}
+
+	Page *page = bpm->fetchPage(leaf_id);
+	if (page == nullptr) {
+		throw std::runtime_error("bulkLoad: failed to fetch leaf page " + std::to_string(leaf_id));
+	}
+	LeafPage leaf(const_cast<char *>(page->getRawData()));
+	leaf.init();
+	leaf.getHeader()->page_id = leaf_id;
+	leaf.rebuild(std::vector<Key>(state.pending_keys.begin(), state.pending_keys.begin() + count),
+				 std::vector<RecordID>(state.pending_values.begin(), state.pending_values.begin() + count));
+	leaf.setNextPageId(next_id);
+
+	// The separator before this leaf only has to be greater than the previous leaf's last key
+	Key separator = state.has_leaf ? LeafPage::shortestSeparator(state.last_key, state.pending_keys[0])
+								   : state.pending_keys[0];
+	state.last_key = state.pending_keys[count - 1];
+	state.has_leaf = true;
+
+	state.pending_keys.erase(state.pending_keys.begin(), state.pending_keys.begin() + count);
+	state.pending_values.erase(state.pending_values.begin(), state.pending_values.begin() + count);
+	bpm->unpinPage(leaf_id, true);
+
+	addToLevel(state, 0, separator, leaf_id);
+}
+
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::emitInternal(BulkLoadState &state, size_t level, size_t count) {
+	BulkLoadLevel &waiting = state.levels[level];
+
+	uint32_t node_id;
+	Page *page = bpm->newPage(node_id, ModelType::B_PLUS_TREE);
+	if (page == nullptr) {
+		throw std::runtime_error("bulkLoad: failed to allocate internal page");
+	}
+	InternalPage node(const_cast<char *>(page->getRawData()));
+	node.init();
+	node.getHeader()->page_id = node_id;
+
+	// [child_0] sep_1 [child_1] sep_2 ... : sep_0 goes one level up, in front of this node
+	std::vector<uint32_t> children(waiting.pages.begin(), waiting.pages.begin() + count);
+	node.rebuild(std::vector<Key>(waiting.separators.begin() + 1, waiting.separators.begin() + count), children);
+
+	Key separator = waiting.separators[0];
+	waiting.separators.erase(waiting.separators.begin(), waiting.separators.begin() + count);
+	waiting.pages.erase(waiting.pages.begin(), waiting.pages.begin() + count);
+	bpm->unpinPage(node_id, true);
+
+	addToLevel(state, level + 1, separator, node_id);
+}
+
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::addToLevel(BulkLoadState &state, size_t level, const Key &separator, uint32_t page_id) {
+	if (level == state.levels.size()) {
+		state.levels.emplace_back();
+	}
+	BulkLoadLevel &waiting = state.levels[level];
+	waiting.separators.push_back(separator);
+	waiting.pages.push_back(page_id);
+
+	// Same rule as the leaves: keep two full nodes' worth of children waiting
+	size_t lookahead = 2 * (static_cast<size_t>(InternalPage::maxCapacity()) + 1);
+	if (waiting.pages.size() >= lookahead) {
+		size_t keys = InternalPage::fillCount(waiting.separators.data() + 1, waiting.pages.size() - 1, state.fill_factor);
+		emitInternal(state, level, keys + 1);
+	}
+}
+
+// --- DELETE METHODS ---
+
+template <typename Key, typename Compare>
+bool BPlusTree<Key, Compare>::remove(const Key &key, RecordID *removed) {
+	return removeEntry(key, nullptr, removed);
+}
+
+template <typename Key, typename Compare>
+bool BPlusTree<Key, Compare>::remove(const Key &key, const RecordID &value) {
+	return removeEntry(key, &value, nullptr);
+}
+
+template <typename Key, typename Compare>
+bool BPlusTree<Key, Compare>::removeEntry(const Key &key, const RecordID *value, RecordID *removed_value) {
+	// STEP 1: Optimistic pass: only the leaf is latched. A value taken out of a posting list,
+	// or a key whose leaf stays at least half full, doesn't change anything above it
+	Page *page = findLeafOptimistic(key, Operation::UPDATE);
+	{
+		LeafPage leaf(const_cast<char *>(page->getRawData()));
+		uint32_t leaf_id = leaf.getHeader()->page_id;
+
+		int index = leaf.lookup(key);
+		bool present = index < static_cast<int>(leaf.getSize()) && LeafPage::keysEqual(leaf.keyAt(index), key);
+
+		ValueRemoval outcome = present ? ValueRemoval::LAST_VALUE : ValueRemoval::NOT_FOUND;
+		try {
+			if (present && value != nullptr) {
+				outcome = removeValue(leaf, index, *value);
+			}
+		} catch (...) {
+			bpm->unlatchPage(page, true);
+			bpm->unpinPage(leaf_id, true);
+			throw;
+		}
+
+		if (outcome != ValueRemoval::LAST_VALUE) {
+			bpm->unlatchPage(page, true);
+			bpm->unpinPage(leaf_id, outcome == ValueRemoval::REMOVED);
+			return outcome == ValueRemoval::REMOVED;
+		}
+
+		// A leaf can't become or stop being the root while it is latched
+		if (isSafe(page, Operation::DELETE, leaf_id == root_page_id, key)) {
+			RecordID removed = leaf.valueAt(index);
+			leaf.removeAt(index);
+
+			bpm->unlatchPage(page, true);
+			bpm->unpinPage(leaf_id, true);
+			if (removed_value != nullptr) {
+				*removed_value = removed;
+			}
+			dropValue(removed);
+			return true;
+		}
+
+		bpm->unlatchPage(page, true);
+		bpm->unpinPage(leaf_id, false);
+	}
+
+	// STEP 2: The leaf may underflow: latch exclusively every node a merge can reach
+	std::unique_lock<std::shared_mutex> root_lock(root_latch, std::defer_lock);
+	std::vector<Page *> path;
+	page = findLeafPessimistic(key, Operation::DELETE, path, root_lock);
+
+	// Emptied pages are only handed back to the allocator once nobody holds their latch
+	std::vector<uint32_t> freed;
+	RecordID removed;
 
-	std::cout << "[createNewRoot] New root created at page " << new_root_id << std::endl;
+	try {
+		LeafPage leaf(const_cast<char *>(page->getRawData()));
+		uint32_t leaf_id = leaf.getHeader()->page_id;
+
+		// Things may have changed between the two passes
+		int index = leaf.lookup(key);
+		bool present = index < static_cast<int>(leaf.getSize()) && LeafPage::keysEqual(leaf.keyAt(index), key);
+
+		ValueRemoval outcome = present ? ValueRemoval::LAST_VALUE : ValueRemoval::NOT_FOUND;
+		if (present && value != nullptr) {
+			outcome = removeValue(leaf, index, *value);
+		}
+		if (outcome != ValueRemoval::LAST_VALUE) {
+			releasePath(path, outcome == ValueRemoval::REMOVED);
+			return outcome == ValueRemoval::REMOVED;
+		}
+
+		removed = leaf.valueAt(index);
+		leaf.removeAt(index);
+
+		// The root may shrink down to empty; any other leaf must stay half full
+		if (leaf_id != root_page_id && leaf.getSize() < leaf.getMinSize()) {
+			rebalance(path, path.size() - 1, freed);
+		}
+	} catch (...) {
+		releasePath(path, true);
+		throw;
+	}
+
+	releasePath(path, true);
+
+	for (uint32_t page_id : freed) {
+		freePage(page_id);
+	}
+	if (removed_value != nullptr) {
+		*removed_value = removed;
+	}
+	dropValue(removed);
+	return true;
+}
+
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::dropValue(const RecordID &value) {
+	// Unreachable now that its entry is gone
+	if (isPostingList(value)) {
+		postings->destroy(value);
+	}
 }
 
-// Debug
-Page *BPlusTree::findLeafPage(uint32_t key) {
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::rebalance(std::vector<Page *> &path, size_t depth, std::vector<uint32_t> &freed) {
+	Page *node_page = path[depth];
+	uint32_t node_id = node_page->getPageId();
+
+	// STEP 1: Root. Only an internal root without keys (a single child) needs work: collapse it.
+	// The root was unsafe, so the pessimistic descent still holds the root latch exclusively
+	if (node_id == root_page_id) {
+		InternalPage root(const_cast<char *>(node_page->getRawData()));
+
+		if (root.isLeaf() || root.getSize() > 0) {
+			return;
+		}
+
+		uint32_t child_id = root.valueAt(0);
+		root_page_id = child_id;
+		freed.push_back(node_id);
+
+		LUMINADB_LOG_DEBUG("rebalance", "Root collapsed, new root is page " << child_id);
+		LUMINADB_TRACE("root_collapse", node_id, child_id);
+		return;
+	}
+
+	// STEP 2: Pick a sibling under the same parent (the left one when there is one).
+	// Node and parent are latched in the caller's path (an unsafe node keeps its parent there);
+	// the sibling is latched here
+	if (depth == 0) {
+		throw std::runtime_error("rebalance: parent of page " + std::to_string(node_id) + " is not in the descent path");
+	}
+	BPlusTreePage node(const_cast<char *>(node_page->getRawData()));
+
+	Page *parent_page = path[depth - 1];
+	uint32_t parent_id = parent_page->getPageId();
+	InternalPage parent(const_cast<char *>(parent_page->getRawData()));
+
+	int index = parent.childIndex(node_id);
+	if (index < 0) {
+		throw std::runtime_error("Page " + std::to_string(node_id) + " is not a child of its parent " +
+								 std::to_string(parent_id));
+	}
+
+	// A parent left under-full itself may have a single child: no sibling to work with
+	if (parent.getSize() == 0) {
+		LUMINADB_LOG_DEBUG("rebalance", "Page " << node_id << " has no sibling, left under-full");
+		LUMINADB_TRACE("rebalance_skipped", node_id, parent_id);
+		return;
+	}
+
+	bool sibling_is_left = index > 0;
+	uint32_t sibling_id = parent.valueAt(sibling_is_left ? index - 1 : index + 1);
+	Page *sibling_page = bpm->fetchPage(sibling_id);
+
+	// With the pool exhausted the sibling can't be read: the delete itself is done, so leave the
+	// node under-full (like a busy sibling) instead of failing it
+	if (sibling_page == nullptr) {
+		LUMINADB_LOG_WARN("rebalance", "Sibling " << sibling_id << " of page " << node_id
+												  << " can't be fetched, left under-full");
+		LUMINADB_TRACE("rebalance_skipped", node_id, sibling_id);
+		return;
+	}
+
+	// Scans latch leaves left to right, so waiting on a left leaf could deadlock with one.
+	// Only try it; if it's busy use the right sibling, or leave the leaf under-full for now
+	if (node.isLeaf() && sibling_is_left && !bpm->tryLatchPage(sibling_page, true)) {
+		bpm->unpinPage(sibling_id, false);
+
+		if (index + 1 > static_cast<int>(parent.getSize())) {
+			LUMINADB_LOG_DEBUG("rebalance", "Left sibling of page " << node_id << " is busy, left under-full");
+			LUMINADB_TRACE("rebalance_skipped", node_id, sibling_id);
+			return;
+		}
+
+		sibling_is_left = false;
+		sibling_id = parent.valueAt(index + 1);
+		sibling_page = bpm->fetchPage(sibling_id);
+		if (sibling_page == nullptr) {
+			LUMINADB_LOG_WARN("rebalance", "Sibling " << sibling_id << " of page " << node_id
+													  << " can't be fetched, left under-full");
+			LUMINADB_TRACE("rebalance_skipped", node_id, sibling_id);
+			return;
+		}
+		bpm->latchPage(sibling_page, true);
+	} else if (!node.isLeaf() || !sibling_is_left) {
+		bpm->latchPage(sibling_page, true);
+	}
+
+	int separator = sibling_is_left ? index - 1 : index; // Key between node and sibling
+	BPlusTreePage sibling(const_cast<char *>(sibling_page->getRawData()));
+
+	char *node_data = const_cast<char *>(node_page->getRawData());
+	char *sibling_data = const_cast<char *>(sibling_page->getRawData());
+
+	// STEP 3: The sibling can spare an entry: move one over and fix the separator.
+	// With packed keys the moved key and the new separator must fit too; check before moving anything
+	bool can_borrow = sibling.getSize() > sibling.getMinSize();
+	if (can_borrow && node.isLeaf()) {
+		LeafPage leaf(node_data);
+		LeafPage sibling_leaf(sibling_data);
+		int moved = sibling_is_left ? static_cast<int>(sibling_leaf.getSize()) - 1 : 0;
+		Key new_separator = sibling_is_left ? LeafPage::shortestSeparator(sibling_leaf.keyAt(moved - 1),
+																		  sibling_leaf.keyAt(moved))
+											: LeafPage::shortestSeparator(sibling_leaf.keyAt(0), sibling_leaf.keyAt(1));
+		can_borrow = leaf.canInsert(sibling_leaf.keyAt(moved)) && parent.canSetKeyAt(separator, new_separator);
+	} else if (can_borrow) {
+		InternalPage internal(node_data);
+		InternalPage sibling_internal(sibling_data);
+		Key new_separator = sibling_internal.keyAt(sibling_is_left ? sibling_internal.getSize() - 1 : 0);
+		can_borrow = internal.canInsert(parent.keyAt(separator)) && parent.canSetKeyAt(separator, new_separator);
+	}
+
+	if (can_borrow) {
+		if (node.isLeaf()) {
+			LeafPage leaf(node_data);
+			LeafPage sibling_leaf(sibling_data);
+
+			// The new separator only has to fall between the two leaves (see LeafPage::split)
+			if (sibling_is_left) {
+				int last = sibling_leaf.getSize() - 1;
+				leaf.insert(sibling_leaf.keyAt(last), sibling_leaf.valueAt(last));
+				sibling_leaf.removeAt(last);
+				parent.setKeyAt(separator, LeafPage::shortestSeparator(sibling_leaf.keyAt(last - 1), leaf.keyAt(0)));
+			} else {
+				leaf.insert(sibling_leaf.keyAt(0), sibling_leaf.valueAt(0));
+				sibling_leaf.removeAt(0);
+				parent.setKeyAt(separator, LeafPage::shortestSeparator(leaf.keyAt(leaf.getSize() - 1),
+																	   sibling_leaf.keyAt(0)));
+			}
+		} else {
+			InternalPage internal(node_data);
+			InternalPage sibling_internal(sibling_data);
+
+			// The separator comes down into the node and the sibling's edge key goes up
+			if (sibling_is_left) {
+				uint32_t last = sibling_internal.getSize();
+				internal.pushFront(sibling_internal.valueAt(last), parent.keyAt(separator));
+				parent.setKeyAt(separator, sibling_internal.keyAt(last - 1));
+				sibling_internal.setSize(last - 1);
+			} else {
+				internal.pushBack(parent.keyAt(separator), sibling_internal.valueAt(0));
+				parent.setKeyAt(separator, sibling_internal.keyAt(0));
+				sibling_internal.removeFirst();
+			}
+		}
+
+		bpm->unlatchPage(sibling_page, true);
+		bpm->unpinPage(sibling_id, true);
+
+		LUMINADB_LOG_DEBUG("rebalance", "Page " << node_id << " borrowed from sibling " << sibling_id);
+		LUMINADB_TRACE("borrow", node_id, sibling_id);
+		return;
+	}
+
+	// STEP 4: Merge the right one into the left one, if their keys fit in one page
+	uint32_t left_id = sibling_is_left ? sibling_id : node_id;
+	uint32_t right_id = sibling_is_left ? node_id : sibling_id;
+	char *left_data = sibling_is_left ? sibling_data : node_data;
+	char *right_data = sibling_is_left ? node_data : sibling_data;
+
+	bool merged;
+
+	if (node.isLeaf()) {
+		LeafPage left(left_data);
+		LeafPage right(right_data);
+
+		merged = left.absorb(right);
+		if (merged) {
+			// Keep the leaf chain: [left] -> [right] -> next becomes [left] -> next
+			left.setNextPageId(right.getNextPageId());
+		}
+	} else {
+		InternalPage left(left_data);
+		InternalPage right(right_data);
+
+		// The separator comes down between the two halves
+		merged = left.absorb(parent.keyAt(separator), right);
+	}
+
+	// The tail leaf may be going away; both leaves are still latched
+	if (merged && node.isLeaf()) {
+		uint32_t expected = right_id;
+		tail_leaf_id.compare_exchange_strong(expected, left_id);
+	}
+
+	if (!merged) {
+		bpm->unlatchPage(sibling_page, false);
+		bpm->unpinPage(sibling_id, false);
+		LUMINADB_LOG_DEBUG("rebalance", "Pages " << node_id << " and " << sibling_id
+												 << " don't fit in one page, left under-full");
+		LUMINADB_TRACE("rebalance_skipped", node_id, sibling_id);
+		return;
+	}
+
+	// STEP 5: Drop the separator and the right node from the parent
+	parent.removeAt(separator);
+	bool parent_underflow =
+		(parent_id == root_page_id) ? parent.getSize() == 0 : parent.getSize() < parent.getMinSize();
+
+	bpm->unlatchPage(sibling_page, true);
+	bpm->unpinPage(sibling_id, true);
+	freed.push_back(right_id);
+
+	LUMINADB_LOG_DEBUG("rebalance", "Merged page " << right_id << " into page " << left_id);
+	LUMINADB_TRACE("merge", right_id, left_id);
+
+	// STEP 6: The parent lost a key, it may be under the minimum now
+	if (parent_underflow) {
+		rebalance(path, depth - 1, freed);
+	}
+}
+
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::freePage(uint32_t page_id) {
+	// An upper node that went away (merge, root collapse) must not stay pinned by the cache
+	hot_pages.evict(page_id);
+
+	// The node is unreachable, so whoever still pins it lets go soon: keep it until then
+	std::lock_guard<std::mutex> lock(pending_free_latch);
+	retryPendingFrees();
+	if (!bpm->deletePage(page_id)) {
+		pending_free.push_back(page_id);
+		LUMINADB_LOG_WARN("freePage", "Page " << page_id << " is pinned, freed later");
+	}
+}
+
+template <typename Key, typename Compare> void BPlusTree<Key, Compare>::retryPendingFrees() {
+	size_t kept = 0;
+	for (uint32_t page_id : pending_free) {
+		if (bpm->deletePage(page_id)) {
+			LUMINADB_LOG_DEBUG("freePage", "Deferred page " << page_id << " freed");
+		} else {
+			pending_free[kept++] = page_id;
+		}
+	}
+	pending_free.resize(kept);
+}
+
+template <typename Key, typename Compare> void BPlusTree<Key, Compare>::freePendingPages() {
+	{
+		std::lock_guard<std::mutex> lock(pending_free_latch);
+		retryPendingFrees();
+	}
+	if (postings) {
+		postings->freePendingPages();
+	}
+}
+
+// --- DESCENT METHODS ---
+
+template <typename Key, typename Compare>
+bool BPlusTree<Key, Compare>::isSafe(const Page *page, Operation op, bool is_root, const Key &key) const {
+	char *raw_data = const_cast<char *>(page->getRawData());
+	BPlusTreePage node(raw_data);
+	uint32_t size = node.getSize();
+
+	// The caller checks the leaf itself once it holds it
+	if (op == Operation::UPDATE) {
+		return true;
+	}
+
+	if (op == Operation::INSERT) {
+		// One more entry fits without a split. With packed keys that depends on the key:
+		// the leaf knows it, an internal node can only bound the separator it would get
+		if (node.isLeaf()) {
+			return LeafPage(raw_data).canInsert(key);
+		}
+		return InternalPage(raw_data).canTakeSplitOf(key);
+	}
+
+	// One entry less must not trigger a merge (or collapse the root)
+	if (is_root) {
+		return node.isLeaf() || size > 1;
+	}
+	return size > node.getMinSize();
+}
+
+template <typename Key, typename Compare>
+Page *BPlusTree<Key, Compare>::findLeafOptimistic(const Key &key, Operation op) {
+	// The root latch stands in for the root's parent until the root page is latched
+	std::shared_lock<std::shared_mutex> root_lock(root_latch);
+
+	uint32_t page_id = root_page_id;
+	bool hot;
+	Page *page = fetchNode(page_id, hot);
+	if (page == nullptr) {
+		throw std::runtime_error("Failed to fetch B+ Tree root page " + std::to_string(page_id));
+	}
+	bpm->latchPage(page, false);
+
+	// Keep one level above the current node: it stops the leaf from being split or merged
+	// between dropping its shared latch and taking the exclusive one
+	Page *parent = nullptr;
+	uint32_t parent_id = 0;
+	bool parent_hot = false;
+
+	for (size_t depth = 0;; depth++) {
+		BPlusTreePage node(const_cast<char *>(page->getRawData()));
+
+		// Leaves never go in the hot cache: the leaf is always pinned from the pool
+		if (node.isLeaf()) {
+			bpm->unlatchPage(page, false);
+			bpm->latchPage(page, true);
+
+			bool is_root = (parent == nullptr);
+			if (is_root) {
+				root_lock.unlock();
+			} else {
+				bpm->unlatchPage(parent, false);
+				unpinNode(parent_id, parent, parent_hot);
+			}
+
+			if (isSafe(page, op, is_root, key)) {
+				return page;
+			}
+
+			bpm->unlatchPage(page, true);
+			bpm->unpinPage(page_id, false);
+			return nullptr;
+		}
+		keepHot(page_id, depth, hot);
+
+		InternalPage internal(const_cast<char *>(page->getRawData()));
+		uint32_t child_id = internal.lookup(key);
+
+		bool child_hot;
+		Page *child = fetchNode(child_id, child_hot);
+		if (child == nullptr) {
+			bpm->unlatchPage(page, false);
+			unpinNode(page_id, page, hot);
+			if (parent != nullptr) {
+				bpm->unlatchPage(parent, false);
+				unpinNode(parent_id, parent, parent_hot);
+			}
+			throw std::runtime_error("Failed to fetch B+ Tree page " + std::to_string(child_id));
+		}
+		bpm->latchPage(child, false);
+
+		if (parent == nullptr) {
+			root_lock.unlock();
+		} else {
+			bpm->unlatchPage(parent, false);
+			unpinNode(parent_id, parent, parent_hot);
+		}
+
+		parent = page;
+		parent_id = page_id;
+		parent_hot = hot;
+		page = child;
+		page_id = child_id;
+		hot = child_hot;
+	}
+}
+
+template <typename Key, typename Compare>
+Page *BPlusTree<Key, Compare>::findLeafPessimistic(const Key &key, Operation op, std::vector<Page *> &path,
+									 std::unique_lock<std::shared_mutex> &root_lock) {
+	root_lock.lock();
+
 	uint32_t page_id = root_page_id;
-	std::cout << "\n[findLeafPage] Starting from root=" << page_id << " searching for key=" << key << std::endl;
 
 	while (true) {
 		Page *page = bpm->fetchPage(page_id);
-		BPlusTreePage base(const_cast<char *>(page->getRawData()));
+		if (page == nullptr) {
+			releasePath(path, false);
+			if (root_lock.owns_lock()) {
+				root_lock.unlock();
+			}
+			throw std::runtime_error("Failed to fetch B+ Tree page " + std::to_string(page_id));
+		}
+		bpm->latchPage(page, true);
+
+		// A safe node absorbs the change: nothing above it can be modified, let it go
+		BPlusTreePage node(const_cast<char *>(page->getRawData()));
+		if (isSafe(page, op, page_id == root_page_id, key)) {
+			releasePath(path, false);
+			if (root_lock.owns_lock()) {
+				root_lock.unlock();
+			}
+		}
+		path.push_back(page);
+
+		if (node.isLeaf()) {
+			return page;
+		}
+
+		InternalPage internal(const_cast<char *>(page->getRawData()));
+		page_id = internal.lookup(key);
+	}
+}
+
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::releasePath(std::vector<Page *> &path, bool dirty) {
+	for (Page *page : path) {
+		uint32_t page_id = page->getPageId();
+		bpm->unlatchPage(page, true);
+		bpm->unpinPage(page_id, dirty);
+	}
+	path.clear();
+}
 
-		std::cout << "[findLeafPage] At page " << page_id << ", type=" << (base.isLeaf() ? "LEAF" : "INTERNAL")
-				  << std::endl;
+template <typename Key, typename Compare>
+const Page *BPlusTree<Key, Compare>::findLeafPageForRead(const Key &key) {
+	// Once the root page is latched it can't stop being the root, so the root latch is brief
+	std::shared_lock<std::shared_mutex> root_lock(root_latch);
 
+	uint32_t page_id = root_page_id;
+	bool hot;
+	const Page *page = fetchNodeForRead(page_id, hot);
+	if (page == nullptr)
+		return nullptr;
+	bpm->latchPage(page, false);
+	root_lock.unlock();
+
+	for (size_t depth = 0;; depth++) {
+		BPlusTreePage base(const_cast<char *>(page->getRawData()));
 		if (base.isLeaf()) {
 			return page;
 		}
+		keepHot(page_id, depth, hot);
+
+		InternalPage internal(const_cast<char *>(page->getRawData()));
+		uint32_t next_id = internal.lookup(key);
+
+		// Crab: latch the child before letting go of the parent
+		bool next_hot;
+		const Page *next_page = fetchNodeForRead(next_id, next_hot);
+		if (next_page != nullptr) {
+			bpm->latchPage(next_page, false);
+		}
+		bpm->unlatchPage(page, false);
+		unpinNode(page_id, page, hot);
 
-		BPlusTreeInternalPage internal(const_cast<char *>(page->getRawData()));
-		uint32_t next_page = internal.lookup(key);
+		if (next_page == nullptr)
+			return nullptr;
 
-		bpm->unpinPage(page_id, false);
-		page_id = next_page;
+		page = next_page;
+		page_id = next_id;
+		hot = next_hot;
 	}
 }
 
+template <typename Key, typename Compare>
+Page *BPlusTree<Key, Compare>::fetchNode(uint32_t page_id, bool &hot) {
+	Page *page = hot_pages.lookup(page_id);
+	hot = (page != nullptr);
+	return hot ? page : bpm->fetchPage(page_id);
+}
+
+template <typename Key, typename Compare>
+const Page *BPlusTree<Key, Compare>::fetchNodeForRead(uint32_t page_id, bool &hot) {
+	const Page *page = hot_pages.lookup(page_id);
+	hot = (page != nullptr);
+	return hot ? page : bpm->fetchPageForRead(page_id);
+}
+
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::unpinNode(uint32_t page_id, const Page *page, bool hot) {
+	// The cache's own pin is the only one a hot page has
+	if (!hot) {
+		bpm->unpinPageForRead(page_id, page);
+	}
+}
+
+template <typename Key, typename Compare>
+void BPlusTree<Key, Compare>::keepHot(uint32_t page_id, size_t depth, bool hot) {
+	if (!hot && depth < HOT_LEVELS && !hot_pages.isFull()) {
+		hot_pages.admit(page_id);
+	}
+}
+
+// --- INSTANTIATIONS ---
+
+template class BPlusTree<uint32_t>;
+template class BPlusTree<uint64_t>;
+template class BPlusTree<SensorKey>;
+template class BPlusTree<StringKey32>;
+
 } // namespace LuminaDB
@@ -0,0 +1,119 @@
+#include "luminadb/index/BPlusTreeIterator.hpp"
+#include "luminadb/index/BPlusTreePage.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace LuminaDB {
+
+template <typename Key, typename Compare>
+BPlusTreeIterator<Key, Compare>::BPlusTreeIterator() : bpm(nullptr), leaf_page(nullptr), leaf_id(0), index(0), hi() {}
+
+template <typename Key, typename Compare>
+BPlusTreeIterator<Key, Compare>::BPlusTreeIterator(BufferPoolManager *bpm, const Page *leaf_page, uint32_t index, const Key &hi)
+	: bpm(bpm), leaf_page(leaf_page), leaf_id(0), index(index), hi(hi) {
+	if (leaf_page != nullptr) {
+		leaf_id = leaf_page->getPageId();
+		skipExhaustedLeaves();
+	}
+}
+
+template <typename Key, typename Compare>
+BPlusTreeIterator<Key, Compare>::~BPlusTreeIterator() { release(); }
+
+template <typename Key, typename Compare>
+BPlusTreeIterator<Key, Compare>::BPlusTreeIterator(BPlusTreeIterator &&other) noexcept
+	: bpm(other.bpm), leaf_page(other.leaf_page), leaf_id(other.leaf_id), index(other.index), hi(other.hi) {
+	other.leaf_page = nullptr;
+}
+
+template <typename Key, typename Compare>
+BPlusTreeIterator<Key, Compare> &BPlusTreeIterator<Key, Compare>::operator=(BPlusTreeIterator &&other) noexcept {
+	if (this != &other) {
+		release();
+		bpm = other.bpm;
+		leaf_page = other.leaf_page;
+		leaf_id = other.leaf_id;
+		index = other.index;
+		hi = other.hi;
+		other.leaf_page = nullptr;
+	}
+	return *this;
+}
+
+template <typename Key, typename Compare>
+bool BPlusTreeIterator<Key, Compare>::isEnd() const { return leaf_page == nullptr; }
+
+template <typename Key, typename Compare>
+Key BPlusTreeIterator<Key, Compare>::key() const {
+	BPlusTreeLeafPage<Key, Compare> leaf(const_cast<char *>(leaf_page->getRawData()));
+	return leaf.keyAt(index);
+}
+
+template <typename Key, typename Compare>
+RecordID BPlusTreeIterator<Key, Compare>::value() const {
+	BPlusTreeLeafPage<Key, Compare> leaf(const_cast<char *>(leaf_page->getRawData()));
+	return leaf.valueAt(index);
+}
+
+template <typename Key, typename Compare>
+BPlusTreeIterator<Key, Compare> &BPlusTreeIterator<Key, Compare>::operator++() {
+	if (leaf_page != nullptr) {
+		index++;
+		skipExhaustedLeaves();
+	}
+	return *this;
+}
+
+template <typename Key, typename Compare>
+void BPlusTreeIterator<Key, Compare>::skipExhaustedLeaves() {
+	while (leaf_page != nullptr) {
+		BPlusTreeLeafPage<Key, Compare> leaf(const_cast<char *>(leaf_page->getRawData()));
+
+		// STEP 1: Still inside this leaf: stop, unless we went past the upper bound
+		if (index < leaf.getSize()) {
+			if (Compare{}(hi, leaf.keyAt(index))) {
+				release();
+			}
+			return;
+		}
+
+		// STEP 2: Leaf exhausted. Page 0 is the superblock, so next_page_id = 0 ends the chain
+		uint32_t next_id = leaf.getNextPageId();
+		if (next_id == 0) {
+			release();
+			return;
+		}
+
+		// STEP 3: Latch the next leaf before letting go of this one (always left to right),
+		// so a merge can't free it in between
+		const Page *next_page = bpm->fetchPageForRead(next_id);
+		if (next_page == nullptr) {
+			release();
+			throw std::runtime_error("Failed to fetch leaf page " + std::to_string(next_id));
+		}
+		bpm->latchPage(next_page, false);
+		release();
+
+		leaf_page = next_page;
+		leaf_id = next_id;
+		index = 0;
+	}
+}
+
+template <typename Key, typename Compare>
+void BPlusTreeIterator<Key, Compare>::release() {
+	if (leaf_page != nullptr) {
+		bpm->unlatchPage(leaf_page, false);
+		bpm->unpinPageForRead(leaf_id, leaf_page);
+		leaf_page = nullptr;
+	}
+}
+
+// --- INSTANTIATIONS ---
+
+template class BPlusTreeIterator<uint32_t>;
+template class BPlusTreeIterator<uint64_t>;
+template class BPlusTreeIterator<SensorKey>;
+template class BPlusTreeIterator<StringKey32>;
+
+} // namespace LuminaDB
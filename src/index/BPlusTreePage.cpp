@@ -1,7 +1,12 @@
 #include "luminadb/index/BPlusTreePage.hpp"
 #include "luminadb/buffer/BufferPoolManager.hpp"
+#include "luminadb/index/KeySearch.hpp"
+#include "luminadb/common/Log.hpp"
+#include <algorithm>
 #include <cstring>
-#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace LuminaDB {
@@ -22,312 +27,912 @@ uint32_t BPlusTreePage::getSize() const { return reinterpret_cast<const BPlusTre
 
 void BPlusTreePage::setSize(uint32_t size) { getHeader()->current_size = size; }
 
-void BPlusTreePage::init(IndexPageType type, uint32_t parent, uint32_t max_keys) {
+uint32_t BPlusTreePage::getMinSize() const { return getHeader()->max_size / 2; }
+
+void BPlusTreePage::init(IndexPageType type, uint32_t max_keys) {
 	BPlusTreeHeader *header = getHeader();
 	header->page_type = type;
-	header->parent_page_id = parent;
 	header->current_size = 0;
 	header->max_size = max_keys;
 	header->next_page_id = 0;
 }
 
-// --- BPlusTreeLeafPage ---
+namespace {
+
+// Entries per page for keys stored as is; leaves and internal nodes use the same number
+template <typename Key> constexpr uint32_t plainMaxSize() {
+	constexpr uint32_t space = PAGE_SIZE - sizeof(BPlusTreeHeader);
+	return std::min<uint32_t>({250, static_cast<uint32_t>(space / (sizeof(Key) + sizeof(RecordID))),
+							   static_cast<uint32_t>((space - sizeof(uint32_t)) / (sizeof(Key) + sizeof(uint32_t)))});
+}
+
+template <typename T> T loadBigEndian(const uint8_t *in) {
+	T value = 0;
+	for (size_t i = 0; i < sizeof(T); i++) {
+		value = static_cast<T>((value << 8) | in[i]);
+	}
+	return value;
+}
 
-// --- ACCESS METHODS ---
+template <typename T> void storeBigEndian(T value, uint8_t *out) {
+	for (size_t i = 0; i < sizeof(T); i++) {
+		out[i] = static_cast<uint8_t>(value >> (8 * (sizeof(T) - 1 - i)));
+	}
+}
 
-// Returns the key at index 'index'
-uint32_t BPlusTreeLeafPage::keyAt(int index) const {
-	// Offset: Header + (index * key size)
-	const char *offset = data + sizeof(BPlusTreeHeader) + (index * sizeof(uint32_t));
-	return *reinterpret_cast<const uint32_t *>(offset);
+// Number of leading indices in [0, count) for which 'before' holds (branchless binary search)
+template <typename Predicate> size_t partitionPoint(size_t count, Predicate before) {
+	size_t base = 0;
+	while (count > 1) {
+		size_t half = count / 2;
+		base = before(base + half - 1) ? base + half : base;
+		count -= half;
+	}
+	return base + (count == 1 && before(base) ? 1 : 0);
 }
 
-// Returns the RecordID at index 'index'
-RecordID BPlusTreeLeafPage::valueAt(int index) const {
-	// The value array starts after the ENTIRE brace array
-	uint32_t header_size = sizeof(BPlusTreeHeader);
-	uint32_t keys_array_size = getHeader()->max_size * sizeof(uint32_t);
+} // namespace
+
+// --- BPlusTreeKeyedPage ---
 
-	const char *offset = data + header_size + keys_array_size + (index * sizeof(RecordID));
-	return *reinterpret_cast<const RecordID *>(offset);
+// --- KEY LAYOUT ---
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+auto BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::encode(const Key &key) -> Encoded {
+	Encoded encoded{};
+	if constexpr (PACKED) {
+		KeyCodec<Key>::encode(key, encoded.data());
+	}
+	return encoded;
 }
 
-// --- SEARCH METHODS ---
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+uint32_t BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::significantLength(const Encoded &encoded) {
+	uint32_t length = WIDTH;
+	while (length > 0 && encoded[length - 1] == 0) {
+		length--;
+	}
+	return length;
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+uint32_t BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::slotWidthFor(uint32_t bytes) {
+	return bytes <= 4 ? 4 : bytes <= 8 ? 8 : bytes;
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+auto BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::layoutFor(const Key *keys, size_t count) -> KeyLayout {
+	if (count == 0) {
+		return {0, 4};
+	}
+
+	// The keys are sorted, so the prefix shared by the first and the last one is shared by all
+	Encoded first = encode(keys[0]);
+	Encoded last = encode(keys[count - 1]);
+	uint32_t prefix = 0;
+	while (prefix < WIDTH && first[prefix] == last[prefix]) {
+		prefix++;
+	}
+
+	// Trailing zeros are not stored: they are implied by the encoding
+	uint32_t longest = 0;
+	for (size_t i = 0; i < count; i++) {
+		longest = std::max(longest, significantLength(encode(keys[i])));
+	}
+
+	return {prefix, slotWidthFor(longest > prefix ? longest - prefix : 0)};
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+uint32_t BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::capacityFor(uint32_t slot_width) {
+	if constexpr (!PACKED) {
+		return plainMaxSize<Key>();
+	} else {
+		// Values start 8-byte aligned after the slots
+		auto fitting = [](uint32_t width) {
+			uint32_t space = PAGE_SIZE - KEYS_OFFSET - EXTRA_VALUES * sizeof(Value);
+			uint32_t capacity = space / (width + sizeof(Value));
+			while (capacity > 0 && (capacity * width + 7) / 8 * 8 + capacity * sizeof(Value) > space) {
+				capacity--;
+			}
+			return capacity;
+		};
+
+		// A full page plus one key of any layout must still split into two halves that fit
+		// with the widest slots, so narrow layouts are capped at twice that capacity
+		return std::min(fitting(slot_width), 2 * fitting(slotWidthFor(WIDTH)) - 1);
+	}
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+const KeyPrefixHeader *BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::prefixHeader() const {
+	return reinterpret_cast<const KeyPrefixHeader *>(data + sizeof(BPlusTreeHeader));
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+uint32_t BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::prefixLength() const {
+	if constexpr (PACKED) {
+		return prefixHeader()->prefix_length;
+	}
+	return 0;
+}
 
-// Find the first index where KeyAt(index) >= key (Binary Search)
-int BPlusTreeLeafPage::lookup(uint32_t key) const {
-	int low = 0, high = getSize() - 1;
-	int index = getSize(); // By default, at the end
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+uint32_t BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::slotWidth() const {
+	if constexpr (PACKED) {
+		return prefixHeader()->slot_width;
+	}
+	return sizeof(Key);
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+const char *BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::keySlot(int index) const {
+	return data + KEYS_OFFSET + index * slotWidth();
+}
 
-	while (low <= high) {
-		int mid = low + (high - low) / 2;
-		if (keyAt(mid) >= key) {
-			index = mid;
-			high = mid - 1;
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+char *BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::keySlot(int index) {
+	return data + KEYS_OFFSET + index * slotWidth();
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+const char *BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::valueSlot(int index) const {
+	// The value array starts after the ENTIRE slot array
+	uint32_t slots_size = (getHeader()->max_size * slotWidth() + 7) / 8 * 8;
+	return data + KEYS_OFFSET + slots_size + index * sizeof(Value);
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+char *BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::valueSlot(int index) {
+	return const_cast<char *>(std::as_const(*this).valueSlot(index));
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+auto BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::encodedKeyAt(int index) const -> Encoded {
+	Encoded encoded{};
+	uint32_t prefix = prefixLength();
+	uint32_t width = slotWidth();
+	const char *slot = keySlot(index);
+
+	std::memcpy(encoded.data(), data + sizeof(BPlusTreeHeader) + sizeof(KeyPrefixHeader), prefix);
+	if (width == 4) {
+		uint32_t suffix;
+		std::memcpy(&suffix, slot, sizeof(suffix));
+		storeBigEndian(suffix, encoded.data() + prefix);
+	} else if (width == 8) {
+		uint64_t suffix;
+		std::memcpy(&suffix, slot, sizeof(suffix));
+		storeBigEndian(suffix, encoded.data() + prefix);
+	} else {
+		std::memcpy(encoded.data() + prefix, slot, width);
+	}
+	return encoded;
+}
+
+// --- SEARCH ---
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+size_t BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::lowerBound(const Key &key) const {
+	uint32_t size = getSize();
+	if constexpr (!PACKED) {
+		return keyLowerBound(reinterpret_cast<const Key *>(data + KEYS_OFFSET), size, key, Compare{});
+	} else {
+		// STEP 1: Outside the page prefix, the key goes before or after every key here
+		Encoded encoded = encode(key);
+		uint32_t prefix = prefixLength();
+		int order = std::memcmp(encoded.data(), data + sizeof(BPlusTreeHeader) + sizeof(KeyPrefixHeader), prefix);
+		if (order != 0) {
+			return order < 0 ? 0 : size;
+		}
+
+		// STEP 2: Compare the slot bytes. A key with more bytes than a slot holds is greater
+		// than every key with the same slot bytes
+		uint32_t width = slotWidth();
+		bool longer = significantLength(encoded) > prefix + width;
+		const char *slots = data + KEYS_OFFSET;
+
+		if (width == 4) {
+			uint32_t suffix = loadBigEndian<uint32_t>(encoded.data() + prefix);
+			const uint32_t *array = reinterpret_cast<const uint32_t *>(slots);
+			return longer ? keyUpperBound(array, size, suffix) : keyLowerBound(array, size, suffix);
+		}
+		if (width == 8) {
+			uint64_t suffix = loadBigEndian<uint64_t>(encoded.data() + prefix);
+			const uint64_t *array = reinterpret_cast<const uint64_t *>(slots);
+			return longer ? keyUpperBound(array, size, suffix) : keyLowerBound(array, size, suffix);
+		}
+		return partitionPoint(size, [&](size_t i) {
+			int slot_order = std::memcmp(slots + i * width, encoded.data() + prefix, width);
+			return slot_order < 0 || (slot_order == 0 && longer);
+		});
+	}
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+size_t BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::upperBound(const Key &key) const {
+	uint32_t size = getSize();
+	if constexpr (!PACKED) {
+		return keyUpperBound(reinterpret_cast<const Key *>(data + KEYS_OFFSET), size, key, Compare{});
+	} else {
+		Encoded encoded = encode(key);
+		uint32_t prefix = prefixLength();
+		int order = std::memcmp(encoded.data(), data + sizeof(BPlusTreeHeader) + sizeof(KeyPrefixHeader), prefix);
+		if (order != 0) {
+			return order < 0 ? 0 : size;
+		}
+
+		// Bytes past the slot only make the key greater, which doesn't move the upper bound
+		uint32_t width = slotWidth();
+		const char *slots = data + KEYS_OFFSET;
+
+		if (width == 4) {
+			return keyUpperBound(reinterpret_cast<const uint32_t *>(slots), size,
+								 loadBigEndian<uint32_t>(encoded.data() + prefix));
+		}
+		if (width == 8) {
+			return keyUpperBound(reinterpret_cast<const uint64_t *>(slots), size,
+								 loadBigEndian<uint64_t>(encoded.data() + prefix));
+		}
+		return partitionPoint(
+			size, [&](size_t i) { return std::memcmp(encoded.data() + prefix, slots + i * width, width) >= 0; });
+	}
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+bool BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::covers(const Key &key) const {
+	if constexpr (!PACKED) {
+		return true;
+	} else {
+		Encoded encoded = encode(key);
+		uint32_t prefix = prefixLength();
+		return std::memcmp(encoded.data(), data + sizeof(BPlusTreeHeader) + sizeof(KeyPrefixHeader), prefix) == 0 &&
+			   significantLength(encoded) <= prefix + slotWidth();
+	}
+}
+
+// --- RAW ACCESS ---
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+void BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::writeKey(int index, const Key &key) {
+	char *slot = keySlot(index);
+	if constexpr (!PACKED) {
+		std::memcpy(slot, &key, sizeof(Key));
+	} else {
+		Encoded encoded = encode(key);
+		uint32_t prefix = prefixLength();
+		uint32_t width = slotWidth();
+		if (width == 4) {
+			uint32_t suffix = loadBigEndian<uint32_t>(encoded.data() + prefix);
+			std::memcpy(slot, &suffix, sizeof(suffix));
+		} else if (width == 8) {
+			uint64_t suffix = loadBigEndian<uint64_t>(encoded.data() + prefix);
+			std::memcpy(slot, &suffix, sizeof(suffix));
 		} else {
-			low = mid + 1;
+			std::memcpy(slot, encoded.data() + prefix, width);
 		}
 	}
-	return index;
 }
 
-// --- DATA WRITE ---
-bool BPlusTreeLeafPage::insert(uint32_t key, const RecordID &value) {
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+void BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::moveKeys(int to, int from, int count) {
+	if (count > 0) {
+		std::memmove(keySlot(to), keySlot(from), static_cast<size_t>(count) * slotWidth());
+	}
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+void BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::moveValues(int to, int from, int count) {
+	if (count > 0) {
+		std::memmove(valueSlot(to), valueSlot(from), static_cast<size_t>(count) * sizeof(Value));
+	}
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+void BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::readEntries(std::vector<Key> &keys,
+																		 std::vector<Value> &values) const {
 	uint32_t size = getSize();
+	keys.clear();
+	values.clear();
+	keys.reserve(size + 1);
+	values.reserve(size + EXTRA_VALUES + 1);
+	for (uint32_t i = 0; i < size; i++) {
+		keys.push_back(keyAt(i));
+	}
+	for (uint32_t i = 0; i < size + EXTRA_VALUES; i++) {
+		values.push_back(valueAt(i));
+	}
+}
 
-	// Find the position where it should go (Binary Search)
-	int index = lookup(key);
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+size_t BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::splitPoint(const std::vector<Key> &keys,
+																		  bool promote_middle, double left_fraction) {
+	size_t total = keys.size();
+	size_t middle = std::min(total - 1, static_cast<size_t>(total * left_fraction));
+	size_t first = 1;
+	size_t last = promote_middle ? total - 2 : total - 1;
+
+	// Walk outwards from the middle until both halves fit
+	for (size_t distance = 0; total >= 2 && distance <= total; distance++) {
+		for (size_t mid : {middle - std::min(distance, middle), middle + distance}) {
+			if (mid < first || mid > last) {
+				continue;
+			}
+			size_t right_start = promote_middle ? mid + 1 : mid;
+			if (fits(keys.data(), mid) && fits(keys.data() + right_start, total - right_start)) {
+				return mid;
+			}
+		}
+	}
+	throw std::runtime_error("B+ Tree node of " + std::to_string(total) + " keys cannot be split into two pages");
+}
 
-	// 2. If the key already exists, it is not inserted
-	if (index < (int)size && keyAt(index) == key) {
-		return false;
+// --- PUBLIC ---
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+bool BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::fits(const Key *keys, size_t count) {
+	if constexpr (!PACKED) {
+		return count <= plainMaxSize<Key>();
+	} else {
+		return count <= capacityFor(layoutFor(keys, count).slot_width);
 	}
+}
 
-	// Check if there is space
-	if (size >= getHeader()->max_size) {
-		return false;
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+uint32_t BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::maxCapacity() {
+	return capacityFor(4);
+}
+
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+size_t BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::fillCount(const Key *keys, size_t count,
+																		 double fill_factor) {
+	auto target = [fill_factor](uint32_t capacity) {
+		return std::max<size_t>(capacity / 2, static_cast<size_t>(capacity * fill_factor));
+	};
+
+	if constexpr (!PACKED) {
+		return std::min(count, target(plainMaxSize<Key>()));
+	} else {
+		// Grow the run one key at a time, keeping its layout up to date, until it overfills the page
+		Encoded first = encode(keys[0]);
+		uint32_t prefix = WIDTH;
+		uint32_t longest = 0;
+		for (size_t n = 1; n <= count; n++) {
+			Encoded encoded = encode(keys[n - 1]);
+			uint32_t shared = 0;
+			while (shared < prefix && first[shared] == encoded[shared]) {
+				shared++;
+			}
+			prefix = shared;
+			longest = std::max(longest, significantLength(encoded));
+
+			uint32_t capacity = capacityFor(slotWidthFor(longest > prefix ? longest - prefix : 0));
+			if (n > target(capacity)) {
+				return n - 1;
+			}
+		}
+		return count;
 	}
+}
 
-	// --- MOTION ARITHMETIC ---
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+Key BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::shortestSeparator(const Key &left, const Key &right) {
+	if constexpr (!PACKED) {
+		return right;
+	} else {
+		// right with every byte after the first one that differs from left zeroed:
+		// still greater than left (that byte is greater) and not greater than right
+		Encoded lower = encode(left);
+		Encoded upper = encode(right);
+		size_t differs = 0;
+		while (differs < WIDTH && lower[differs] == upper[differs]) {
+			differs++;
+		}
+		if (differs >= WIDTH) {
+			return right;
+		}
+		std::memset(upper.data() + differs + 1, 0, WIDTH - differs - 1);
+		return KeyCodec<Key>::decode(upper.data());
+	}
+}
 
-	// A. Move the KEYS to the right
-	// Origin: The start of the key array + (index * 4 bytes)
-	char *key_ptr = data + sizeof(BPlusTreeHeader) + (index * sizeof(uint32_t));
-	// Destination: One key position ahead
-	char *key_dest = key_ptr + sizeof(uint32_t);
-	// Amount: All keys to the right of the index
-	size_t keys_to_move = (size - index) * sizeof(uint32_t);
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+void BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::initKeys(IndexPageType type) {
+	BPlusTreePage::init(type, capacityFor(4));
+	if constexpr (PACKED) {
+		KeyPrefixHeader *layout = reinterpret_cast<KeyPrefixHeader *>(data + sizeof(BPlusTreeHeader));
+		layout->prefix_length = 0;
+		layout->slot_width = 4;
+	}
+}
 
-	if (size > (uint32_t)index) {
-		std::memmove(key_dest, key_ptr, keys_to_move);
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+Key BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::keyAt(int index) const {
+	if constexpr (!PACKED) {
+		Key key;
+		std::memcpy(&key, keySlot(index), sizeof(Key));
+		return key;
+	} else {
+		return KeyCodec<Key>::decode(encodedKeyAt(index).data());
 	}
+}
 
-	// B. Move the VALUES (RecordIDs) to the right
-	// The array of values ​​starts after the ENTIRE keyspace
-	uint32_t header_size = sizeof(BPlusTreeHeader);
-	uint32_t keys_area_size = getHeader()->max_size * sizeof(uint32_t);
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+Value BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::valueAt(int index) const {
+	Value value;
+	std::memcpy(&value, valueSlot(index), sizeof(Value));
+	return value;
+}
 
-	char *val_ptr = data + header_size + keys_area_size + (index * sizeof(RecordID));
-	char *val_dest = val_ptr + sizeof(RecordID);
-	size_t vals_to_move = (size - index) * sizeof(RecordID);
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+void BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::setValueAt(int index, const Value &value) {
+	std::memcpy(valueSlot(index), &value, sizeof(Value));
+}
 
-	if (size > (uint32_t)index) {
-		std::memmove(val_dest, val_ptr, vals_to_move);
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+bool BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::canInsert(const Key &key) const {
+	if (covers(key)) {
+		return getSize() < getHeader()->max_size;
 	}
 
-	// --- DATA WRITE ---
+	// The page would have to be laid out again with the new key
+	std::vector<Key> keys;
+	std::vector<Value> values;
+	readEntries(keys, values);
+	keys.insert(keys.begin() + lowerBound(key), key);
+	return fits(keys.data(), keys.size());
+}
 
-	// Insert the new key
-	*reinterpret_cast<uint32_t *>(key_ptr) = key;
-	*reinterpret_cast<RecordID *>(val_ptr) = value;
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+bool BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::canSetKeyAt(int index, const Key &key) const {
+	if (covers(key)) {
+		return true;
+	}
+	std::vector<Key> keys;
+	std::vector<Value> values;
+	readEntries(keys, values);
+	keys[index] = key;
+	return fits(keys.data(), keys.size());
+}
 
-	setSize(size + 1);
+template <typename Key, typename Compare, typename Value, uint32_t EXTRA_VALUES>
+bool BPlusTreeKeyedPage<Key, Compare, Value, EXTRA_VALUES>::rebuild(const std::vector<Key> &keys,
+																	 const std::vector<Value> &values) {
+	// STEP 1: Pick the layout and check the entries fit with it
+	KeyLayout layout = layoutFor(keys.data(), keys.size());
+	uint32_t max_size = capacityFor(layout.slot_width);
+	if (keys.size() > max_size) {
+		return false;
+	}
 
+	// STEP 2: Header and prefix (the first key holds it, like every other key)
+	getHeader()->max_size = max_size;
+	setSize(static_cast<uint32_t>(keys.size()));
+	if constexpr (PACKED) {
+		KeyPrefixHeader *header = reinterpret_cast<KeyPrefixHeader *>(data + sizeof(BPlusTreeHeader));
+		header->prefix_length = static_cast<uint16_t>(layout.prefix_length);
+		header->slot_width = static_cast<uint16_t>(layout.slot_width);
+
+		char *prefix = data + sizeof(BPlusTreeHeader) + sizeof(KeyPrefixHeader);
+		std::memset(prefix, 0, WIDTH);
+		if (!keys.empty()) {
+			std::memcpy(prefix, encode(keys[0]).data(), layout.prefix_length);
+		}
+	}
+
+	// STEP 3: Slots and values
+	for (size_t i = 0; i < keys.size(); i++) {
+		writeKey(static_cast<int>(i), keys[i]);
+	}
+	for (size_t i = 0; i < values.size(); i++) {
+		setValueAt(static_cast<int>(i), values[i]);
+	}
 	return true;
 }
 
-// --- UTILITY ---
+// --- BPlusTreeLeafPage ---
 
-uint32_t BPlusTreeLeafPage::getNextPageId() const { return getHeader()->next_page_id; }
+template <typename Key, typename Compare>
+void BPlusTreeLeafPage<Key, Compare>::init() {
+	this->initKeys(IndexPageType::LEAF_NODE);
+}
 
-void BPlusTreeLeafPage::setNextPageId(uint32_t next_id) { getHeader()->next_page_id = next_id; }
+// --- SEARCH METHODS ---
 
-// --- SPLIT OPERATION ---
+// Find the first index where KeyAt(index) >= key (vectorized, see KeySearch)
+template <typename Key, typename Compare>
+int BPlusTreeLeafPage<Key, Compare>::lookup(const Key &key) const {
+	return static_cast<int>(this->lowerBound(key));
+}
 
-SplitResult BPlusTreeLeafPage::split(uint32_t key, const RecordID &value, BufferPoolManager *bpm) {
-	uint32_t old_size = getSize();
-	uint32_t total = old_size + 1; // Total entries after inserting new key
-
-	// STEP 1: Create temporary vectors to hold ALL entries (existing + new)
-	std::vector<uint32_t> temp_keys(total);
-	std::vector<RecordID> temp_vals(total);
-
-	// STEP 2: Merge existing entries + new entry into temp arrays (sorted order)
-	uint32_t insert_pos = 0;
-	bool inserted = false;
-
-	for (uint32_t i = 0; i < old_size; i++) {
-		// If we haven't inserted yet and current key is greater, insert here
-		if (!inserted && key < keyAt(i)) {
-			temp_keys[insert_pos] = key;
-			temp_vals[insert_pos] = value;
-			insert_pos++;
-			inserted = true;
-		}
-		// Copy existing entry
-		temp_keys[insert_pos] = keyAt(i);
-		temp_vals[insert_pos] = valueAt(i);
-		insert_pos++;
+// --- DATA WRITE ---
+template <typename Key, typename Compare>
+bool BPlusTreeLeafPage<Key, Compare>::insert(const Key &key, const RecordID &value) {
+	uint32_t size = this->getSize();
+
+	// Find the position where it should go (Binary Search)
+	int index = lookup(key);
+
+	// If the key already exists, it is not inserted
+	if (index < (int)size && this->keysEqual(this->keyAt(index), key)) {
+		return false;
 	}
 
-	// If key is larger than all existing keys, insert at end
-	if (!inserted) {
-		temp_keys[insert_pos] = key;
-		temp_vals[insert_pos] = value;
+	// A key outside the current layout: lay the page out again with it, if it still fits
+	if (!this->covers(key)) {
+		std::vector<Key> keys;
+		std::vector<RecordID> values;
+		this->readEntries(keys, values);
+		keys.insert(keys.begin() + index, key);
+		values.insert(values.begin() + index, value);
+		return this->rebuild(keys, values);
 	}
 
-	// STEP 3: Calculate split point (middle)
-	uint32_t mid = total / 2; // For total=5: mid=2 → [0,1] | [2,3,4]
+	// Check if there is space
+	if (size >= this->getHeader()->max_size) {
+		return false;
+	}
 
-	// STEP 4: Create new sibling page
-	uint32_t new_page_id;
-	Page *new_page = bpm->newPage(new_page_id, ModelType::B_PLUS_TREE);
-	BPlusTreeLeafPage sibling(const_cast<char *>(new_page->getRawData()));
+	// Move every entry from 'index' one position to the right, then write the new one
+	this->moveKeys(index + 1, index, size - index);
+	this->moveValues(index + 1, index, size - index);
+	this->writeKey(index, key);
+	this->setValueAt(index, value);
 
-	// Initialize sibling with same parent and max_size
-	sibling.init(IndexPageType::LEAF_NODE, getHeader()->parent_page_id, getHeader()->max_size);
+	this->setSize(size + 1);
 
-	// Store the page_id in the header
-	sibling.getHeader()->page_id = new_page_id;
+	return true;
+}
 
-	// STEP 5: Redistribute entries
-	// Original page keeps [0...mid-1]
-	// Sibling gets [mid...total-1]
+// --- DATA DELETE ---
 
-	// Clear current page and re-populate with first half
-	setSize(0);
-	for (uint32_t i = 0; i < mid; i++) {
-		insert(temp_keys[i], temp_vals[i]);
+template <typename Key, typename Compare>
+bool BPlusTreeLeafPage<Key, Compare>::remove(const Key &key) {
+	int index = lookup(key);
+	if (index >= (int)this->getSize() || !this->keysEqual(this->keyAt(index), key)) {
+		return false;
 	}
+	removeAt(index);
+	return true;
+}
+
+template <typename Key, typename Compare>
+void BPlusTreeLeafPage<Key, Compare>::removeAt(int index) {
+	uint32_t size = this->getSize();
+
+	// Everything to the right of 'index' moves one position to the left
+	this->moveKeys(index, index + 1, size - index - 1);
+	this->moveValues(index, index + 1, size - index - 1);
+
+	this->setSize(size - 1);
+}
+
+template <typename Key, typename Compare>
+bool BPlusTreeLeafPage<Key, Compare>::absorb(const BPlusTreeLeafPage &right) {
+	std::vector<Key> keys, right_keys;
+	std::vector<RecordID> values, right_values;
+	this->readEntries(keys, values);
+	right.readEntries(right_keys, right_values);
+
+	keys.insert(keys.end(), right_keys.begin(), right_keys.end());
+	values.insert(values.end(), right_values.begin(), right_values.end());
+	return this->rebuild(keys, values);
+}
+
+// --- UTILITY ---
 
-	// Populate sibling with second half
-	for (uint32_t i = mid; i < total; i++) {
-		sibling.insert(temp_keys[i], temp_vals[i]);
+template <typename Key, typename Compare>
+uint32_t BPlusTreeLeafPage<Key, Compare>::getNextPageId() const { return this->getHeader()->next_page_id; }
+
+template <typename Key, typename Compare>
+void BPlusTreeLeafPage<Key, Compare>::setNextPageId(uint32_t next_id) { this->getHeader()->next_page_id = next_id; }
+
+// --- SPLIT OPERATION ---
+
+template <typename Key, typename Compare>
+SplitResult<Key> BPlusTreeLeafPage<Key, Compare>::split(const Key &key, const RecordID &value,
+														 BufferPoolManager *bpm) {
+	// STEP 1: Copy ALL entries (existing + new) in sorted order
+	std::vector<Key> keys;
+	std::vector<RecordID> values;
+	this->readEntries(keys, values);
+
+	int index = lookup(key);
+	keys.insert(keys.begin() + index, key);
+	values.insert(values.begin() + index, value);
+
+	// STEP 2: Calculate split point: the middle, unless packed keys make one half too big
+	// For total=5: mid=2 → [0,1] | [2,3,4]
+	// Appending to the last leaf (increasing keys) keeps it nearly full: nothing will land there again
+	bool appending = index == static_cast<int>(this->getSize()) && this->getNextPageId() == 0;
+	size_t mid = this->splitPoint(keys, false, appending ? RIGHTMOST_SPLIT_FRACTION : 0.5);
+
+	// STEP 3: Create new sibling page
+	uint32_t new_page_id;
+	Page *new_page = bpm->newPage(new_page_id, ModelType::B_PLUS_TREE);
+	if (new_page == nullptr) {
+		throw std::runtime_error("Failed to allocate page for leaf split");
 	}
+	BPlusTreeLeafPage sibling(const_cast<char *>(new_page->getRawData()));
+	sibling.init();
+	sibling.getHeader()->page_id = new_page_id;
+
+	// STEP 4: Redistribute entries
+	// Original page keeps [0...mid-1], sibling gets [mid...total-1], each with its own layout
+	this->rebuild(std::vector<Key>(keys.begin(), keys.begin() + mid),
+				  std::vector<RecordID>(values.begin(), values.begin() + mid));
+	sibling.rebuild(std::vector<Key>(keys.begin() + mid, keys.end()),
+					std::vector<RecordID>(values.begin() + mid, values.end()));
 
-	// STEP 6: Update linked list pointers (maintain leaf chain)
+	// STEP 5: Update linked list pointers (maintain leaf chain)
 	// Before: [this] -> next_old
 	// After:  [this] -> [sibling] -> next_old
 	sibling.setNextPageId(this->getNextPageId());
 	this->setNextPageId(new_page_id);
 
-	// STEP 7: Mark new page as dirty and unpin
-	bpm->unpinPage(new_page_id, true);
+	// STEP 6: The separator only has to split the two halves, so it can be shorter than keys[mid]
+	Key middle_key = this->shortestSeparator(keys[mid - 1], keys[mid]);
 
-	// STEP 8: Return the first key of sibling (to promote to parent)
-	uint32_t middle_key = sibling.keyAt(0);
+	LUMINADB_LOG_DEBUG("SPLIT", "Leaf split complete. Original has " << this->getSize() << " keys, Sibling (page "
+																	 << new_page_id << ") has " << sibling.getSize()
+																	 << " keys. Promoting key=" << middle_key);
+	LUMINADB_TRACE("leaf_split", this->getHeader()->page_id, new_page_id);
 
-	std::cout << "[SPLIT] Leaf split complete. Original has " << getSize() << " keys, Sibling (page " << new_page_id
-			  << ") has " << sibling.getSize() << " keys. Promoting key=" << middle_key << std::endl;
+	// STEP 7: Mark new page as dirty and unpin
+	bpm->unpinPage(new_page_id, true);
 
 	return {middle_key, new_page_id};
 }
 
 // --- BPlusTreeInternalPage ---
 
-uint32_t BPlusTreeInternalPage::keyAt(int index) const {
-	const char *offset = data + sizeof(BPlusTreeHeader) + (index * sizeof(uint32_t));
-	return *reinterpret_cast<const uint32_t *>(offset);
+template <typename Key, typename Compare>
+void BPlusTreeInternalPage<Key, Compare>::init() {
+	this->initKeys(IndexPageType::INTERNAL_NODE);
 }
 
-void BPlusTreeInternalPage::setKeyAt(int index, uint32_t key) {
-	char *offset = data + sizeof(BPlusTreeHeader) + (index * sizeof(uint32_t));
-	*reinterpret_cast<uint32_t *>(offset) = key;
+template <typename Key, typename Compare>
+bool BPlusTreeInternalPage<Key, Compare>::setKeyAt(int index, const Key &key) {
+	if (this->covers(key)) {
+		this->writeKey(index, key);
+		return true;
+	}
+	std::vector<Key> keys;
+	std::vector<uint32_t> children;
+	this->readEntries(keys, children);
+	keys[index] = key;
+	return this->rebuild(keys, children);
 }
 
-uint32_t BPlusTreeInternalPage::valueAt(int index) const {
-	uint32_t header_size = sizeof(BPlusTreeHeader);
-	// Child array starts after maximum brace space
-	uint32_t keys_area_size = getHeader()->max_size * sizeof(uint32_t);
-	const char *offset = data + header_size + keys_area_size + (index * sizeof(uint32_t));
-	return *reinterpret_cast<const uint32_t *>(offset);
+template <typename Key, typename Compare>
+uint32_t BPlusTreeInternalPage<Key, Compare>::lookup(const Key &key) const {
+	// child_i holds the keys in [key_{i-1}, key_i): follow the first separator greater than key
+	return this->valueAt(static_cast<int>(this->upperBound(key)));
 }
 
-void BPlusTreeInternalPage::setValueAt(int index, uint32_t value) {
-	uint32_t header_size = sizeof(BPlusTreeHeader);
-	uint32_t keys_area_size = getHeader()->max_size * sizeof(uint32_t);
-	char *offset = data + header_size + keys_area_size + (index * sizeof(uint32_t));
-	*reinterpret_cast<uint32_t *>(offset) = value;
+template <typename Key, typename Compare>
+bool BPlusTreeInternalPage<Key, Compare>::canTakeSplitOf(const Key &key) const {
+	uint32_t size = this->getSize();
+	if constexpr (!BPlusTreeInternalPage::PACKED) {
+		return size < this->getHeader()->max_size;
+	} else {
+		// The separator of an inner child lies between two keys of this page, so it keeps the
+		// page prefix; next to an edge it may shorten it to nothing. Either way, assume it
+		// needs every byte past the prefix.
+		size_t child = this->upperBound(key);
+		uint32_t prefix = (child > 0 && child < size) ? this->prefixLength() : 0;
+		uint32_t slot_width = std::max(this->slotWidth(), this->slotWidthFor(this->WIDTH - prefix));
+		return size + 1 <= this->capacityFor(slot_width);
+	}
 }
 
-uint32_t BPlusTreeInternalPage::lookup(uint32_t key) const {
-	uint32_t size = getSize();
+// --- INSERT INTO INTERNAL NODE ---
 
-	std::cout << "[Internal] Looking for key=" << key << " in node with size=" << size << std::endl;
+template <typename Key, typename Compare>
+bool BPlusTreeInternalPage<Key, Compare>::insertAfter(const Key &key, uint32_t right_child) {
+	uint32_t size = this->getSize();
 
-	for (uint32_t i = 0; i < size; ++i) {
-		uint32_t current_key = keyAt(i);
-		std::cout << "  Checking keyAt(" << i << ")=" << current_key;
+	// STEP 1: Find the correct position to insert (maintain key order)
+	// Internal nodes store: [child_0] key_0 [child_1] key_1 ... [child_n]
+	int insert_idx = static_cast<int>(this->lowerBound(key));
+
+	// STEP 2: A key outside the current layout: lay the node out again with it, if it still fits
+	if (!this->covers(key)) {
+		std::vector<Key> keys;
+		std::vector<uint32_t> children;
+		this->readEntries(keys, children);
+		keys.insert(keys.begin() + insert_idx, key);
+		children.insert(children.begin() + insert_idx + 1, right_child);
+		return this->rebuild(keys, children);
+	}
 
-		if (key < current_key) {
-			uint32_t child = valueAt(i);
-			std::cout << " -> Going to child valueAt(" << i << ")=" << child << std::endl;
-			return child;
-		}
-		std::cout << " (skip)" << std::endl;
+	// STEP 3: Check if there is space for 1 more key and 1 more child pointer
+	if (size >= this->getHeader()->max_size) {
+		return false; // No space, need split (handled elsewhere)
 	}
 
-	uint32_t rightmost = valueAt(size);
-	std::cout << "  -> Going to rightmost child valueAt(" << size << ")=" << rightmost << std::endl;
-	return rightmost;
-}
+	// STEP 4: Make room: keys from insert_idx and children from insert_idx+1 move one position right
+	this->moveKeys(insert_idx + 1, insert_idx, size - insert_idx);
+	this->moveValues(insert_idx + 2, insert_idx + 1, size - insert_idx);
 
-// --- INSERT INTO INTERNAL NODE ---
+	// STEP 5: The key goes at insert_idx, the right_child becomes the child at insert_idx + 1
+	this->writeKey(insert_idx, key);
+	this->setValueAt(insert_idx + 1, right_child);
 
-bool BPlusTreeInternalPage::insertAfter(uint32_t key, uint32_t right_child) {
-	uint32_t size = getSize();
+	// STEP 6: Update size
+	this->setSize(size + 1);
 
-	// STEP 1: Check if there is space
-	// Internal nodes store: [child_0] key_0 [child_1] key_1 ... [child_n]
-	// So we need space for 1 more key and 1 more child pointer
-	if (size >= getHeader()->max_size) {
-		return false; // No space, need split (handled elsewhere)
-	}
+	LUMINADB_LOG_TRACE("INSERT_AFTER", "Inserted key=" << key << " with right_child=" << right_child << " at index="
+														<< insert_idx << ". Node now has " << this->getSize()
+														<< " keys.");
 
-	// STEP 2: Find the correct position to insert (maintain key order)
-	// We search for the position where the new key should go
-	int insert_idx = 0;
-	while (insert_idx < (int)size && keyAt(insert_idx) < key) {
-		insert_idx++;
+	return true;
+}
+
+// --- DELETE FROM INTERNAL NODE ---
+
+template <typename Key, typename Compare>
+int BPlusTreeInternalPage<Key, Compare>::childIndex(uint32_t child_id) const {
+	for (uint32_t i = 0; i <= this->getSize(); i++) {
+		if (this->valueAt(i) == child_id) {
+			return static_cast<int>(i);
+		}
 	}
+	return -1;
+}
 
-	// STEP 3: Move all keys from insert_idx onwards to the right
-	// We need to make space for the new key
+template <typename Key, typename Compare>
+void BPlusTreeInternalPage<Key, Compare>::removeAt(int index) {
+	uint32_t size = this->getSize();
 
-	// Calculate source and destination for key movement
-	uint32_t header_size = sizeof(BPlusTreeHeader);
-	uint32_t keys_area_size = getHeader()->max_size * sizeof(uint32_t);
+	// Keys (index, size) and children (index+1, size] shift one position to the left
+	this->moveKeys(index, index + 1, size - index - 1);
+	this->moveValues(index + 1, index + 2, size - index - 1);
+	this->setSize(size - 1);
+}
 
-	// Starting position of the key to move (at insert_idx)
-	char *key_src = data + header_size + (insert_idx * sizeof(uint32_t));
-	// Where it should go (one position to the right)
-	char *key_dest = key_src + sizeof(uint32_t);
-	// How many bytes to move (all keys from insert_idx to end)
-	size_t keys_to_move = (size - insert_idx) * sizeof(uint32_t);
+template <typename Key, typename Compare>
+void BPlusTreeInternalPage<Key, Compare>::removeFirst() {
+	uint32_t size = this->getSize();
 
-	// Move keys to the right
-	if (size > (uint32_t)insert_idx) {
-		std::memmove(key_dest, key_src, keys_to_move);
+	this->moveKeys(0, 1, size - 1);
+	this->moveValues(0, 1, size);
+	this->setSize(size - 1);
+}
+
+template <typename Key, typename Compare>
+bool BPlusTreeInternalPage<Key, Compare>::pushFront(uint32_t child, const Key &key) {
+	uint32_t size = this->getSize();
+
+	if (!this->covers(key)) {
+		std::vector<Key> keys;
+		std::vector<uint32_t> children;
+		this->readEntries(keys, children);
+		keys.insert(keys.begin(), key);
+		children.insert(children.begin(), child);
+		return this->rebuild(keys, children);
+	}
+	if (size >= this->getHeader()->max_size) {
+		return false;
 	}
 
-	// STEP 4: Move all child pointers from insert_idx+1 onwards to the right
-	// Child pointers are stored after the entire key space
+	// Make room at position 0 in both arrays
+	this->moveKeys(1, 0, size);
+	this->moveValues(1, 0, size + 1);
+	this->writeKey(0, key);
+	this->setValueAt(0, child);
+	this->setSize(size + 1);
+	return true;
+}
 
-	// Starting position of the child to move (at insert_idx + 1)
-	char *child_src = data + header_size + keys_area_size + ((insert_idx + 1) * sizeof(uint32_t));
-	// Where it should go (one position to the right)
-	char *child_dest = child_src + sizeof(uint32_t);
-	// How many bytes to move (all children from insert_idx+1 to end)
-	size_t children_to_move = (size - insert_idx) * sizeof(uint32_t);
+template <typename Key, typename Compare>
+bool BPlusTreeInternalPage<Key, Compare>::pushBack(const Key &key, uint32_t child) {
+	uint32_t size = this->getSize();
+
+	if (!this->covers(key)) {
+		std::vector<Key> keys;
+		std::vector<uint32_t> children;
+		this->readEntries(keys, children);
+		keys.push_back(key);
+		children.push_back(child);
+		return this->rebuild(keys, children);
+	}
+	if (size >= this->getHeader()->max_size) {
+		return false;
+	}
+
+	this->writeKey(size, key);
+	this->setValueAt(size + 1, child);
+	this->setSize(size + 1);
+	return true;
+}
+
+template <typename Key, typename Compare>
+bool BPlusTreeInternalPage<Key, Compare>::absorb(const Key &separator, const BPlusTreeInternalPage &right) {
+	std::vector<Key> keys, right_keys;
+	std::vector<uint32_t> children, right_children;
+	this->readEntries(keys, children);
+	right.readEntries(right_keys, right_children);
+
+	// The separator comes down between the two key runs
+	keys.push_back(separator);
+	keys.insert(keys.end(), right_keys.begin(), right_keys.end());
+	children.insert(children.end(), right_children.begin(), right_children.end());
+	return this->rebuild(keys, children);
+}
 
-	// Move children pointers to the right
-	if (size > (uint32_t)insert_idx) {
-		std::memmove(child_dest, child_src, children_to_move);
+// --- SPLIT INTERNAL NODE ---
+
+template <typename Key, typename Compare>
+SplitResult<Key> BPlusTreeInternalPage<Key, Compare>::split(const Key &key, uint32_t right_child,
+															 BufferPoolManager *bpm) {
+	// STEP 1: Copy keys and children, placing the new pair in order
+	// Layout: [child_0] key_0 [child_1] ... key_{n-1} [child_n]
+	std::vector<Key> keys;
+	std::vector<uint32_t> children;
+	this->readEntries(keys, children);
+
+	size_t insert_idx = this->lowerBound(key);
+	keys.insert(keys.begin() + insert_idx, key);
+	children.insert(children.begin() + insert_idx + 1, right_child);
+
+	// STEP 2: Split point. keys[mid] goes up to the parent
+	// For total=5: mid=2 -> left [k0,k1] (3 children) | up k2 | right [k3,k4] (3 children)
+	// The rightmost child split: the next separators will come after this one too (see LeafPage::split)
+	bool appending = insert_idx == this->getSize();
+	size_t mid = this->splitPoint(keys, true, appending ? RIGHTMOST_SPLIT_FRACTION : 0.5);
+	Key middle_key = keys[mid];
+
+	// STEP 3: Create the new sibling (same parent)
+	uint32_t new_page_id;
+	Page *new_page = bpm->newPage(new_page_id, ModelType::B_PLUS_TREE);
+	if (new_page == nullptr) {
+		throw std::runtime_error("Failed to allocate page for internal node split");
 	}
+	BPlusTreeInternalPage sibling(const_cast<char *>(new_page->getRawData()));
+	sibling.init();
+	sibling.getHeader()->page_id = new_page_id;
 
-	// STEP 5: Insert the new key and right child
-	// The key goes at insert_idx
-	setKeyAt(insert_idx, key);
-	// The right_child becomes the child at insert_idx + 1
-	setValueAt(insert_idx + 1, right_child);
+	// STEP 4: Left half stays here: keys [0, mid), children [0, mid]
+	this->rebuild(std::vector<Key>(keys.begin(), keys.begin() + mid),
+				  std::vector<uint32_t>(children.begin(), children.begin() + mid + 1));
 
-	// STEP 6: Update size
-	setSize(size + 1);
+	// STEP 5: Right half goes to the sibling: keys (mid, total), children [mid+1, total]
+	sibling.rebuild(std::vector<Key>(keys.begin() + mid + 1, keys.end()),
+					std::vector<uint32_t>(children.begin() + mid + 1, children.end()));
 
-	std::cout << "[INSERT_AFTER] Inserted key=" << key << " with right_child=" << right_child
-			  << " at index=" << insert_idx << ". Node now has " << getSize() << " keys." << std::endl;
+	// STEP 6: Mark new page as dirty and unpin
+	bpm->unpinPage(new_page_id, true);
 
-	return true;
+	LUMINADB_LOG_DEBUG("SPLIT", "Internal split complete. Original has " << this->getSize() << " keys, Sibling (page "
+																		 << new_page_id << ") has " << sibling.getSize()
+																		 << " keys. Promoting key=" << middle_key);
+	LUMINADB_TRACE("internal_split", this->getHeader()->page_id, new_page_id);
+
+	return {middle_key, new_page_id};
 }
 
-}
\ No newline at end of file
+// --- INSTANTIATIONS ---
+// The page templates are compiled here for every key type the engine supports.
+// A new key type needs a line here and in BPlusTree.cpp, BPlusTreeIterator.cpp and Database.cpp.
+
+template class BPlusTreeKeyedPage<uint32_t, std::less<uint32_t>, RecordID, 0>;
+template class BPlusTreeKeyedPage<uint64_t, std::less<uint64_t>, RecordID, 0>;
+template class BPlusTreeKeyedPage<SensorKey, std::less<SensorKey>, RecordID, 0>;
+template class BPlusTreeKeyedPage<StringKey32, std::less<StringKey32>, RecordID, 0>;
+
+template class BPlusTreeKeyedPage<uint32_t, std::less<uint32_t>, uint32_t, 1>;
+template class BPlusTreeKeyedPage<uint64_t, std::less<uint64_t>, uint32_t, 1>;
+template class BPlusTreeKeyedPage<SensorKey, std::less<SensorKey>, uint32_t, 1>;
+template class BPlusTreeKeyedPage<StringKey32, std::less<StringKey32>, uint32_t, 1>;
+
+template class BPlusTreeLeafPage<uint32_t>;
+template class BPlusTreeLeafPage<uint64_t>;
+template class BPlusTreeLeafPage<SensorKey>;
+template class BPlusTreeLeafPage<StringKey32>;
+
+template class BPlusTreeInternalPage<uint32_t>;
+template class BPlusTreeInternalPage<uint64_t>;
+template class BPlusTreeInternalPage<SensorKey>;
+template class BPlusTreeInternalPage<StringKey32>;
+
+} // namespace LuminaDB
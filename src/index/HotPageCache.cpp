@@ -0,0 +1,134 @@
+#include "luminadb/index/HotPageCache.hpp"
+#include "luminadb/common/Log.hpp"
+
+#include <vector>
+
+namespace LuminaDB {
+
+HotPageCache::HotPageCache(BufferPoolManager *bpm_param, size_t capacity_param)
+	: bpm(bpm_param), capacity(capacity_param), count(0), version(0) {
+	size_t slot_count = 1;
+	while (slot_count < 2 * capacity) {
+		slot_count *= 2;
+	}
+	slots = std::make_unique<Slot[]>(slot_count);
+	mask = slot_count - 1;
+}
+
+HotPageCache::~HotPageCache() {
+	// Destructors must not throw; the pins only matter while the pool lives
+	for (size_t i = 0; i <= mask; i++) {
+		uint32_t page_id = slots[i].page_id.load(std::memory_order_relaxed);
+		if (page_id != INVALID_PAGE_ID) {
+			bpm->unpinPage(page_id, false);
+		}
+	}
+}
+
+size_t HotPageCache::home(uint32_t page_id) const {
+	// Fibonacci hashing: consecutive page ids land far apart
+	return static_cast<size_t>((static_cast<uint64_t>(page_id) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+void HotPageCache::beginWrite() {
+	version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+void HotPageCache::endWrite() { version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+void HotPageCache::place(uint32_t page_id, Page *page) {
+	size_t i = home(page_id);
+	while (slots[i].page_id.load(std::memory_order_relaxed) != INVALID_PAGE_ID) {
+		i = (i + 1) & mask;
+	}
+	slots[i].page.store(page, std::memory_order_relaxed);
+	slots[i].page_id.store(page_id, std::memory_order_relaxed);
+}
+
+Page *HotPageCache::lookup(uint32_t page_id) const {
+	if (capacity == 0) {
+		return nullptr;
+	}
+
+	// STEP 1: A table being changed is a miss
+	uint64_t seen = version.load(std::memory_order_acquire);
+	if (seen & 1) {
+		return nullptr;
+	}
+
+	// STEP 2: Probe from the page's home slot up to the first empty one. A table torn by a
+	// change may have none, so the probe stops after one lap
+	Page *found = nullptr;
+	size_t i = home(page_id);
+	for (size_t probes = 0; probes <= mask; probes++, i = (i + 1) & mask) {
+		uint32_t slot_id = slots[i].page_id.load(std::memory_order_relaxed);
+		if (slot_id == page_id) {
+			found = slots[i].page.load(std::memory_order_relaxed);
+			break;
+		}
+		if (slot_id == INVALID_PAGE_ID) {
+			break;
+		}
+	}
+
+	// STEP 3: Only trust what was read if no change started meanwhile
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (version.load(std::memory_order_relaxed) != seen) {
+		return nullptr;
+	}
+	return found;
+}
+
+void HotPageCache::admit(uint32_t page_id) {
+	std::lock_guard<std::mutex> lock(latch);
+	if (count.load(std::memory_order_relaxed) >= capacity || lookup(page_id) != nullptr) {
+		return;
+	}
+
+	// The caller has it pinned, so this only adds the cache's own pin to the same frame
+	Page *page = bpm->fetchPage(page_id);
+	if (page == nullptr) {
+		return;
+	}
+
+	beginWrite();
+	place(page_id, page);
+	count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	endWrite();
+
+	LUMINADB_TRACE("hot_admit", page_id, count.load(std::memory_order_relaxed));
+}
+
+void HotPageCache::evict(uint32_t page_id) {
+	std::lock_guard<std::mutex> lock(latch);
+	if (lookup(page_id) == nullptr) {
+		return;
+	}
+
+	// STEP 1: Rebuild the table without the page (it changes rarely; no tombstones to probe past)
+	std::vector<std::pair<uint32_t, Page *>> kept;
+	for (size_t i = 0; i <= mask; i++) {
+		uint32_t slot_id = slots[i].page_id.load(std::memory_order_relaxed);
+		if (slot_id != INVALID_PAGE_ID && slot_id != page_id) {
+			kept.emplace_back(slot_id, slots[i].page.load(std::memory_order_relaxed));
+		}
+	}
+
+	beginWrite();
+	for (size_t i = 0; i <= mask; i++) {
+		slots[i].page_id.store(INVALID_PAGE_ID, std::memory_order_relaxed);
+		slots[i].page.store(nullptr, std::memory_order_relaxed);
+	}
+	for (const auto &[kept_id, kept_page] : kept) {
+		place(kept_id, kept_page);
+	}
+	count.store(kept.size(), std::memory_order_relaxed);
+	endWrite();
+
+	// STEP 2: Nobody reaches the page through the cache any more: let the pool have it
+	bpm->unpinPage(page_id, false);
+	LUMINADB_TRACE("hot_evict", page_id, kept.size());
+}
+
+} // namespace LuminaDB
@@ -0,0 +1,168 @@
+#include "luminadb/index/KeySearch.hpp"
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define LUMINADB_KEY_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace LuminaDB {
+
+namespace {
+
+// Keys of the window compared at once after the halving steps (a few vector compares)
+constexpr size_t SEARCH_WINDOW = 32;
+
+using CountLessFn = size_t (*)(const uint32_t *keys, size_t count, uint32_t key);
+using CountLess64Fn = size_t (*)(const uint64_t *keys, size_t count, uint64_t key);
+
+struct KeySearchImpl {
+	CountLessFn count_less;
+	CountLess64Fn count_less64;
+	const char *name;
+};
+
+// How many keys are < key. The array is sorted, so this is also the lower bound
+size_t countLessScalar(const uint32_t *keys, size_t count, uint32_t key) {
+	size_t less = 0;
+	for (size_t i = 0; i < count; i++) {
+		less += keys[i] < key;
+	}
+	return less;
+}
+
+size_t countLess64Scalar(const uint64_t *keys, size_t count, uint64_t key) {
+	size_t less = 0;
+	for (size_t i = 0; i < count; i++) {
+		less += keys[i] < key;
+	}
+	return less;
+}
+
+#ifdef LUMINADB_KEY_SEARCH_X86
+
+// SSE2/AVX2 only compare signed integers: flipping the top bit turns unsigned order into signed order
+
+size_t countLessSse2(const uint32_t *keys, size_t count, uint32_t key) {
+	const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+	const __m128i needle = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(key)), bias);
+
+	size_t less = 0;
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+		__m128i lt = _mm_cmpgt_epi32(needle, _mm_xor_si128(chunk, bias));
+		less += std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(lt))));
+	}
+	return less + countLessScalar(keys + i, count - i, key);
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LUMINADB_KEY_SEARCH_AVX2 1
+
+__attribute__((target("avx2"))) size_t countLessAvx2(const uint32_t *keys, size_t count, uint32_t key) {
+	const __m256i bias = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+	const __m256i needle = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(key)), bias);
+
+	size_t less = 0;
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+		__m256i lt = _mm256_cmpgt_epi32(needle, _mm256_xor_si256(chunk, bias));
+		less += std::popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(lt))));
+	}
+	return less + countLessSse2(keys + i, count - i, key);
+}
+
+// SSE2 has no 64-bit compare: without AVX2 the 64-bit window is counted by the scalar loop
+__attribute__((target("avx2"))) size_t countLess64Avx2(const uint64_t *keys, size_t count, uint64_t key) {
+	const __m256i bias = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+	const __m256i needle = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(key)), bias);
+
+	size_t less = 0;
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+		__m256i lt = _mm256_cmpgt_epi64(needle, _mm256_xor_si256(chunk, bias));
+		less += std::popcount(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(lt))));
+	}
+	return less + countLess64Scalar(keys + i, count - i, key);
+}
+#endif
+
+#endif
+
+// Every implementation this build can run on this CPU, the preferred one first
+std::vector<KeySearchImpl> availableKeySearches() {
+	std::vector<KeySearchImpl> impls;
+#ifdef LUMINADB_KEY_SEARCH_AVX2
+	if (__builtin_cpu_supports("avx2")) {
+		impls.push_back({countLessAvx2, countLess64Avx2, "avx2"});
+	}
+#endif
+#ifdef LUMINADB_KEY_SEARCH_X86
+	// Part of the x86-64 baseline
+	impls.push_back({countLessSse2, countLess64Scalar, "sse2"});
+#endif
+	impls.push_back({countLessScalar, countLess64Scalar, "scalar"});
+	return impls;
+}
+
+KeySearchImpl &activeKeySearch() {
+	static KeySearchImpl impl = availableKeySearches().front();
+	return impl;
+}
+
+// The answer stays in [base, base + count]; the comparison compiles to a conditional move
+template <typename Int, typename CountFn>
+size_t narrowAndCount(const Int *keys, size_t count, Int key, size_t window, CountFn count_less) {
+	size_t base = 0;
+	while (count > window) {
+		size_t half = count / 2;
+		base = (keys[base + half] < key) ? base + half : base;
+		count -= half;
+	}
+	return base + count_less(keys + base, count, key);
+}
+
+} // namespace
+
+size_t keyLowerBound(const uint32_t *keys, size_t count, uint32_t key) {
+	return narrowAndCount(keys, count, key, SEARCH_WINDOW, activeKeySearch().count_less);
+}
+
+size_t keyLowerBound(const uint64_t *keys, size_t count, uint64_t key) {
+	// Half the keys per vector: a smaller window keeps the same number of compares
+	return narrowAndCount(keys, count, key, SEARCH_WINDOW / 2, activeKeySearch().count_less64);
+}
+
+// Integer keys: "> key" is ">= key + 1"
+size_t keyUpperBound(const uint32_t *keys, size_t count, uint32_t key) {
+	if (key == UINT32_MAX) {
+		return count;
+	}
+	return keyLowerBound(keys, count, key + 1);
+}
+
+size_t keyUpperBound(const uint64_t *keys, size_t count, uint64_t key) {
+	if (key == UINT64_MAX) {
+		return count;
+	}
+	return keyLowerBound(keys, count, key + 1);
+}
+
+const char *keySearchImplementation() { return activeKeySearch().name; }
+
+bool setKeySearchImplementation(const char *name) {
+	for (const KeySearchImpl &impl : availableKeySearches()) {
+		if (std::strcmp(impl.name, name) == 0) {
+			activeKeySearch() = impl;
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace LuminaDB
@@ -0,0 +1,462 @@
+#include "luminadb/index/PostingList.hpp"
+#include "luminadb/common/Log.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace LuminaDB {
+
+PostingStore::PostingStore(BufferPoolManager *bpm_param) : bpm(bpm_param), current_page_id(INVALID_PAGE_ID) {}
+
+RecordID PostingStore::readEntry(const char *at) {
+	RecordID value;
+	std::memcpy(&value.page_id, at, sizeof(value.page_id));
+	std::memcpy(&value.slot_num, at + sizeof(value.page_id), sizeof(value.slot_num));
+	return value;
+}
+
+void PostingStore::writeEntry(char *at, const RecordID &value) {
+	std::memcpy(at, &value.page_id, sizeof(value.page_id));
+	std::memcpy(at + sizeof(value.page_id), &value.slot_num, sizeof(value.slot_num));
+}
+
+std::vector<char> PostingStore::serializeRecord(const PostingHeader &header, const std::vector<RecordID> &entries) {
+	std::vector<char> buffer(sizeof(PostingHeader) + entries.size() * ENTRY_SIZE);
+	std::memcpy(buffer.data(), &header, sizeof(PostingHeader));
+	for (size_t i = 0; i < entries.size(); i++) {
+		writeEntry(buffer.data() + sizeof(PostingHeader) + i * ENTRY_SIZE, entries[i]);
+	}
+	return buffer;
+}
+
+RecordID PostingStore::storeRecord(const PostingHeader &header, const std::vector<RecordID> &entries) {
+	std::vector<char> buffer = serializeRecord(header, entries);
+	uint16_t record_size = static_cast<uint16_t>(buffer.size());
+	uint16_t slot_num = 0;
+
+	// STEP 1: The page that took the last new record, if it still has room
+	if (current_page_id != INVALID_PAGE_ID) {
+		Page *page = bpm->fetchPage(current_page_id);
+		if (page == nullptr) {
+			throw std::runtime_error("Posting list page not found: " + std::to_string(current_page_id));
+		}
+		bpm->latchPage(page, true);
+		bool stored = page->insertRecord(buffer.data(), record_size, slot_num);
+		bpm->unlatchPage(page, true);
+		bpm->unpinPage(current_page_id, stored);
+
+		if (stored) {
+			return {current_page_id, static_cast<uint16_t>(slot_num | POSTING_LIST_FLAG)};
+		}
+	}
+
+	// STEP 2: A new page, which takes the next records too
+	uint32_t page_id;
+	Page *page = bpm->newPage(page_id, ModelType::POSTING_LIST);
+	if (page == nullptr) {
+		throw std::runtime_error("Failed to allocate posting list page");
+	}
+	bpm->latchPage(page, true);
+	bool stored = page->insertRecord(buffer.data(), record_size, slot_num);
+	bpm->unlatchPage(page, true);
+	bpm->unpinPage(page_id, true);
+
+	if (!stored) {
+		throw std::runtime_error("Posting list record does not fit in a page");
+	}
+
+	// The old current page is full; it is freed once the lists it holds are gone
+	current_page_id = page_id;
+
+	LUMINADB_TRACE("posting_page_alloc", page_id, 0);
+	return {page_id, static_cast<uint16_t>(slot_num | POSTING_LIST_FLAG)};
+}
+
+void PostingStore::deleteRecord(const RecordID &list) {
+	uint16_t slot_num = list.slot_num & ~POSTING_LIST_FLAG;
+
+	Page *page = bpm->fetchPage(list.page_id);
+	if (page == nullptr) {
+		throw std::runtime_error("Posting list page not found: " + std::to_string(list.page_id));
+	}
+	bpm->latchPage(page, true);
+	page->deleteRecord(slot_num);
+	bool empty = page->getLiveCount() == 0;
+	bpm->unlatchPage(page, true);
+	bpm->unpinPage(list.page_id, true);
+
+	// Only lists can reach a posting page, so an empty one is unreachable (new records go to current_page_id)
+	if (empty && list.page_id != current_page_id) {
+		freePage(list.page_id);
+	}
+}
+
+PostingHeader PostingStore::readRecord(const RecordID &list, std::vector<RecordID> &entries) {
+	uint16_t slot_num = list.slot_num & ~POSTING_LIST_FLAG;
+
+	Page *page = bpm->fetchPage(list.page_id);
+	if (page == nullptr) {
+		throw std::runtime_error("Posting list page not found: " + std::to_string(list.page_id));
+	}
+	bpm->latchPage(page, false);
+
+	uint16_t record_size = 0;
+	const char *record = page->getRecord(slot_num, record_size);
+	if (record == nullptr) {
+		bpm->unlatchPage(page, false);
+		bpm->unpinPage(list.page_id, false);
+		throw std::runtime_error("Posting list record not found in page: " + std::to_string(list.page_id));
+	}
+
+	PostingHeader header;
+	std::memcpy(&header, record, sizeof(PostingHeader));
+	entries.clear();
+	for (uint16_t i = 0; i < header.count; i++) {
+		entries.push_back(readEntry(record + sizeof(PostingHeader) + i * ENTRY_SIZE));
+	}
+
+	bpm->unlatchPage(page, false);
+	bpm->unpinPage(list.page_id, false);
+	return header;
+}
+
+void PostingStore::overwriteRecord(const RecordID &list, const PostingHeader &header,
+								   const std::vector<RecordID> &entries) {
+	uint16_t slot_num = list.slot_num & ~POSTING_LIST_FLAG;
+	std::vector<char> buffer = serializeRecord(header, entries);
+
+	Page *page = bpm->fetchPage(list.page_id);
+	if (page == nullptr) {
+		throw std::runtime_error("Posting list page not found: " + std::to_string(list.page_id));
+	}
+	bpm->latchPage(page, true);
+
+	uint16_t record_size = 0;
+	char *record = const_cast<char *>(page->getRecord(slot_num, record_size));
+	if (record == nullptr || record_size != buffer.size()) {
+		bpm->unlatchPage(page, true);
+		bpm->unpinPage(list.page_id, false);
+		throw std::runtime_error("Posting list record changed size in page: " + std::to_string(list.page_id));
+	}
+	std::memcpy(record, buffer.data(), buffer.size());
+
+	bpm->unlatchPage(page, true);
+	bpm->unpinPage(list.page_id, true);
+}
+
+RecordID PostingStore::replaceRecord(const RecordID &list, const PostingHeader &header,
+									 const std::vector<RecordID> &entries) {
+	uint16_t slot_num = list.slot_num & ~POSTING_LIST_FLAG;
+	std::vector<char> buffer = serializeRecord(header, entries);
+
+	// STEP 1: Same page if the new size fits there (the list keeps its neighbours)
+	Page *page = bpm->fetchPage(list.page_id);
+	if (page == nullptr) {
+		throw std::runtime_error("Posting list page not found: " + std::to_string(list.page_id));
+	}
+	bpm->latchPage(page, true);
+	page->deleteRecord(slot_num);
+
+	uint16_t new_slot = 0;
+	bool stored = page->insertRecord(buffer.data(), static_cast<uint16_t>(buffer.size()), new_slot);
+	bool empty = !stored && page->getLiveCount() == 0;
+	bpm->unlatchPage(page, true);
+	bpm->unpinPage(list.page_id, true);
+
+	if (stored) {
+		return {list.page_id, static_cast<uint16_t>(new_slot | POSTING_LIST_FLAG)};
+	}
+
+	// STEP 2: Elsewhere
+	if (empty && list.page_id != current_page_id) {
+		freePage(list.page_id);
+	}
+	return storeRecord(header, entries);
+}
+
+RecordID PostingStore::popOverflow(PostingHeader &header) {
+	uint32_t head_id = header.overflow_page_id;
+
+	Page *page = bpm->fetchPage(head_id);
+	if (page == nullptr) {
+		throw std::runtime_error("Posting overflow page not found: " + std::to_string(head_id));
+	}
+	bpm->latchPage(page, true);
+
+	char *data = const_cast<char *>(page->getRawData()) + sizeof(PageHeader);
+	PostingOverflowHeader overflow;
+	std::memcpy(&overflow, data, sizeof(PostingOverflowHeader));
+
+	overflow.count--;
+	RecordID value = readEntry(data + sizeof(PostingOverflowHeader) + overflow.count * ENTRY_SIZE);
+	std::memcpy(data, &overflow, sizeof(PostingOverflowHeader));
+
+	bpm->unlatchPage(page, true);
+	bpm->unpinPage(head_id, true);
+
+	// The head is the only page with room; once empty, the next one takes its place
+	if (overflow.count == 0) {
+		header.overflow_page_id = overflow.next_page_id;
+		freePage(head_id);
+	}
+	return value;
+}
+
+void PostingStore::freePage(uint32_t page_id) {
+	retryPendingFrees();
+	if (bpm->deletePage(page_id)) {
+		LUMINADB_TRACE("posting_page_free", page_id, 0);
+	} else {
+		pending_free.push_back(page_id);
+		LUMINADB_LOG_WARN("PostingStore", "Page " << page_id << " is pinned, freed later");
+	}
+}
+
+void PostingStore::retryPendingFrees() {
+	size_t kept = 0;
+	for (uint32_t page_id : pending_free) {
+		if (bpm->deletePage(page_id)) {
+			LUMINADB_TRACE("posting_page_free", page_id, 0);
+		} else {
+			pending_free[kept++] = page_id;
+		}
+	}
+	pending_free.resize(kept);
+}
+
+void PostingStore::freePendingPages() {
+	std::lock_guard<std::mutex> lock(latch);
+	retryPendingFrees();
+}
+
+RecordID PostingStore::create(const RecordID &first, const RecordID &second) {
+	std::lock_guard<std::mutex> lock(latch);
+	return storeRecord({2, 0, INVALID_PAGE_ID}, {first, second});
+}
+
+RecordID PostingStore::append(const RecordID &list, const RecordID &value) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	// STEP 1: Room in the record: it grows (and may move)
+	std::vector<RecordID> entries;
+	PostingHeader header = readRecord(list, entries);
+	if (entries.size() < RECORD_CAPACITY) {
+		entries.push_back(value);
+		header.count = static_cast<uint16_t>(entries.size());
+		return replaceRecord(list, header, entries);
+	}
+
+	// STEP 2: The first overflow page, if it has room
+	if (header.overflow_page_id != INVALID_PAGE_ID) {
+		Page *page = bpm->fetchPage(header.overflow_page_id);
+		if (page == nullptr) {
+			throw std::runtime_error("Posting overflow page not found: " + std::to_string(header.overflow_page_id));
+		}
+		bpm->latchPage(page, true);
+
+		char *data = const_cast<char *>(page->getRawData()) + sizeof(PageHeader);
+		PostingOverflowHeader overflow;
+		std::memcpy(&overflow, data, sizeof(PostingOverflowHeader));
+
+		bool stored = overflow.count < OVERFLOW_CAPACITY;
+		if (stored) {
+			writeEntry(data + sizeof(PostingOverflowHeader) + overflow.count * ENTRY_SIZE, value);
+			overflow.count++;
+			std::memcpy(data, &overflow, sizeof(PostingOverflowHeader));
+		}
+
+		bpm->unlatchPage(page, true);
+		bpm->unpinPage(header.overflow_page_id, stored);
+		if (stored) {
+			return list;
+		}
+	}
+
+	// STEP 3: A new overflow page in front of the chain
+	uint32_t page_id;
+	Page *page = bpm->newPage(page_id, ModelType::POSTING_OVERFLOW);
+	if (page == nullptr) {
+		throw std::runtime_error("Failed to allocate posting overflow page");
+	}
+
+	char *data = const_cast<char *>(page->getRawData()) + sizeof(PageHeader);
+	PostingOverflowHeader overflow{header.overflow_page_id, 1, 0};
+	std::memcpy(data, &overflow, sizeof(PostingOverflowHeader));
+	writeEntry(data + sizeof(PostingOverflowHeader), value);
+	bpm->unpinPage(page_id, true);
+
+	header.overflow_page_id = page_id;
+	overwriteRecord(list, header, entries);
+	return list;
+}
+
+bool PostingStore::remove(RecordID &list, const RecordID &value) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	auto same = [&](const RecordID &entry) {
+		return entry.page_id == value.page_id && entry.slot_num == value.slot_num;
+	};
+
+	std::vector<RecordID> entries;
+	PostingHeader header = readRecord(list, entries);
+
+	// STEP 1: In the record. Overflow values refill it, so only a list without overflow shrinks
+	auto it = std::find_if(entries.begin(), entries.end(), same);
+	if (it != entries.end()) {
+		if (header.overflow_page_id != INVALID_PAGE_ID) {
+			*it = popOverflow(header);
+			overwriteRecord(list, header, entries);
+			return true;
+		}
+
+		*it = entries.back();
+		entries.pop_back();
+
+		if (entries.size() == 1) {
+			// The last value goes back into the leaf
+			deleteRecord(list);
+			list = entries[0];
+			return true;
+		}
+
+		header.count = static_cast<uint16_t>(entries.size());
+		list = replaceRecord(list, header, entries);
+		return true;
+	}
+
+	// STEP 2: In an overflow page; the hole is filled with the last value of the chain's head
+	for (uint32_t page_id = header.overflow_page_id; page_id != INVALID_PAGE_ID;) {
+		Page *page = bpm->fetchPage(page_id);
+		if (page == nullptr) {
+			throw std::runtime_error("Posting overflow page not found: " + std::to_string(page_id));
+		}
+		bpm->latchPage(page, true);
+
+		char *data = const_cast<char *>(page->getRawData()) + sizeof(PageHeader);
+		PostingOverflowHeader overflow;
+		std::memcpy(&overflow, data, sizeof(PostingOverflowHeader));
+
+		uint16_t index = overflow.count;
+		for (uint16_t i = 0; i < overflow.count; i++) {
+			if (same(readEntry(data + sizeof(PostingOverflowHeader) + i * ENTRY_SIZE))) {
+				index = i;
+				break;
+			}
+		}
+
+		if (index == overflow.count) {
+			bpm->unlatchPage(page, true);
+			bpm->unpinPage(page_id, false);
+			page_id = overflow.next_page_id;
+			continue;
+		}
+
+		bool is_head = (page_id == header.overflow_page_id);
+		if (is_head) {
+			// Its own last value fills the hole
+			overflow.count--;
+			RecordID last = readEntry(data + sizeof(PostingOverflowHeader) + overflow.count * ENTRY_SIZE);
+			writeEntry(data + sizeof(PostingOverflowHeader) + index * ENTRY_SIZE, last);
+			std::memcpy(data, &overflow, sizeof(PostingOverflowHeader));
+		}
+		bpm->unlatchPage(page, true);
+		bpm->unpinPage(page_id, true);
+
+		if (is_head) {
+			if (overflow.count == 0) {
+				header.overflow_page_id = overflow.next_page_id;
+				freePage(page_id);
+				overwriteRecord(list, header, entries);
+			}
+			return true;
+		}
+
+		// A page further down the chain: the head's last value moves here
+		RecordID moved = popOverflow(header);
+		page = bpm->fetchPage(page_id);
+		if (page == nullptr) {
+			throw std::runtime_error("Posting overflow page not found: " + std::to_string(page_id));
+		}
+		bpm->latchPage(page, true);
+		data = const_cast<char *>(page->getRawData()) + sizeof(PageHeader);
+		writeEntry(data + sizeof(PostingOverflowHeader) + index * ENTRY_SIZE, moved);
+		bpm->unlatchPage(page, true);
+		bpm->unpinPage(page_id, true);
+
+		overwriteRecord(list, header, entries);
+		return true;
+	}
+
+	return false;
+}
+
+void PostingStore::read(const RecordID &list, std::vector<RecordID> &out) {
+	uint16_t slot_num = list.slot_num & ~POSTING_LIST_FLAG;
+
+	// STEP 1: The record. Other lists may be written to the same page meanwhile
+	const Page *page = bpm->fetchPageForRead(list.page_id);
+	if (page == nullptr) {
+		throw std::runtime_error("Posting list page not found: " + std::to_string(list.page_id));
+	}
+	bpm->latchPage(page, false);
+
+	uint16_t record_size = 0;
+	const char *record = page->getRecord(slot_num, record_size);
+	if (record == nullptr) {
+		bpm->unlatchPage(page, false);
+		bpm->unpinPageForRead(list.page_id, page);
+		throw std::runtime_error("Posting list record not found in page: " + std::to_string(list.page_id));
+	}
+
+	PostingHeader header;
+	std::memcpy(&header, record, sizeof(PostingHeader));
+	for (uint16_t i = 0; i < header.count; i++) {
+		out.push_back(readEntry(record + sizeof(PostingHeader) + i * ENTRY_SIZE));
+	}
+	bpm->unlatchPage(page, false);
+	bpm->unpinPageForRead(list.page_id, page);
+
+	// STEP 2: The overflow chain
+	for (uint32_t page_id = header.overflow_page_id; page_id != INVALID_PAGE_ID;) {
+		page = bpm->fetchPageForRead(page_id);
+		if (page == nullptr) {
+			throw std::runtime_error("Posting overflow page not found: " + std::to_string(page_id));
+		}
+		bpm->latchPage(page, false);
+
+		const char *data = page->getRawData() + sizeof(PageHeader);
+		PostingOverflowHeader overflow;
+		std::memcpy(&overflow, data, sizeof(PostingOverflowHeader));
+		for (uint16_t i = 0; i < overflow.count; i++) {
+			out.push_back(readEntry(data + sizeof(PostingOverflowHeader) + i * ENTRY_SIZE));
+		}
+
+		bpm->unlatchPage(page, false);
+		bpm->unpinPageForRead(page_id, page);
+		page_id = overflow.next_page_id;
+	}
+}
+
+void PostingStore::destroy(const RecordID &list) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	std::vector<RecordID> entries;
+	PostingHeader header = readRecord(list, entries);
+
+	for (uint32_t page_id = header.overflow_page_id; page_id != INVALID_PAGE_ID;) {
+		Page *page = bpm->fetchPage(page_id);
+		if (page == nullptr) {
+			throw std::runtime_error("Posting overflow page not found: " + std::to_string(page_id));
+		}
+		PostingOverflowHeader overflow;
+		std::memcpy(&overflow, page->getRawData() + sizeof(PageHeader), sizeof(PostingOverflowHeader));
+		bpm->unpinPage(page_id, false);
+
+		freePage(page_id);
+		page_id = overflow.next_page_id;
+	}
+
+	deleteRecord(list);
+}
+
+} // namespace LuminaDB
@@ -1,4 +1,5 @@
 #include "luminadb/model/Course.hpp"
+#include <cstring>
 
 namespace LuminaDB {
 
@@ -1,4 +1,5 @@
 #include "luminadb/model/User.hpp"
+#include <cstring>
 
 namespace LuminaDB {
 
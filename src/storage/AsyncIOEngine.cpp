@@ -0,0 +1,461 @@
+#include "luminadb/storage/AsyncIOEngine.hpp"
+#include "luminadb/storage/Page.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef LUMINADB_HAVE_IO_URING
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace LuminaDB {
+
+#ifdef LUMINADB_HAVE_IO_URING
+
+/**
+ * Pointers into the SQ/CQ rings shared with the kernel.
+ * Layout follows io_uring_setup(2); the head/tail words are accessed with
+ * acquire/release ordering because the kernel updates them concurrently.
+ */
+struct AsyncIOEngine::UringState {
+	int ring_fd = -1;
+	void *sq_ptr = MAP_FAILED;
+	size_t sq_size = 0;
+	void *cq_ptr = MAP_FAILED;
+	size_t cq_size = 0;
+	io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+	size_t sqes_size = 0;
+
+	unsigned *sq_head = nullptr;
+	unsigned *sq_tail = nullptr;
+	unsigned *sq_mask = nullptr;
+	unsigned *sq_array = nullptr;
+	unsigned sq_entries = 0;
+
+	unsigned *cq_head = nullptr;
+	unsigned *cq_tail = nullptr;
+	unsigned *cq_mask = nullptr;
+	io_uring_cqe *cqes = nullptr;
+};
+
+namespace {
+
+int uringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+	return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+unsigned loadAcquire(unsigned *ptr) { return std::atomic_ref<unsigned>(*ptr).load(std::memory_order_acquire); }
+
+void storeRelease(unsigned *ptr, unsigned value) {
+	std::atomic_ref<unsigned>(*ptr).store(value, std::memory_order_release);
+}
+
+} // namespace
+
+bool AsyncIOEngine::setupUring() {
+	io_uring_params params{};
+	int fd = static_cast<int>(::syscall(__NR_io_uring_setup, queue_depth, &params));
+
+	// ENOSYS (old kernel), EPERM (disabled by sysctl/seccomp)... -> use the thread pool
+	if (fd < 0) {
+		return false;
+	}
+
+	auto *state = new UringState();
+	state->ring_fd = fd;
+	state->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	state->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	// Newer kernels map both rings with a single mmap
+	bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single_mmap) {
+		state->sq_size = std::max(state->sq_size, state->cq_size);
+		state->cq_size = state->sq_size;
+	}
+
+	state->sq_ptr =
+		::mmap(nullptr, state->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (state->sq_ptr != MAP_FAILED) {
+		state->cq_ptr = single_mmap ? state->sq_ptr
+									: ::mmap(nullptr, state->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+											 fd, IORING_OFF_CQ_RING);
+	}
+
+	state->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+	if (state->cq_ptr != MAP_FAILED) {
+		state->sqes = static_cast<io_uring_sqe *>(::mmap(nullptr, state->sqes_size, PROT_READ | PROT_WRITE,
+														 MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+	}
+
+	uring = state;
+	if (state->sq_ptr == MAP_FAILED || state->cq_ptr == MAP_FAILED || state->sqes == MAP_FAILED) {
+		teardownUring();
+		return false;
+	}
+
+	char *sq = static_cast<char *>(state->sq_ptr);
+	state->sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+	state->sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+	state->sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+	state->sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+	state->sq_entries = params.sq_entries;
+
+	char *cq = static_cast<char *>(state->cq_ptr);
+	state->cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+	state->cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+	state->cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+	state->cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+	// Never keep more requests in flight than the SQ holds; the CQ is at least as big
+	uring_slots.resize(state->sq_entries);
+	uring_free_slots.reserve(state->sq_entries);
+	for (uint32_t i = state->sq_entries; i > 0; --i) {
+		uring_free_slots.push_back(i - 1);
+	}
+
+	return true;
+}
+
+void AsyncIOEngine::teardownUring() {
+	if (uring == nullptr)
+		return;
+
+	if (uring->sqes != MAP_FAILED)
+		::munmap(uring->sqes, uring->sqes_size);
+	if (uring->cq_ptr != MAP_FAILED && uring->cq_ptr != uring->sq_ptr)
+		::munmap(uring->cq_ptr, uring->cq_size);
+	if (uring->sq_ptr != MAP_FAILED)
+		::munmap(uring->sq_ptr, uring->sq_size);
+	if (uring->ring_fd >= 0)
+		::close(uring->ring_fd);
+
+	delete uring;
+	uring = nullptr;
+}
+
+void AsyncIOEngine::submitUring(uint64_t ticket, const std::vector<IORequest> &batch,
+								std::unique_lock<std::mutex> &lock) {
+	int file_fd = disk_manager->getFileDescriptor();
+	size_t next = 0;
+
+	while (next < batch.size()) {
+		// SQ full: make room by reaping completions first, sleeping in the kernel without the latch
+		if (uring_free_slots.empty()) {
+			if (reaping) {
+				completion_cv.wait(lock);
+			} else {
+				reaping = true;
+				lock.unlock();
+				uringEnter(uring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+				lock.lock();
+				reaping = false;
+
+				reapUring(lock);
+				completion_cv.notify_all();
+			}
+			continue;
+		}
+
+		// STEP 1: Fill as many SQEs as there are free slots
+		unsigned tail = *uring->sq_tail; // Only we write the tail (under latch)
+		unsigned mask = *uring->sq_mask;
+		unsigned queued = 0;
+
+		while (next < batch.size() && !uring_free_slots.empty()) {
+			const IORequest &request = batch[next++];
+			uint32_t slot = uring_free_slots.back();
+			uring_free_slots.pop_back();
+			uring_slots[slot] = {ticket, request};
+
+			unsigned index = tail & mask;
+			io_uring_sqe *sqe = &uring->sqes[index];
+			std::memset(sqe, 0, sizeof(*sqe));
+			sqe->opcode = (request.op == IOOp::READ) ? IORING_OP_READ : IORING_OP_WRITE;
+			sqe->fd = file_fd;
+			sqe->off = static_cast<uint64_t>(request.page_id) * PAGE_SIZE;
+			sqe->addr = reinterpret_cast<uint64_t>(request.buffer);
+			sqe->len = static_cast<uint32_t>(PAGE_SIZE);
+			sqe->user_data = slot;
+
+			uring->sq_array[index] = index;
+			tail++;
+			queued++;
+		}
+
+		// STEP 2: Publish the new tail and hand the whole chunk to the kernel in one syscall.
+		// The latch stays held until the kernel took all of it, so the SQ only ever holds our SQEs here
+		storeRelease(uring->sq_tail, tail);
+		in_flight += queued;
+
+		std::vector<PendingRequest> redo;
+		while (queued > 0) {
+			int rc = uringEnter(uring->ring_fd, queued, 0, 0);
+			if (rc >= 0) {
+				queued -= static_cast<unsigned>(rc);
+				continue;
+			}
+			if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+				collectCompletions(redo);
+				continue;
+			}
+
+			// STEP 3: Take back the SQEs the kernel never consumed and fail them, together with
+			// the requests that were not queued at all
+			std::string error = std::string("io_uring_enter failed: ") + std::strerror(errno);
+			unsigned head = loadAcquire(uring->sq_head);
+			for (unsigned i = head; i != tail; i++) {
+				uring_free_slots.push_back(static_cast<uint32_t>(uring->sqes[uring->sq_array[i & mask]].user_data));
+				in_flight--;
+				complete(ticket, error);
+			}
+			storeRelease(uring->sq_tail, head);
+			for (; next < batch.size(); next++) {
+				complete(ticket, error);
+			}
+
+			// STEP 4: The kernel may still be reading or writing the buffers of the SQEs it did take,
+			// and the caller frees them once we throw: wait for those first
+			redoSync(redo, lock);
+			waitUring(ticket, lock);
+			batches.erase(ticket);
+			throw std::runtime_error(error);
+		}
+		redoSync(redo, lock);
+	}
+}
+
+void AsyncIOEngine::collectCompletions(std::vector<PendingRequest> &redo) {
+	unsigned head = *uring->cq_head;
+	unsigned tail = loadAcquire(uring->cq_tail);
+	unsigned mask = *uring->cq_mask;
+
+	while (head != tail) {
+		const io_uring_cqe &cqe = uring->cqes[head & mask];
+		uint32_t slot = static_cast<uint32_t>(cqe.user_data);
+		int res = cqe.res;
+		head++;
+
+		PendingRequest pending = uring_slots[slot];
+		uring_free_slots.push_back(slot);
+		in_flight--;
+
+		std::string error;
+		if (res < 0 && res != -EINVAL && res != -EOPNOTSUPP) {
+			error = "Async " + std::string(pending.request.op == IOOp::READ ? "read" : "write") + " of page " +
+					std::to_string(pending.request.page_id) + " failed (" + std::strerror(-res) + ")";
+		} else if (res != static_cast<int>(PAGE_SIZE)) {
+			// Short transfer (e.g. reading past EOF) or opcode unsupported by this kernel:
+			// redo it through DiskManager, which handles both cases (later, without the latch)
+			redo.push_back(pending);
+			continue;
+		} else if (pending.request.op == IOOp::WRITE) {
+			// Bypassed writePage(), so tell the durability policy about it
+			disk_manager->recordWrites(1);
+		}
+		complete(pending.ticket, error);
+	}
+
+	storeRelease(uring->cq_head, head);
+}
+
+void AsyncIOEngine::reapUring(std::unique_lock<std::mutex> &lock) {
+	std::vector<PendingRequest> redo;
+	collectCompletions(redo);
+	redoSync(redo, lock);
+}
+
+void AsyncIOEngine::waitUring(uint64_t ticket, std::unique_lock<std::mutex> &lock) {
+	while (batches[ticket].remaining > 0) {
+		reapUring(lock);
+		if (batches[ticket].remaining == 0)
+			break;
+
+		// Only one thread sleeps in the kernel; the rest wait to be notified. With nothing in
+		// flight, the rest of the batch is being redone synchronously by another thread
+		if (reaping || in_flight == 0) {
+			completion_cv.wait(lock);
+			continue;
+		}
+
+		reaping = true;
+		lock.unlock();
+		uringEnter(uring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+		lock.lock();
+		reaping = false;
+
+		reapUring(lock);
+		completion_cv.notify_all();
+	}
+}
+
+#else
+
+struct AsyncIOEngine::UringState {};
+
+bool AsyncIOEngine::setupUring() { return false; }
+void AsyncIOEngine::teardownUring() {}
+void AsyncIOEngine::submitUring(uint64_t, const std::vector<IORequest> &, std::unique_lock<std::mutex> &) {}
+void AsyncIOEngine::collectCompletions(std::vector<PendingRequest> &) {}
+void AsyncIOEngine::reapUring(std::unique_lock<std::mutex> &) {}
+void AsyncIOEngine::waitUring(uint64_t, std::unique_lock<std::mutex> &) {}
+
+#endif
+
+AsyncIOEngine::AsyncIOEngine(DiskManager *disk_manager, uint32_t queue_depth, uint32_t worker_threads)
+	: disk_manager(disk_manager), queue_depth(queue_depth), next_ticket(1), uring(nullptr), in_flight(0),
+	  reaping(false), shutting_down(false) {
+
+	if (setupUring()) {
+		return;
+	}
+
+	// Fallback: the workers call DiskManager directly (positional I/O is thread-safe)
+	uint32_t threads = std::max<uint32_t>(1, worker_threads);
+	for (uint32_t i = 0; i < threads; ++i) {
+		workers.emplace_back(&AsyncIOEngine::workerLoop, this);
+	}
+}
+
+AsyncIOEngine::~AsyncIOEngine() {
+	{
+		std::lock_guard<std::mutex> lock(latch);
+		shutting_down = true;
+	}
+	work_cv.notify_all();
+	for (auto &worker : workers) {
+		worker.join();
+	}
+
+#ifdef LUMINADB_HAVE_IO_URING
+	// The kernel may still write into caller buffers; drain before unmapping
+	if (uring != nullptr) {
+		std::unique_lock<std::mutex> lock(latch);
+		while (in_flight > 0) {
+			uringEnter(uring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+			reapUring(lock);
+		}
+	}
+#endif
+	teardownUring();
+}
+
+uint64_t AsyncIOEngine::submit(const std::vector<IORequest> &batch) {
+	std::unique_lock<std::mutex> lock(latch);
+
+	uint64_t ticket = next_ticket++;
+	batches[ticket] = {static_cast<uint32_t>(batch.size()), ""};
+
+	if (batch.empty()) {
+		return ticket;
+	}
+
+	if (uring != nullptr) {
+		submitUring(ticket, batch, lock);
+	} else {
+		for (const IORequest &request : batch) {
+			work_queue.push_back({ticket, request});
+		}
+		work_cv.notify_all();
+	}
+
+	return ticket;
+}
+
+void AsyncIOEngine::wait(uint64_t ticket) {
+	std::unique_lock<std::mutex> lock(latch);
+
+	auto it = batches.find(ticket);
+	if (it == batches.end()) {
+		throw std::runtime_error("Unknown I/O ticket: " + std::to_string(ticket));
+	}
+
+	if (uring != nullptr) {
+		waitUring(ticket, lock);
+	} else {
+		completion_cv.wait(lock, [&] { return batches[ticket].remaining == 0; });
+	}
+
+	// The ticket is consumed here
+	it = batches.find(ticket);
+	std::string error = std::move(it->second.error);
+	batches.erase(it);
+
+	if (!error.empty()) {
+		throw std::runtime_error(error);
+	}
+}
+
+void AsyncIOEngine::execute(const std::vector<IORequest> &batch) { wait(submit(batch)); }
+
+bool AsyncIOEngine::usingIoUring() const { return uring != nullptr; }
+
+void AsyncIOEngine::workerLoop() {
+	std::unique_lock<std::mutex> lock(latch);
+
+	while (true) {
+		work_cv.wait(lock, [&] { return shutting_down || !work_queue.empty(); });
+		if (work_queue.empty()) {
+			return; // shutting_down and nothing left to do
+		}
+
+		PendingRequest pending = work_queue.front();
+		work_queue.pop_front();
+
+		// Do the I/O without holding the latch
+		lock.unlock();
+		std::string error;
+		runSync(pending.request, error);
+		lock.lock();
+
+		complete(pending.ticket, error);
+	}
+}
+
+void AsyncIOEngine::runSync(const IORequest &request, std::string &error) {
+	try {
+		if (request.op == IOOp::READ) {
+			disk_manager->readPage(request.page_id, request.buffer);
+		} else {
+			disk_manager->writePage(request.page_id, request.buffer);
+		}
+	} catch (const std::exception &e) {
+		error = e.what();
+	}
+}
+
+void AsyncIOEngine::redoSync(std::vector<PendingRequest> &redo, std::unique_lock<std::mutex> &lock) {
+	if (redo.empty())
+		return;
+
+	// Blocking disk I/O: never done with the latch held
+	std::vector<std::string> errors(redo.size());
+	lock.unlock();
+	for (size_t i = 0; i < redo.size(); i++) {
+		runSync(redo[i].request, errors[i]);
+	}
+	lock.lock();
+
+	for (size_t i = 0; i < redo.size(); i++) {
+		complete(redo[i].ticket, errors[i]);
+	}
+	redo.clear();
+}
+
+void AsyncIOEngine::complete(uint64_t ticket, const std::string &error) {
+	BatchState &state = batches[ticket];
+
+	if (state.error.empty() && !error.empty()) {
+		state.error = error;
+	}
+
+	if (--state.remaining == 0) {
+		completion_cv.notify_all();
+	}
+}
+
+} // namespace LuminaDB
@@ -1,63 +1,387 @@
 #include "luminadb/storage/DiskManager.hpp"
 #include "luminadb/storage/Page.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace LuminaDB {
 
-DiskManager::DiskManager(const std::string &db_file) : file_name(db_file) {
-	// Start for reading, writing, and binary.
-	// If it doesn't exist, create it.
-	db_io.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+#ifdef _WIN32
+
+DiskManager::DiskManager(const std::string &db_file, const DurabilityOptions &durability)
+	: file_name(db_file), mapped_data(nullptr), mapped_size(0), durability(durability), written_seq(0), synced_seq(0),
+	  failed_seq(0), stop_syncer(false) {
+	// Open for reading and writing; create it if it doesn't exist.
+	file_handle = CreateFileA(db_file.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+							  nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
 
-	if (!db_io.is_open()) {
-		// If it failed to open (perhaps the file does not exist), it is created from scratch.
-		db_io.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-		db_io.close();
-		// Reopen in read/write mode
-		db_io.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+	if (file_handle == INVALID_HANDLE_VALUE) {
+		throw std::runtime_error("Failed to open database file: " + db_file);
 	}
+
+	startSyncer();
 }
 
 void DiskManager::writePage(uint32_t page_id, const char *page_data) {
-	size_t offset = page_id * PAGE_SIZE;
-	db_io.seekp(offset);
-	db_io.write(page_data, PAGE_SIZE);
-	db_io.flush(); // Ensures that the bytes reach the physical disk
+	uint64_t offset = static_cast<uint64_t>(page_id) * PAGE_SIZE;
+
+	// The OVERLAPPED offset makes the write positional, like pwrite()
+	OVERLAPPED ov{};
+	ov.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFULL);
+	ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+	DWORD written = 0;
+	if (!WriteFile(file_handle, page_data, static_cast<DWORD>(PAGE_SIZE), &written, &ov) || written != PAGE_SIZE) {
+		throw std::runtime_error("Failed to write page " + std::to_string(page_id) + " to " + file_name);
+	}
+
+	recordWrites(1);
 }
 
 void DiskManager::readPage(uint32_t page_id, char *buffer) {
-	// Always zero-initialize the destination buffer to avoid garbage when the
-	// file is shorter than the requested page. This prevents uninitialized
-	// headers from being interpreted as valid B+Tree pages.
+	// Pages past the end of the file read as zeros (see the POSIX version).
 	std::memset(buffer, 0, PAGE_SIZE);
 
-	size_t offset = page_id * PAGE_SIZE;
-	db_io.seekg(offset);
-	db_io.read(buffer, PAGE_SIZE);
+	uint64_t offset = static_cast<uint64_t>(page_id) * PAGE_SIZE;
 
-	// If the read failed or was partial, clear the error state so future I/O
-	// operations keep working. The buffer stays zeroed for missing bytes.
-	if (!db_io.good()) {
-		db_io.clear();
+	OVERLAPPED ov{};
+	ov.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFULL);
+	ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+	DWORD read = 0;
+	if (!ReadFile(file_handle, buffer, static_cast<DWORD>(PAGE_SIZE), &read, &ov) &&
+		GetLastError() != ERROR_HANDLE_EOF) {
+		throw std::runtime_error("Failed to read page " + std::to_string(page_id) + " from " + file_name);
+	}
+}
+
+void DiskManager::syncFile() {
+	if (!FlushFileBuffers(file_handle)) {
+		throw std::runtime_error("Failed to sync " + file_name);
 	}
 }
 
 uint32_t DiskManager::getExistingPageCount() {
-	// Move to the end of the file
-	db_io.seekg(0, std::ios::end);
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file_handle, &size)) {
+		throw std::runtime_error("Failed to stat " + file_name);
+	}
+	return static_cast<uint32_t>(static_cast<uint64_t>(size.QuadPart) / PAGE_SIZE);
+}
 
-	// Obtenemos la posición actual ( total en bytes)
-	size_t file_size = static_cast<size_t>(db_io.tellg());
+// Not implemented on Windows yet: every read goes through the frames.
+bool DiskManager::mapFile() { return false; }
 
-	// Return the pointer to the beginning so as not to ruin future readings
-	db_io.seekg(0, std::ios::beg);
+DiskManager::~DiskManager() {
+	stopSyncer();
+
+	if (file_handle != INVALID_HANDLE_VALUE) {
+		CloseHandle(file_handle);
+	}
+}
+
+#else
+
+DiskManager::DiskManager(const std::string &db_file, const DurabilityOptions &durability)
+	: file_name(db_file), mapped_data(nullptr), mapped_size(0), durability(durability), written_seq(0), synced_seq(0),
+	  failed_seq(0), stop_syncer(false) {
+	// Open for reading and writing; create it if it doesn't exist.
+	fd = ::open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+
+	if (fd < 0) {
+		throw std::runtime_error("Failed to open database file: " + db_file + " (" + std::strerror(errno) + ")");
+	}
+
+	startSyncer();
+}
+
+void DiskManager::writePage(uint32_t page_id, const char *page_data) {
+	off_t offset = static_cast<off_t>(page_id) * static_cast<off_t>(PAGE_SIZE);
+	size_t done = 0;
+
+	// pwrite() doesn't touch the file offset, so concurrent callers never race on a cursor.
+	// No flush here: the bytes stay in the page cache until the durability policy syncs them.
+	while (done < PAGE_SIZE) {
+		ssize_t n = ::pwrite(fd, page_data + done, PAGE_SIZE - done, offset + static_cast<off_t>(done));
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			throw std::runtime_error("Failed to write page " + std::to_string(page_id) + " to " + file_name + " (" +
+									 std::strerror(errno) + ")");
+		}
+		done += static_cast<size_t>(n);
+	}
 
-	return static_cast<uint32_t>(file_size / PAGE_SIZE);
+	recordWrites(1);
+}
+
+void DiskManager::readPage(uint32_t page_id, char *buffer) {
+	off_t offset = static_cast<off_t>(page_id) * static_cast<off_t>(PAGE_SIZE);
+	size_t done = 0;
+
+	while (done < PAGE_SIZE) {
+		ssize_t n = ::pread(fd, buffer + done, PAGE_SIZE - done, offset + static_cast<off_t>(done));
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			throw std::runtime_error("Failed to read page " + std::to_string(page_id) + " from " + file_name + " (" +
+									 std::strerror(errno) + ")");
+		}
+		if (n == 0)
+			break; // End of file
+		done += static_cast<size_t>(n);
+	}
+
+	// If the file is shorter than the requested page, zero the missing bytes.
+	// This prevents uninitialized headers from being interpreted as valid B+Tree pages.
+	if (done < PAGE_SIZE) {
+		std::memset(buffer + done, 0, PAGE_SIZE - done);
+	}
+}
+
+void DiskManager::syncFile() {
+#if defined(__APPLE__)
+	int rc = ::fsync(fd);
+#else
+	int rc = ::fdatasync(fd);
+#endif
+	if (rc != 0) {
+		throw std::runtime_error("Failed to sync " + file_name + " (" + std::strerror(errno) + ")");
+	}
+}
+
+uint32_t DiskManager::getExistingPageCount() {
+	struct stat st {};
+	if (::fstat(fd, &st) != 0) {
+		throw std::runtime_error("Failed to stat " + file_name + " (" + std::strerror(errno) + ")");
+	}
+	return static_cast<uint32_t>(static_cast<uint64_t>(st.st_size) / PAGE_SIZE);
+}
+
+int DiskManager::getFileDescriptor() const { return fd; }
+
+bool DiskManager::mapFile() {
+	if (mapped_data != nullptr) {
+		return true;
+	}
+
+	size_t size = static_cast<size_t>(getExistingPageCount()) * PAGE_SIZE;
+	if (size == 0) {
+		return false;
+	}
+
+	void *ptr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (ptr == MAP_FAILED) {
+		return false;
+	}
+
+	// Point lookups touch scattered pages; don't let the kernel read ahead
+	::madvise(ptr, size, MADV_RANDOM);
+
+	mapped_data = static_cast<char *>(ptr);
+	mapped_size = size;
+	return true;
 }
 
 DiskManager::~DiskManager() {
-	if (db_io.is_open()) {
-		db_io.close();
+	stopSyncer();
+
+	if (mapped_data != nullptr) {
+		::munmap(mapped_data, mapped_size);
+	}
+
+	if (fd >= 0) {
+		::close(fd);
+	}
+}
+
+#endif
+
+// --- DURABILITY ---
+
+void DiskManager::startSyncer() {
+	if (durability.mode != DurabilityMode::NONE) {
+		syncer = std::thread(&DiskManager::syncerLoop, this);
+	}
+}
+
+void DiskManager::stopSyncer() {
+	{
+		std::lock_guard<std::mutex> lock(sync_latch);
+		stop_syncer = true;
+	}
+	sync_cv.notify_all();
+
+	if (syncer.joinable()) {
+		syncer.join();
+	}
+
+	// Don't leave a bounded window open on close
+	if (durability.mode != DurabilityMode::NONE && written_seq > synced_seq) {
+		try {
+			sync();
+		} catch (const std::exception &) {
+			// Destructors must not throw
+		}
+	}
+}
+
+void DiskManager::recordWrites(uint32_t count) {
+	std::lock_guard<std::mutex> lock(sync_latch);
+
+	bool was_clean = (written_seq == synced_seq);
+	if (was_clean) {
+		first_unsynced = std::chrono::steady_clock::now();
+	}
+	written_seq += count;
+
+	// Wake the syncer to start the max_delay clock, or to sync right away on a full batch
+	if (durability.mode != DurabilityMode::NONE &&
+		(was_clean ||
+		 (durability.mode == DurabilityMode::GROUP_COMMIT && written_seq - synced_seq >= durability.max_batch))) {
+		sync_cv.notify_one();
+	}
+}
+
+void DiskManager::sync() {
+	uint64_t target;
+	{
+		std::lock_guard<std::mutex> lock(sync_latch);
+		if (!sync_error.empty()) {
+			throw std::runtime_error(durabilityError(written_seq));
+		}
+		target = written_seq;
+	}
+
+	// Every write counted in target has already returned, so one fdatasync covers them all
+	try {
+		syncFile();
+	} catch (const std::exception &e) {
+		{
+			std::lock_guard<std::mutex> lock(sync_latch);
+			if (sync_error.empty()) {
+				sync_error = e.what();
+			}
+			failed_seq = std::max(failed_seq, target);
+		}
+		durable_cv.notify_all();
+		throw;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sync_latch);
+
+		// A concurrent sync failed meanwhile: this one may not have covered the pages it lost
+		if (!sync_error.empty()) {
+			throw std::runtime_error(durabilityError(target));
+		}
+		if (target > synced_seq) {
+			synced_seq = target;
+		}
+		if (written_seq > synced_seq) {
+			first_unsynced = std::chrono::steady_clock::now();
+		}
 	}
+	durable_cv.notify_all();
 }
-} // namespace LuminaDB
\ No newline at end of file
+
+void DiskManager::awaitDurability() {
+	switch (durability.mode) {
+	case DurabilityMode::NONE:
+		sync();
+		return;
+
+	case DurabilityMode::PERIODIC: {
+		// The syncer will cover these writes within max_delay, unless it has already failed
+		std::lock_guard<std::mutex> lock(sync_latch);
+		if (!sync_error.empty() && written_seq > synced_seq) {
+			throw std::runtime_error(durabilityError(written_seq));
+		}
+		return;
+	}
+
+	case DurabilityMode::GROUP_COMMIT: {
+		std::unique_lock<std::mutex> lock(sync_latch);
+		uint64_t target = written_seq;
+		if (target <= synced_seq) {
+			return;
+		}
+
+		// Ride on the next group sync instead of issuing our own. After a failed sync no other
+		// one will cover these writes, so that ends the wait as well
+		durable_cv.wait(lock, [&] { return synced_seq >= target || !sync_error.empty() || stop_syncer; });
+
+		if (synced_seq < target) {
+			throw std::runtime_error(sync_error.empty() ? "Database is closing" : durabilityError(target));
+		}
+		return;
+	}
+	}
+}
+
+std::string DiskManager::durabilityError(uint64_t target) const {
+	if (target <= failed_seq) {
+		return sync_error;
+	}
+	return "Writes to " + file_name + " can't be made durable after an earlier failed sync: " + sync_error;
+}
+
+void DiskManager::syncerLoop() {
+	std::unique_lock<std::mutex> lock(sync_latch);
+
+	// A failed sync is final (see sync()): the committers have been told, nothing left to do
+	while (!stop_syncer && sync_error.empty()) {
+		// Nothing pending: sleep until the next write arrives
+		if (written_seq == synced_seq) {
+			sync_cv.wait(lock);
+			continue;
+		}
+
+		// Gather more writes, but never hold the oldest one longer than max_delay
+		auto deadline = first_unsynced + durability.max_delay;
+		sync_cv.wait_until(lock, deadline, [&] {
+			return stop_syncer || (durability.mode == DurabilityMode::GROUP_COMMIT &&
+								   written_seq - synced_seq >= durability.max_batch);
+		});
+		if (stop_syncer) {
+			break;
+		}
+
+		lock.unlock();
+		try {
+			sync();
+		} catch (const std::exception &) {
+			// sync() recorded the failure and woke the committers
+		}
+		lock.lock();
+	}
+}
+
+const DurabilityOptions &DiskManager::getDurability() const { return durability; }
+
+// --- MEMORY MAPPING ---
+
+const char *DiskManager::getMappedPage(uint32_t page_id) const {
+	size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+	if (mapped_data == nullptr || offset + PAGE_SIZE > mapped_size) {
+		return nullptr;
+	}
+	return mapped_data + offset;
+}
+
+bool DiskManager::isMapped(const void *ptr) const {
+	const char *p = static_cast<const char *>(ptr);
+	return mapped_data != nullptr && p >= mapped_data && p < mapped_data + mapped_size;
+}
+
+} // namespace LuminaDB
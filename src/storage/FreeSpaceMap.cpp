@@ -0,0 +1,107 @@
+#include "luminadb/storage/FreeSpaceMap.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace LuminaDB {
+
+uint32_t FreeSpaceMap::findPage(ModelType type, uint16_t needed) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	// First fit: the page that has been receiving inserts is usually the first match
+	for (const FreeSpaceEntry &entry : entries) {
+		if (entry.object_type == static_cast<uint16_t>(type) && entry.free_space >= needed) {
+			return entry.page_id;
+		}
+	}
+	return INVALID_PAGE_ID;
+}
+
+void FreeSpaceMap::eraseAt(size_t index) {
+	positions.erase(entries[index].page_id);
+	if (index + 1 != entries.size()) {
+		entries[index] = entries.back();
+		positions[entries[index].page_id] = index;
+	}
+	entries.pop_back();
+}
+
+void FreeSpaceMap::put(const FreeSpaceEntry &entry) {
+	auto it = positions.find(entry.page_id);
+	if (it != positions.end()) {
+		entries[it->second] = entry;
+		return;
+	}
+	positions.emplace(entry.page_id, entries.size());
+	entries.push_back(entry);
+}
+
+void FreeSpaceMap::update(ModelType type, uint32_t page_id, uint16_t free_space) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	// Almost full: stop offering it
+	if (free_space < MIN_TRACKED_SPACE) {
+		auto it = positions.find(page_id);
+		if (it != positions.end()) {
+			eraseAt(it->second);
+		}
+		return;
+	}
+
+	put({page_id, static_cast<uint16_t>(type), free_space});
+}
+
+void FreeSpaceMap::remove(uint32_t page_id) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	auto it = positions.find(page_id);
+	if (it != positions.end()) {
+		eraseAt(it->second);
+	}
+}
+
+std::vector<FreeSpaceEntry> FreeSpaceMap::snapshot() {
+	std::lock_guard<std::mutex> lock(latch);
+	return entries;
+}
+
+void FreeSpaceMap::serializePage(Page *page, const FreeSpaceEntry *entries, size_t count, uint32_t next_page_id) {
+	page->init(page->getPageId(), ModelType::FREE_SPACE_MAP);
+	page->getHeader()->slot_count = static_cast<uint16_t>(count);
+
+	char *dest = const_cast<char *>(page->getRawData()) + sizeof(PageHeader);
+	FreeSpacePageHeader header{next_page_id};
+	std::memcpy(dest, &header, sizeof(header));
+	if (count > 0) {
+		std::memcpy(dest + sizeof(header), entries, count * sizeof(FreeSpaceEntry));
+	}
+}
+
+uint32_t FreeSpaceMap::deserializePage(const Page *page) {
+	std::lock_guard<std::mutex> lock(latch);
+
+	const char *src = page->getRawData() + sizeof(PageHeader);
+	FreeSpacePageHeader header;
+	std::memcpy(&header, src, sizeof(header));
+	src += sizeof(header);
+
+	size_t count = std::min<size_t>(page->getHeader()->slot_count, ENTRIES_PER_PAGE);
+	for (size_t i = 0; i < count; i++) {
+		FreeSpaceEntry entry;
+		std::memcpy(&entry, src + i * sizeof(FreeSpaceEntry), sizeof(entry));
+		put(entry);
+	}
+	return header.next_page_id;
+}
+
+void FreeSpaceMap::clear() {
+	std::lock_guard<std::mutex> lock(latch);
+	entries.clear();
+	positions.clear();
+}
+
+size_t FreeSpaceMap::size() {
+	std::lock_guard<std::mutex> lock(latch);
+	return entries.size();
+}
+
+} // namespace LuminaDB
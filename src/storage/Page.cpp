@@ -1,6 +1,8 @@
 #include "luminadb/storage/Page.hpp"
 #include "luminadb/common/types.hpp"
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 namespace LuminaDB {
 
@@ -21,46 +23,139 @@ PageHeader *Page::getHeader() { return reinterpret_cast<PageHeader *>(data); }
 
 uint32_t Page::getPageId() const { return getHeader()->page_id; }
 
-uint16_t Page::getFreeSpace() {
-	auto *header = getHeader();
-	uint16_t slots_end = sizeof(PageHeader) + (header->slot_count * sizeof(Slot));
-	return header->free_ptr - slots_end;
+uint16_t Page::getFreeSpace() const {
+	const auto *header = getHeader();
+	const Slot *slots = reinterpret_cast<const Slot *>(data + sizeof(PageHeader));
+
+	// Everything that is neither header, slot directory nor a live record can be reused
+	size_t used = sizeof(PageHeader) + (header->slot_count * sizeof(Slot));
+	for (uint16_t i = 0; i < header->slot_count; i++) {
+		used += slots[i].size;
+	}
+	return static_cast<uint16_t>(PAGE_SIZE - used);
 }
 
-bool Page::insertRecord(const char *record_data, uint16_t record_size) {
+bool Page::insertRecord(const char *record_data, uint16_t record_size, uint16_t &slot_idx) {
+	// Size 0 marks a deleted slot, so empty records can't be stored
 	if (record_size == 0)
 		return false;
 
-	if (getFreeSpace() < record_size + sizeof(Slot))
+	auto *header = getHeader();
+	Slot *slots = reinterpret_cast<Slot *>(data + sizeof(PageHeader));
+
+	// STEP 1: Reuse a tombstone if there is one; otherwise a new slot goes after the last one
+	uint16_t target = header->slot_count;
+	for (uint16_t i = 0; i < header->slot_count; i++) {
+		if (slots[i].size == 0) {
+			target = i;
+			break;
+		}
+	}
+	bool new_slot = (target == header->slot_count);
+
+	size_t needed = record_size + (new_slot ? sizeof(Slot) : 0);
+	if (getFreeSpace() < needed)
 		return false;
 
-	auto *header = getHeader();
+	// STEP 2: Enough bytes overall, but maybe not in one piece: squeeze out the dead records
+	size_t slots_end = sizeof(PageHeader) + (header->slot_count * sizeof(Slot));
+	if (header->free_ptr - slots_end < needed) {
+		compact();
+	}
 
-	// Move the free space pointer backward
+	// STEP 3: Move the free space pointer backward and copy the object data there
 	header->free_ptr -= record_size;
-
-	// Copy the object data to the calculated position
 	std::memcpy(data + header->free_ptr, record_data, record_size);
 
-	// Create the new slot after the last existing slot
-	Slot *new_slot = reinterpret_cast<Slot *>(data + sizeof(PageHeader) + (header->slot_count * sizeof(Slot)));
-	new_slot->offset = header->free_ptr;
-	new_slot->size = record_size;
+	slots[target].offset = header->free_ptr;
+	slots[target].size = record_size;
 
-	header->slot_count++;
+	if (new_slot) {
+		header->slot_count++;
+	}
+
+	slot_idx = target;
 	return true;
 }
 
-const char *Page::getRecord(uint16_t slot_idx, uint16_t &out_size) {
-	auto *header = getHeader();
+const char *Page::getRecord(uint16_t slot_idx, uint16_t &out_size) const {
+	const auto *header = getHeader();
 	if (slot_idx >= header->slot_count) {
 		return nullptr;
 	}
 
-	Slot *slots = reinterpret_cast<Slot *>(data + sizeof(PageHeader));
+	const Slot *slots = reinterpret_cast<const Slot *>(data + sizeof(PageHeader));
+	if (slots[slot_idx].size == 0) {
+		return nullptr; // Deleted
+	}
+
 	out_size = slots[slot_idx].size;
 	return data + slots[slot_idx].offset;
 }
 
+bool Page::deleteRecord(uint16_t slot_idx) {
+	auto *header = getHeader();
+	if (slot_idx >= header->slot_count) {
+		return false;
+	}
+
+	Slot *slots = reinterpret_cast<Slot *>(data + sizeof(PageHeader));
+	if (slots[slot_idx].size == 0) {
+		return false;
+	}
+
+	// The bytes stay where they are until the next compact()
+	slots[slot_idx].offset = 0;
+	slots[slot_idx].size = 0;
+
+	// Trailing tombstones can go: no live record uses those slot numbers
+	while (header->slot_count > 0 && slots[header->slot_count - 1].size == 0) {
+		header->slot_count--;
+	}
+	if (header->slot_count == 0) {
+		header->free_ptr = PAGE_SIZE;
+	}
+	return true;
+}
+
+void Page::compact() {
+	auto *header = getHeader();
+	Slot *slots = reinterpret_cast<Slot *>(data + sizeof(PageHeader));
+
+	// STEP 1: Live slots, the record closest to the end of the page first
+	std::vector<uint16_t> live;
+	for (uint16_t i = 0; i < header->slot_count; i++) {
+		if (slots[i].size != 0) {
+			live.push_back(i);
+		}
+	}
+	std::sort(live.begin(), live.end(), [&](uint16_t a, uint16_t b) { return slots[a].offset > slots[b].offset; });
+
+	// STEP 2: Slide each one toward the end. A record only moves right, over bytes already
+	// freed or moved, so nothing that is still needed gets overwritten
+	uint16_t free_ptr = PAGE_SIZE;
+	for (uint16_t i : live) {
+		free_ptr -= slots[i].size;
+		if (free_ptr != slots[i].offset) {
+			std::memmove(data + free_ptr, data + slots[i].offset, slots[i].size);
+			slots[i].offset = free_ptr;
+		}
+	}
+	header->free_ptr = free_ptr;
+}
+
+uint16_t Page::getLiveCount() const {
+	const auto *header = getHeader();
+	const Slot *slots = reinterpret_cast<const Slot *>(data + sizeof(PageHeader));
+
+	uint16_t count = 0;
+	for (uint16_t i = 0; i < header->slot_count; i++) {
+		if (slots[i].size != 0) {
+			count++;
+		}
+	}
+	return count;
+}
+
 const char *Page::getRawData() const { return data; }
 } // namespace LuminaDB
\ No newline at end of file
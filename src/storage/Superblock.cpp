@@ -0,0 +1,127 @@
+#include "luminadb/storage/Superblock.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace LuminaDB {
+
+namespace {
+constexpr char MAGIC[8] = {'L', 'U', 'M', 'I', 'N', 'A', 'D', 'B'};
+} // namespace
+
+Superblock::Superblock() { format(); }
+
+void Superblock::format() {
+	std::memcpy(data.magic, MAGIC, sizeof(MAGIC));
+	data.version = SUPERBLOCK_VERSION;
+	data.page_size = static_cast<uint32_t>(PAGE_SIZE);
+	data.next_page_id = SUPERBLOCK_PAGE_ID + 1;
+	data.free_list_head = INVALID_PAGE_ID;
+	data.fsm_page_id = INVALID_PAGE_ID;
+	data.catalog_count = 0;
+	catalog.clear();
+}
+
+void Superblock::load(const Page *page) {
+	const PageHeader *header = page->getHeader();
+	const char *src = page->getRawData() + sizeof(PageHeader);
+
+	SuperblockData stored;
+	std::memcpy(&stored, src, sizeof(SuperblockData));
+
+	// STEP 1: Is it ours, and can we read it?
+	if (header->object_type != static_cast<uint32_t>(ModelType::SUPERBLOCK) ||
+		std::memcmp(stored.magic, MAGIC, sizeof(MAGIC)) != 0) {
+		throw std::runtime_error("Not a LuminaDB file (missing superblock); files from older versions are not supported");
+	}
+	if (stored.version != SUPERBLOCK_VERSION) {
+		throw std::runtime_error("Unsupported file format version " + std::to_string(stored.version) + " (expected " +
+								 std::to_string(SUPERBLOCK_VERSION) + ")");
+	}
+	if (stored.page_size != PAGE_SIZE) {
+		throw std::runtime_error("File uses page size " + std::to_string(stored.page_size) + ", expected " +
+								 std::to_string(PAGE_SIZE));
+	}
+	if (stored.catalog_count > CATALOG_CAPACITY) {
+		throw std::runtime_error("Corrupted superblock: catalog has " + std::to_string(stored.catalog_count) +
+								 " entries");
+	}
+
+	// STEP 2: Copy the fixed part and the catalog
+	data = stored;
+	catalog.resize(data.catalog_count);
+	if (!catalog.empty()) {
+		std::memcpy(catalog.data(), src + sizeof(SuperblockData), catalog.size() * sizeof(CatalogEntry));
+	}
+}
+
+void Superblock::store(Page *page) const {
+	page->init(SUPERBLOCK_PAGE_ID, ModelType::SUPERBLOCK);
+
+	char *dest = const_cast<char *>(page->getRawData()) + sizeof(PageHeader);
+
+	SuperblockData out = data;
+	out.catalog_count = static_cast<uint32_t>(catalog.size());
+	std::memcpy(dest, &out, sizeof(SuperblockData));
+
+	if (!catalog.empty()) {
+		std::memcpy(dest + sizeof(SuperblockData), catalog.data(), catalog.size() * sizeof(CatalogEntry));
+	}
+}
+
+uint32_t Superblock::getNextPageId() const { return data.next_page_id; }
+
+void Superblock::setNextPageId(uint32_t page_id) { data.next_page_id = page_id; }
+
+uint32_t Superblock::getFreeListHead() const { return data.free_list_head; }
+
+void Superblock::setFreeListHead(uint32_t page_id) { data.free_list_head = page_id; }
+
+uint32_t Superblock::getFsmPageId() const { return data.fsm_page_id; }
+
+void Superblock::setFsmPageId(uint32_t page_id) { data.fsm_page_id = page_id; }
+
+uint32_t Superblock::getIndexRoot(const std::string &name) const {
+	for (const CatalogEntry &entry : catalog) {
+		if (std::strncmp(entry.name, name.c_str(), sizeof(entry.name)) == 0) {
+			return entry.root_page_id;
+		}
+	}
+	return INVALID_PAGE_ID;
+}
+
+uint32_t Superblock::getIndexKeyType(const std::string &name) const {
+	for (const CatalogEntry &entry : catalog) {
+		if (std::strncmp(entry.name, name.c_str(), sizeof(entry.name)) == 0) {
+			return entry.key_type;
+		}
+	}
+	return 0;
+}
+
+void Superblock::setIndexRoot(const std::string &name, uint32_t root_page_id, uint32_t key_type) {
+	if (name.empty() || name.size() > MAX_NAME_LENGTH) {
+		throw std::runtime_error("Invalid index name: '" + name + "'");
+	}
+
+	for (CatalogEntry &entry : catalog) {
+		if (std::strncmp(entry.name, name.c_str(), sizeof(entry.name)) == 0) {
+			entry.root_page_id = root_page_id;
+			entry.key_type = key_type;
+			return;
+		}
+	}
+
+	if (catalog.size() >= CATALOG_CAPACITY) {
+		throw std::runtime_error("Catalog is full, cannot add index '" + name + "'");
+	}
+
+	CatalogEntry entry{};
+	std::memcpy(entry.name, name.c_str(), name.size());
+	entry.root_page_id = root_page_id;
+	entry.key_type = key_type;
+	catalog.push_back(entry);
+}
+
+const std::vector<CatalogEntry> &Superblock::getCatalog() const { return catalog; }
+
+} // namespace LuminaDB
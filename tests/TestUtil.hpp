@@ -0,0 +1,42 @@
+#ifndef LUMINADB_TEST_UTIL_HPP
+#define LUMINADB_TEST_UTIL_HPP
+
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+/**
+ * Minimal helpers for the ctest programs: each test is a plain executable that counts
+ * failed checks and returns non-zero if any failed. Checks may run on several threads.
+ */
+namespace LuminaDB::Test {
+
+inline std::atomic<int> failures{0};
+
+// Result of a test program: prints the verdict and turns the failure count into an exit code
+inline int finish(const char *name) {
+	int count = failures.load();
+	std::cerr << name << (count == 0 ? ": OK" : ": FAILED (") << (count == 0 ? "" : std::to_string(count) + ")")
+			  << std::endl;
+	return count == 0 ? 0 : 1;
+}
+
+// A database file that does not exist yet (left over from an earlier run)
+inline std::string freshFile(const std::string &name) {
+	std::remove(name.c_str());
+	return name;
+}
+
+} // namespace LuminaDB::Test
+
+// Records a failure (with the message streamed as in std::cerr) and keeps going
+#define LUMINADB_CHECK(condition, message)                                                                           \
+	do {                                                                                                             \
+		if (!(condition)) {                                                                                          \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": " << message << std::endl;                              \
+			LuminaDB::Test::failures++;                                                                              \
+		}                                                                                                            \
+	} while (0)
+
+#endif
@@ -0,0 +1,110 @@
+#include "TestUtil.hpp"
+#include "luminadb/index/BPlusTree.hpp"
+#include "luminadb/index/BPlusTreePage.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace LuminaDB;
+
+/**
+ * Inserts keys in sequential and in random order until the tree is at least four levels
+ * deep, so internal nodes split and push separators up to new roots several times.
+ *
+ * uint32_t keys would need tens of millions of entries for that: the nodes hold hundreds.
+ * These StringKey32 keys keep the nodes narrow instead. Neighbours only differ in their
+ * last byte (suffix truncation can't shorten their separators) and the group number in
+ * front changes every 16 keys (nodes share almost no prefix).
+ */
+constexpr uint32_t SEQUENTIAL_KEYS = 2200000;
+constexpr uint32_t RANDOM_KEYS = 1000000;
+constexpr int MIN_DEPTH = 4;
+constexpr size_t POOL_FRAMES = 16384;
+
+static StringKey32 keyFor(uint32_t i) {
+	char text[48]; // 31 bytes for the group numbers used here (below 10^8)
+	std::snprintf(text, sizeof(text), "%08u----------------------%c", i >> 4, 'a' + (i & 15));
+	return StringKey32(text);
+}
+
+static RecordID valueFor(uint32_t i) { return RecordID{i, static_cast<uint16_t>(i % POSTING_LIST_FLAG)}; }
+
+// Levels from the root down to the leaves, following the leftmost child
+static int treeDepth(BufferPoolManager &bpm, uint32_t root_id) {
+	int depth = 1;
+	uint32_t page_id = root_id;
+	while (true) {
+		Page *page = bpm.fetchPage(page_id);
+		char *data = const_cast<char *>(page->getRawData());
+		if (BPlusTreePage(data).isLeaf()) {
+			bpm.unpinPage(page_id, false);
+			return depth;
+		}
+		uint32_t child_id = BPlusTreeInternalPage<StringKey32>(data).valueAt(0);
+		bpm.unpinPage(page_id, false);
+		page_id = child_id;
+		depth++;
+	}
+}
+
+// Inserts keyFor(i) for every i of 'order' (a permutation of 0 .. count - 1) and checks the tree
+static void insertAndVerify(const char *filename, const std::vector<uint32_t> &order) {
+	DiskManager disk_manager(Test::freshFile(filename));
+	BufferPoolManager bpm(POOL_FRAMES, &disk_manager);
+
+	// Page 0 belongs to the superblock in a real database
+	std::vector<char> zeros(PAGE_SIZE, 0);
+	disk_manager.writePage(0, zeros.data());
+	bpm.setNextPageId(1);
+
+	BPlusTree<StringKey32> tree(INVALID_PAGE_ID, &bpm);
+	for (uint32_t i : order) {
+		LUMINADB_CHECK(tree.insert(keyFor(i), valueFor(i)), filename << ": insert " << i);
+	}
+	LUMINADB_CHECK(!tree.insert(keyFor(order.front()), valueFor(0)), filename << ": duplicate key accepted");
+
+	// STEP 1: Every key is found, with its own value
+	for (uint32_t i : order) {
+		RecordID value;
+		bool found = tree.getValue(keyFor(i), value);
+		LUMINADB_CHECK(found && value.page_id == i && value.slot_num == valueFor(i).slot_num,
+					   filename << ": lookup " << i);
+	}
+	RecordID missing;
+	LUMINADB_CHECK(!tree.getValue(keyFor(static_cast<uint32_t>(order.size())), missing), filename << ": phantom key");
+
+	// STEP 2: A full scan returns every key once, in increasing order (keyFor(i) grows with i)
+	uint32_t expected = 0;
+	bool in_order = true;
+	StringKey32 last_key(std::string(StringKey32::MAX_LENGTH, '~'));
+	for (auto it = tree.scan(StringKey32(""), last_key); !it.isEnd(); ++it) {
+		if (in_order && (!(it.key() == keyFor(expected)) || it.value().page_id != expected)) {
+			LUMINADB_CHECK(false, filename << ": scan found " << it.key() << " at position " << expected);
+			in_order = false;
+		}
+		expected++;
+	}
+	LUMINADB_CHECK(expected == order.size(), filename << ": scan returned " << expected << " of " << order.size());
+
+	// STEP 3: The keys really went past three levels
+	int depth = treeDepth(bpm, tree.getRootPageId());
+	LUMINADB_CHECK(depth >= MIN_DEPTH, filename << ": depth " << depth << " < " << MIN_DEPTH);
+	std::cerr << filename << ": " << expected << " keys, depth " << depth << std::endl;
+}
+
+int main() {
+	std::vector<uint32_t> order(SEQUENTIAL_KEYS);
+	for (uint32_t i = 0; i < SEQUENTIAL_KEYS; i++) {
+		order[i] = i;
+	}
+	insertAndVerify("bplustree_sequential.db", order);
+
+	order.resize(RANDOM_KEYS);
+	std::shuffle(order.begin(), order.end(), std::mt19937(42));
+	insertAndVerify("bplustree_random.db", order);
+
+	return Test::finish("bplustree_stress_test");
+}
@@ -0,0 +1,149 @@
+#include "TestUtil.hpp"
+#include "luminadb/database/Database.hpp"
+#include "luminadb/model/SensorData.hpp"
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace LuminaDB;
+
+/**
+ * Inserts, removes, finds and range scans from several threads on one Database.
+ *
+ * Phase 1: keys 4i stay for the whole run, 4i + 1 are removed, 4i + 2 / 4i + 3 are inserted,
+ * while readers check that every stable key is found and that scans see them all, in order.
+ * Phase 2: threads remove and re-insert the same few keys against each other. A remove must
+ * free the record it unlinked and nothing else, so every key that is there afterwards (and
+ * every key a reader finds meanwhile) still reads its own object.
+ */
+constexpr uint32_t STABLE_KEYS = 20000;
+constexpr uint32_t CHURN_KEYS = 8;
+constexpr int CHURN_ROUNDS = 3000;
+constexpr uint32_t POOL_FRAMES = 64;
+
+static SensorData objectFor(uint32_t key) { return SensorData(key, 1.0, key); }
+
+static void mixedWorkload(Database &db) {
+	const uint32_t n = STABLE_KEYS;
+	for (uint32_t i = 0; i < n; i++) {
+		db.insert<SensorData>(4 * i, objectFor(4 * i));
+		db.insert<SensorData>(4 * i + 1, objectFor(4 * i + 1));
+	}
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < 2; t++) {
+		threads.emplace_back([&, t] {
+			for (uint32_t i = t; i < n; i += 2) {
+				uint32_t key = 4 * i + 2 + (i & 1);
+				LUMINADB_CHECK(db.insert<SensorData>(key, objectFor(key)), "insert " << key);
+			}
+		});
+		threads.emplace_back([&, t] {
+			for (uint32_t i = t; i < n; i += 2) {
+				LUMINADB_CHECK(db.remove(4 * i + 1), "remove " << 4 * i + 1);
+			}
+		});
+		threads.emplace_back([&, t] {
+			std::mt19937 rng(t);
+			for (uint32_t i = 0; i < n; i++) {
+				uint32_t key = 4 * (rng() % n);
+				try {
+					LUMINADB_CHECK(db.find<SensorData>(key).getSensorId() == key, "find " << key << ": wrong object");
+				} catch (const std::exception &e) {
+					LUMINADB_CHECK(false, "find " << key << ": " << e.what());
+				}
+			}
+		});
+	}
+	threads.emplace_back([&] {
+		std::mt19937 rng(9);
+		for (int scan = 0; scan < 20; scan++) {
+			uint32_t lo = 4 * (rng() % n);
+			uint32_t hi = lo + 2000;
+			uint32_t previous = 0;
+			uint32_t stable = 0;
+			bool first = true;
+			db.rangeScan<SensorData>(lo, hi, [&](uint32_t key, const SensorData &obj) {
+				LUMINADB_CHECK(first || key > previous, "scan order: " << key << " after " << previous);
+				LUMINADB_CHECK(obj.getSensorId() == key, "scan " << key << ": wrong object");
+				stable += key % 4 == 0 ? 1 : 0;
+				previous = key;
+				first = false;
+			});
+			uint32_t expected = (std::min(hi, 4 * n - 4) - lo) / 4 + 1;
+			LUMINADB_CHECK(stable == expected, "scan [" << lo << ", " << hi << "]: " << stable << " stable keys of "
+														<< expected);
+		}
+	});
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	size_t count = db.rangeScan<SensorData>(0, UINT32_MAX, [&](uint32_t key, const SensorData &) {
+		LUMINADB_CHECK(key % 4 != 1, "removed key " << key << " still there");
+	});
+	LUMINADB_CHECK(count == 2u * n, "final count " << count << " != " << 2u * n);
+}
+
+static void removeReinsertChurn(Database &db) {
+	// Above every key of the first phase
+	const uint32_t base = 4 * STABLE_KEYS;
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < 3; t++) {
+		threads.emplace_back([&, t] {
+			std::mt19937 rng(100 + t);
+			for (int round = 0; round < CHURN_ROUNDS; round++) {
+				uint32_t key = base + rng() % CHURN_KEYS;
+				db.remove(key);
+				db.insert<SensorData>(key, objectFor(key));
+			}
+		});
+	}
+	threads.emplace_back([&] {
+		std::mt19937 rng(200);
+		for (int round = 0; round < 3 * CHURN_ROUNDS; round++) {
+			uint32_t key = base + rng() % CHURN_KEYS;
+			try {
+				LUMINADB_CHECK(db.find<SensorData>(key).getSensorId() == key, "churn find " << key << ": wrong object");
+			} catch (const std::runtime_error &) {
+				// Removed at the moment: fine
+			}
+		}
+	});
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	// Every key still there reads its own object, and so does every key of the first phase
+	size_t count = db.rangeScan<SensorData>(0, UINT32_MAX, [&](uint32_t key, const SensorData &obj) {
+		LUMINADB_CHECK(obj.getSensorId() == key, "after churn, key " << key << " reads object " << obj.getSensorId());
+	});
+	size_t churned = 0;
+	for (uint32_t key = base; key < base + CHURN_KEYS; key++) {
+		churned += db.exists(key) ? 1 : 0;
+	}
+	LUMINADB_CHECK(count == 2u * STABLE_KEYS + churned, "after churn: " << count << " keys");
+}
+
+int main() {
+	const std::string filename = Test::freshFile("database_concurrency.db");
+	{
+		Database db(filename, POOL_FRAMES);
+		mixedWorkload(db);
+		removeReinsertChurn(db);
+	}
+
+	// Everything reached the file
+	{
+		Database db(filename, POOL_FRAMES / 4);
+		size_t count = db.rangeScan<SensorData>(0, UINT32_MAX, [&](uint32_t key, const SensorData &obj) {
+			LUMINADB_CHECK(obj.getSensorId() == key, "reopened key " << key << " reads the wrong object");
+		});
+		LUMINADB_CHECK(count >= 2u * STABLE_KEYS, "reopened count " << count);
+	}
+
+	return Test::finish("database_concurrency_test");
+}
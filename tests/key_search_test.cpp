@@ -0,0 +1,130 @@
+#include "TestUtil.hpp"
+#include "luminadb/index/KeySearch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace LuminaDB;
+
+/**
+ * Every keyLowerBound()/keyUpperBound() implementation this CPU can run (AVX2, SSE2, scalar)
+ * against std::lower_bound/std::upper_bound. The sizes cover empty arrays, the SIMD window
+ * and the vector tails around it, and full pages; the keys include runs of duplicates and
+ * the values around the sign bit, where the vector compares flip unsigned order into signed.
+ */
+constexpr size_t MAX_SMALL_SIZE = 130; // Past the 32-key window with a ragged tail
+constexpr size_t LARGE_SIZES[] = {255, 509, 1021};
+constexpr int RANDOM_ARRAYS = 20;
+const char *const IMPLEMENTATIONS[] = {"avx2", "sse2", "scalar"};
+
+// Values next to where the bias trick and the integer limits could go wrong
+template <typename Int> std::vector<Int> boundaryValues() {
+	constexpr Int max = std::numeric_limits<Int>::max();
+	constexpr Int sign = Int(1) << (sizeof(Int) * 8 - 1);
+	return {0, 1, 2, sign - 2, sign - 1, sign, sign + 1, max - 2, max - 1, max};
+}
+
+// Sorted array of 'size' keys: drawn from 'pool' if it isn't empty, otherwise from the whole range
+template <typename Int> std::vector<Int> sortedKeys(std::mt19937_64 &rng, size_t size, const std::vector<Int> &pool) {
+	std::vector<Int> keys(size);
+	for (Int &key : keys) {
+		key = pool.empty() ? static_cast<Int>(rng()) : pool[rng() % pool.size()];
+	}
+	std::sort(keys.begin(), keys.end());
+	return keys;
+}
+
+// Every key of the array, its neighbours, the boundaries and a few random probes
+template <typename Int> std::vector<Int> probesFor(std::mt19937_64 &rng, const std::vector<Int> &keys) {
+	std::vector<Int> probes = boundaryValues<Int>();
+	for (Int key : keys) {
+		probes.push_back(key);
+		probes.push_back(static_cast<Int>(key - 1));
+		probes.push_back(static_cast<Int>(key + 1));
+	}
+	for (int i = 0; i < 8; i++) {
+		probes.push_back(static_cast<Int>(rng()));
+	}
+	return probes;
+}
+
+// One array against the standard algorithms; reports the first mismatch only
+template <typename Int>
+void checkArray(std::mt19937_64 &rng, const std::vector<Int> &keys, const char *impl, const char *kind) {
+	for (Int probe : probesFor(rng, keys)) {
+		size_t lower = static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin());
+		size_t upper = static_cast<size_t>(std::upper_bound(keys.begin(), keys.end(), probe) - keys.begin());
+		size_t got_lower = keyLowerBound(keys.data(), keys.size(), probe);
+		size_t got_upper = keyUpperBound(keys.data(), keys.size(), probe);
+		if (got_lower != lower || got_upper != upper) {
+			LUMINADB_CHECK(false, impl << ", " << sizeof(Int) * 8 << "-bit " << kind << " array of " << keys.size()
+									   << " keys, probe " << probe << ": bounds " << got_lower << "/" << got_upper
+									   << ", expected " << lower << "/" << upper);
+			return;
+		}
+	}
+}
+
+template <typename Int> void checkImplementation(const char *impl) {
+	std::mt19937_64 rng(sizeof(Int));
+	const std::vector<Int> boundaries = boundaryValues<Int>();
+	const std::vector<Int> few_values = {3, 7, 7, 9}; // Long runs of duplicates
+
+	for (size_t size = 0; size <= MAX_SMALL_SIZE; size++) {
+		checkArray(rng, sortedKeys<Int>(rng, size, {}), impl, "random");
+		checkArray(rng, sortedKeys(rng, size, boundaries), impl, "boundary");
+		checkArray(rng, sortedKeys(rng, size, few_values), impl, "duplicate");
+	}
+	for (size_t size : LARGE_SIZES) {
+		for (int i = 0; i < RANDOM_ARRAYS; i++) {
+			checkArray(rng, sortedKeys<Int>(rng, size, {}), impl, "random");
+		}
+		checkArray(rng, sortedKeys(rng, size, boundaries), impl, "boundary");
+		checkArray(rng, sortedKeys(rng, size, few_values), impl, "duplicate");
+	}
+}
+
+// The branchless binary search other comparators use, here in descending order
+void checkGenericSearch() {
+	std::mt19937_64 rng(7);
+	for (size_t size = 0; size <= MAX_SMALL_SIZE; size++) {
+		std::vector<uint32_t> keys = sortedKeys<uint32_t>(rng, size, {0, 5, 5, 9, UINT32_MAX});
+		std::reverse(keys.begin(), keys.end());
+		for (uint32_t probe : probesFor(rng, keys)) {
+			std::greater<uint32_t> comp;
+			size_t lower = static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), probe, comp) - keys.begin());
+			size_t upper = static_cast<size_t>(std::upper_bound(keys.begin(), keys.end(), probe, comp) - keys.begin());
+			LUMINADB_CHECK(keyLowerBound(keys.data(), keys.size(), probe, comp) == lower &&
+							   keyUpperBound(keys.data(), keys.size(), probe, comp) == upper,
+						   "descending array of " << size << " keys, probe " << probe);
+		}
+	}
+}
+
+int main() {
+	const char *default_impl = keySearchImplementation();
+	std::cerr << "key search: default implementation " << default_impl << std::endl;
+
+	for (const char *impl : IMPLEMENTATIONS) {
+		if (!setKeySearchImplementation(impl)) {
+			std::cerr << "key search: " << impl << " not available here, skipped" << std::endl;
+			continue;
+		}
+		LUMINADB_CHECK(std::string(keySearchImplementation()) == impl, "switched to " << impl << " but "
+																			 << keySearchImplementation()
+																			 << " is active");
+		checkImplementation<uint32_t>(impl);
+		checkImplementation<uint64_t>(impl);
+	}
+	LUMINADB_CHECK(!setKeySearchImplementation("neon"), "an unknown implementation was accepted");
+	setKeySearchImplementation(default_impl);
+
+	checkGenericSearch();
+
+	return Test::finish("key_search_test");
+}
@@ -0,0 +1,237 @@
+#include "TestUtil.hpp"
+#include "luminadb/index/BPlusTree.hpp"
+#include "luminadb/index/KeyTypes.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace LuminaDB;
+
+/**
+ * Each key type the B+ Tree is instantiated for (uint32_t, uint64_t, SensorKey, StringKey32):
+ *  - KeyCodec: decode(encode(k)) == k, and memcmp() of two encodings orders them like
+ *    std::less, which prefix compression and suffix truncation rely on.
+ *  - The tree: random keys with long shared prefixes go in, every one is found with its
+ *    value, a full scan returns them in std::less order, half of them are removed, and
+ *    the rest reads back the same after the pool is flushed and the tree reopened.
+ * Plus what the key types promise on their own: CompositeKey orders like std::pair and
+ * StringKey compares bytes as unsigned, like std::string, and rejects what it can't hold.
+ */
+constexpr int CODEC_KEYS = 2000;
+constexpr size_t TREE_KEYS = 30000;
+constexpr size_t POOL_FRAMES = 256;
+
+// Random keys that share long prefixes (few distinct high parts), plus the extremes of each type
+template <typename Key> struct KeyGen;
+
+template <> struct KeyGen<uint32_t> {
+	static const char *name() { return "uint32_t"; }
+	static uint32_t random(std::mt19937_64 &rng) {
+		return rng() % 4 == 0 ? static_cast<uint32_t>(rng()) : static_cast<uint32_t>(0x80000000u + rng() % 100000);
+	}
+	static std::vector<uint32_t> extremes() { return {0, 1, 0x7FFFFFFF, 0x80000000u, UINT32_MAX}; }
+	static uint32_t max() { return UINT32_MAX; }
+};
+
+template <> struct KeyGen<uint64_t> {
+	static const char *name() { return "uint64_t"; }
+	static uint64_t random(std::mt19937_64 &rng) {
+		return rng() % 4 == 0 ? rng() : 0x0123456700000000ull + rng() % 100000;
+	}
+	static std::vector<uint64_t> extremes() { return {0, 1, 0x7FFFFFFFFFFFFFFFull, 0x8000000000000000ull, UINT64_MAX}; }
+	static uint64_t max() { return UINT64_MAX; }
+};
+
+template <> struct KeyGen<SensorKey> {
+	static const char *name() { return "SensorKey"; }
+	static SensorKey random(std::mt19937_64 &rng) {
+		return SensorKey(static_cast<uint32_t>(rng() % 40), 1700000000000ull + rng() % 10000000);
+	}
+	static std::vector<SensorKey> extremes() {
+		return {SensorKey(0, 0), SensorKey(0, UINT64_MAX), SensorKey(1, 0), SensorKey(UINT32_MAX, 0),
+				SensorKey(UINT32_MAX, UINT64_MAX)};
+	}
+	static SensorKey max() { return SensorKey(UINT32_MAX, UINT64_MAX); }
+};
+
+template <> struct KeyGen<StringKey32> {
+	static const char *name() { return "StringKey32"; }
+	static StringKey32 random(std::mt19937_64 &rng) {
+		// A few prefixes, then a suffix of 0 - 12 bytes that may use the upper half of the byte range
+		static const char *const PREFIXES[] = {"sensor/north/", "sensor/south/", "s", "zz/\xC3\xA9t\xC3\xA9/"};
+		std::string text = PREFIXES[rng() % 4];
+		size_t extra = rng() % 13;
+		for (size_t i = 0; i < extra && text.size() < StringKey32::MAX_LENGTH; i++) {
+			text.push_back(static_cast<char>(rng() % 2 == 0 ? 'a' + rng() % 26 : 1 + rng() % 255));
+		}
+		return StringKey32(text);
+	}
+	static std::vector<StringKey32> extremes() {
+		return {StringKey32(""), StringKey32("a"), StringKey32(std::string(31, 'a')), StringKey32("\x7F"),
+				StringKey32("\x80"), max()};
+	}
+	static StringKey32 max() { return StringKey32(std::string(StringKey32::MAX_LENGTH, '\xFF')); }
+};
+
+static bool sameValue(const RecordID &a, const RecordID &b) { return a.page_id == b.page_id && a.slot_num == b.slot_num; }
+
+template <typename Key> std::vector<uint8_t> encode(const Key &key) {
+	std::vector<uint8_t> bytes(KeyCodec<Key>::WIDTH);
+	KeyCodec<Key>::encode(key, bytes.data());
+	return bytes;
+}
+
+template <typename Key> void checkCodec() {
+	const char *name = KeyGen<Key>::name();
+	std::mt19937_64 rng(1);
+	std::vector<Key> keys = KeyGen<Key>::extremes();
+	for (int i = 0; i < CODEC_KEYS; i++) {
+		keys.push_back(KeyGen<Key>::random(rng));
+	}
+
+	for (const Key &key : keys) {
+		LUMINADB_CHECK(KeyCodec<Key>::decode(encode(key).data()) == key, name << ": " << key << " doesn't round-trip");
+	}
+
+	// Neighbours after a shuffle are random pairs; equal keys must encode equal
+	std::vector<Key> others = keys;
+	std::shuffle(others.begin(), others.end(), rng);
+	others[0] = keys[0];
+	for (size_t i = 0; i < keys.size(); i++) {
+		int order = std::memcmp(encode(keys[i]).data(), encode(others[i]).data(), KeyCodec<Key>::WIDTH);
+		int expected = std::less<Key>{}(keys[i], others[i]) ? -1 : (std::less<Key>{}(others[i], keys[i]) ? 1 : 0);
+		LUMINADB_CHECK((order > 0) - (order < 0) == expected,
+					   name << ": encodings of " << keys[i] << " and " << others[i] << " compare " << order);
+	}
+}
+
+// Distinct random keys (and the extremes) into a tree, then lookups, a full scan, removes and a reopen
+template <typename Key> void checkTree() {
+	const char *name = KeyGen<Key>::name();
+	std::string file = Test::freshFile(std::string("key_types_") + name + ".db");
+	std::mt19937_64 rng(2);
+
+	std::map<Key, RecordID> expected;
+	for (const Key &key : KeyGen<Key>::extremes()) {
+		expected.emplace(key, RecordID{});
+	}
+	while (expected.size() < TREE_KEYS) {
+		expected.emplace(KeyGen<Key>::random(rng), RecordID{});
+	}
+	std::vector<Key> order;
+	uint32_t next_value = 0;
+	for (auto &[key, value] : expected) {
+		value = RecordID{next_value, static_cast<uint16_t>(next_value % POSTING_LIST_FLAG)};
+		next_value++;
+		order.push_back(key);
+	}
+	std::shuffle(order.begin(), order.end(), rng);
+
+	uint32_t root_id;
+	{
+		DiskManager disk_manager(file);
+		BufferPoolManager bpm(POOL_FRAMES, &disk_manager);
+
+		// Page 0 belongs to the superblock in a real database
+		std::vector<char> zeros(PAGE_SIZE, 0);
+		disk_manager.writePage(0, zeros.data());
+		bpm.setNextPageId(1);
+
+		BPlusTree<Key> tree(INVALID_PAGE_ID, &bpm);
+		for (const Key &key : order) {
+			LUMINADB_CHECK(tree.insert(key, expected[key]), name << ": insert " << key);
+		}
+		LUMINADB_CHECK(!tree.insert(order.front(), RecordID{}), name << ": duplicate " << order.front() << " accepted");
+
+		// STEP 1: Full scan, in std::less order, with the right values
+		auto next = expected.begin();
+		size_t scanned = 0;
+		for (auto it = tree.scan(expected.begin()->first, KeyGen<Key>::max()); !it.isEnd(); ++it, ++scanned) {
+			if (next == expected.end() || !(it.key() == next->first) || !sameValue(it.value(), next->second)) {
+				LUMINADB_CHECK(false, name << ": scan found " << it.key() << " at position " << scanned);
+				break;
+			}
+			++next;
+		}
+		LUMINADB_CHECK(scanned == expected.size(), name << ": scan returned " << scanned << " of " << expected.size());
+
+		// STEP 2: Remove every other key of the shuffled order
+		for (size_t i = 0; i < order.size(); i += 2) {
+			LUMINADB_CHECK(tree.remove(order[i]), name << ": remove " << order[i]);
+			expected.erase(order[i]);
+		}
+		root_id = tree.getRootPageId();
+	}
+
+	// STEP 3: Reopened from disk, the rest is there and the removed keys are not
+	DiskManager disk_manager(file);
+	BufferPoolManager bpm(POOL_FRAMES, &disk_manager);
+	BPlusTree<Key> tree(root_id, &bpm);
+	for (size_t i = 0; i < order.size(); i++) {
+		RecordID value;
+		bool found = tree.getValue(order[i], value);
+		if (i % 2 == 0) {
+			LUMINADB_CHECK(!found, name << ": removed key " << order[i] << " still found");
+		} else {
+			LUMINADB_CHECK(found && sameValue(value, expected[order[i]]), name << ": lookup " << order[i] << " after reopen");
+		}
+	}
+	std::cerr << name << ": " << order.size() << " keys, " << expected.size() << " left after removes" << std::endl;
+}
+
+void checkKeyTypes() {
+	// CompositeKey orders like std::pair
+	std::mt19937_64 rng(3);
+	for (int i = 0; i < CODEC_KEYS; i++) {
+		SensorKey a = KeyGen<SensorKey>::random(rng);
+		SensorKey b = KeyGen<SensorKey>::random(rng);
+		bool pair_less = std::make_pair(a.first, a.second) < std::make_pair(b.first, b.second);
+		LUMINADB_CHECK((a < b) == pair_less, "SensorKey: " << a << " < " << b << " disagrees with std::pair");
+	}
+
+	// StringKey compares like std::string (unsigned bytes, shorter prefix first)
+	const std::string texts[] = {"", "a", "ab", "abc", "b", "\x7F", "\x80", "\xFF", "a\xFF", "ab\x01"};
+	for (const std::string &x : texts) {
+		for (const std::string &y : texts) {
+			LUMINADB_CHECK((StringKey32(x) < StringKey32(y)) == (x < y),
+						   "StringKey32: " << StringKey32(x) << " < " << StringKey32(y) << " disagrees with std::string");
+		}
+	}
+
+	// What doesn't fit is refused, not truncated
+	bool too_long = false;
+	bool with_nul = false;
+	try {
+		StringKey32(std::string(StringKey32::MAX_LENGTH + 1, 'x'));
+	} catch (const std::invalid_argument &) {
+		too_long = true;
+	}
+	try {
+		StringKey32(std::string("a\0b", 3));
+	} catch (const std::invalid_argument &) {
+		with_nul = true;
+	}
+	LUMINADB_CHECK(too_long, "StringKey32 accepted " << StringKey32::MAX_LENGTH + 1 << " bytes");
+	LUMINADB_CHECK(with_nul, "StringKey32 accepted a NUL byte");
+}
+
+int main() {
+	checkKeyTypes();
+
+	checkCodec<uint32_t>();
+	checkCodec<uint64_t>();
+	checkCodec<SensorKey>();
+	checkCodec<StringKey32>();
+
+	checkTree<uint32_t>();
+	checkTree<uint64_t>();
+	checkTree<SensorKey>();
+	checkTree<StringKey32>();
+
+	return Test::finish("key_types_test");
+}
@@ -0,0 +1,116 @@
+#include "TestUtil.hpp"
+#include "luminadb/buffer/PageTable.hpp"
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace LuminaDB;
+
+/**
+ * Random inserts, erases and lookups on PageTables of several sizes, checked against an
+ * std::unordered_map after every step (backward-shift deletes must keep every probe
+ * chain intact). Then lookups without a latch race with a writer: they may miss a page
+ * that is being moved, but must never pair a page with a frame it was not mapped to.
+ */
+constexpr int MODEL_STEPS = 300000;
+constexpr int RACE_STEPS = 200000;
+
+static void checkAgainstModel(size_t capacity) {
+	PageTable table(capacity);
+	std::unordered_map<uint32_t, uint32_t> model;
+	std::mt19937 rng(static_cast<uint32_t>(capacity));
+
+	// Page ids collide on purpose: a few times more ids than entries, spaced so they share homes
+	auto randomPage = [&] { return static_cast<uint32_t>(rng() % (capacity * 4 + 3) * 7); };
+
+	for (int step = 0; step < MODEL_STEPS; step++) {
+		uint32_t page_id = randomPage();
+		switch (rng() % 3) {
+		case 0:
+			if (model.size() < capacity && model.count(page_id) == 0) {
+				uint32_t frame_id = rng() % 1000000;
+				table.insert(page_id, frame_id);
+				model[page_id] = frame_id;
+			}
+			break;
+		case 1: {
+			bool erased = table.erase(page_id);
+			LUMINADB_CHECK(erased == (model.erase(page_id) == 1), "capacity " << capacity << ": erase " << page_id);
+			break;
+		}
+		default:
+			break;
+		}
+
+		uint32_t probe = randomPage();
+		auto it = model.find(probe);
+		uint32_t expected = it == model.end() ? PageTable::NOT_FOUND : it->second;
+		uint32_t found = table.find(probe);
+		if (found != expected || table.size() != model.size()) {
+			LUMINADB_CHECK(false, "capacity " << capacity << ": find " << probe << " = " << found << ", expected "
+											   << expected << " (size " << table.size() << "/" << model.size() << ")");
+			return;
+		}
+	}
+}
+
+static void checkConcurrentLookups() {
+	const size_t capacity = 256;
+	PageTable table(capacity);
+
+	// Every page always maps to the same frame, so any other answer is a torn or stale pairing
+	auto frameOf = [](uint32_t page_id) { return page_id * 3 + 1; };
+
+	// Stable pages stay in the table; churn pages come and go next to them
+	std::vector<uint32_t> stable;
+	for (uint32_t page_id = 0; page_id < capacity / 2; page_id++) {
+		table.insert(page_id * 2, frameOf(page_id * 2));
+		stable.push_back(page_id * 2);
+	}
+
+	std::atomic<bool> done{false};
+	std::thread writer([&] {
+		std::mt19937 rng(7);
+		std::vector<uint32_t> churn;
+		for (int step = 0; step < RACE_STEPS; step++) {
+			if (churn.size() < capacity / 2 && rng() % 2 == 0) {
+				uint32_t page_id = (rng() % 4096) * 2 + 1;
+				if (table.find(page_id) == PageTable::NOT_FOUND) {
+					table.insert(page_id, frameOf(page_id));
+					churn.push_back(page_id);
+				}
+			} else if (!churn.empty()) {
+				size_t index = rng() % churn.size();
+				table.erase(churn[index]);
+				churn[index] = churn.back();
+				churn.pop_back();
+			}
+		}
+		done.store(true);
+	});
+
+	std::mt19937 rng(11);
+	while (!done.load()) {
+		uint32_t page_id = rng() % 8192;
+		uint32_t frame_id = table.find(page_id);
+		LUMINADB_CHECK(frame_id == PageTable::NOT_FOUND || frame_id == frameOf(page_id),
+					   "page " << page_id << " paired with frame " << frame_id);
+	}
+	writer.join();
+
+	// Once the writer is gone, nothing may have been lost along the way
+	for (uint32_t page_id : stable) {
+		LUMINADB_CHECK(table.find(page_id) == frameOf(page_id), "stable page " << page_id << " lost");
+	}
+}
+
+int main() {
+	for (size_t capacity : {1, 2, 5, 64, 300}) {
+		checkAgainstModel(capacity);
+	}
+	checkConcurrentLookups();
+	return Test::finish("page_table_fuzz_test");
+}
@@ -0,0 +1,101 @@
+#include "TestUtil.hpp"
+#include "luminadb/database/Database.hpp"
+#include "luminadb/model/SensorData.hpp"
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace LuminaDB;
+
+/**
+ * Readers against removes that free record slots. Each item moves back and forth between
+ * key i and key i + BANK: the remove frees its slot and the insert of the other key
+ * usually takes it right back, with another object in it. A find() or rangeScan() that
+ * got a RecordID from the index must still read that key's own object (never the object
+ * that reused the slot, and never "Record slot not found"). Run it under ThreadSanitizer
+ * too: -DLUMINADB_SANITIZER=thread and TSAN_OPTIONS=detect_deadlocks=0.
+ */
+constexpr uint32_t ITEMS = 2000;
+constexpr uint32_t BANK = 1u << 20;
+constexpr uint32_t CHURNERS = 2;
+constexpr int MOVES = 20000;
+constexpr uint32_t SCAN_WIDTH = 300;
+constexpr uint32_t POOL_FRAMES = 64;
+
+static SensorData objectFor(uint32_t key) { return SensorData(key, 1.0, key); }
+
+int main() {
+	Database db(Test::freshFile("record_reclaim.db"), POOL_FRAMES);
+	for (uint32_t i = 0; i < ITEMS; i++) {
+		db.insert<SensorData>(i, objectFor(i));
+	}
+
+	std::atomic<uint32_t> churners_left{CHURNERS};
+	std::vector<std::thread> threads;
+
+	// Churner t owns the items i with i % CHURNERS == t, so it always knows where each one is
+	for (uint32_t t = 0; t < CHURNERS; t++) {
+		threads.emplace_back([&, t] {
+			std::vector<uint32_t> key_of;
+			for (uint32_t i = t; i < ITEMS; i += CHURNERS) {
+				key_of.push_back(i);
+			}
+			std::mt19937 rng(t);
+			for (int move = 0; move < MOVES; move++) {
+				uint32_t &key = key_of[rng() % key_of.size()];
+				uint32_t next = key < BANK ? key + BANK : key - BANK;
+				LUMINADB_CHECK(db.remove(key), "remove " << key);
+				LUMINADB_CHECK(db.insert<SensorData>(next, objectFor(next)), "insert " << next);
+				key = next;
+			}
+			churners_left--;
+		});
+	}
+
+	// Readers: only the key's own object, or (for find) the key being absent right now
+	threads.emplace_back([&] {
+		std::mt19937 rng(100);
+		while (churners_left.load() > 0) {
+			uint32_t key = rng() % ITEMS + (rng() % 2 == 0 ? 0 : BANK);
+			try {
+				uint32_t id = db.find<SensorData>(key).getSensorId();
+				LUMINADB_CHECK(id == key, "find " << key << " read object " << id);
+			} catch (const std::runtime_error &e) {
+				LUMINADB_CHECK(std::string(e.what()).rfind("Key not found", 0) == 0, "find " << key << ": " << e.what());
+			}
+		}
+	});
+	threads.emplace_back([&] {
+		std::mt19937 rng(200);
+		while (churners_left.load() > 0) {
+			uint32_t lo = rng() % ITEMS + (rng() % 2 == 0 ? 0 : BANK);
+			try {
+				db.rangeScan<SensorData>(lo, lo + SCAN_WIDTH, [&](uint32_t key, const SensorData &obj) {
+					LUMINADB_CHECK(obj.getSensorId() == key, "scan: key " << key << " read object " << obj.getSensorId());
+				});
+			} catch (const std::exception &e) {
+				LUMINADB_CHECK(false, "scan from " << lo << ": " << e.what());
+			}
+		}
+	});
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	// Every item is still there exactly once, in one bank or the other
+	std::vector<bool> seen(ITEMS, false);
+	size_t count = db.rangeScan<SensorData>(0, UINT32_MAX, [&](uint32_t key, const SensorData &obj) {
+		LUMINADB_CHECK(obj.getSensorId() == key, "after the run, key " << key << " reads object " << obj.getSensorId());
+		uint32_t item = key % BANK;
+		LUMINADB_CHECK(item < ITEMS && !seen[item], "after the run, unexpected key " << key);
+		if (item < ITEMS) {
+			seen[item] = true;
+		}
+	});
+	LUMINADB_CHECK(count == ITEMS, "after the run: " << count << " keys, expected " << ITEMS);
+
+	return Test::finish("record_reclaim_test");
+}